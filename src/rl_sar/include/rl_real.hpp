@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef RL_REAL_HPP
+#define RL_REAL_HPP
+
+// #define PLOT
+// #define CSV_LOGGER
+// #define HOT_RELOAD
+// #define USE_ROS
+
+#include "rl_sdk.hpp"
+#include "observation_buffer.hpp"
+#include "loop.hpp"
+#include "robot_backend.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+#ifdef USE_ROS
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <geometry_msgs/Twist.h>
+#endif
+
+/**
+ * @brief Robot-independent real robot runtime.
+ *
+ * Everything specific to a robot's transport lives in a backend plugin loaded with dlopen
+ * (see robot_backend.h); this class owns observations, inference, the FSM, the joint mapping
+ * between hardware and policy order and the control/rl loops.
+ */
+class RL_Real : public RL
+{
+public:
+    RL_Real(const rl_backend_api *api, rl_backend *backend, const rl_backend_info &info, bool chained_mode, int chained_cpu);
+    ~RL_Real();
+
+private:
+    // rl functions
+    torch::Tensor Forward() override;
+    void GetState(RobotState<double> *state) override;
+    void SetCommand(const RobotCommand<double> *command) override;
+    void RunModel();
+    void RobotControl();
+
+    // loop
+    std::shared_ptr<LoopFunc> loop_keyboard;
+    std::shared_ptr<LoopFunc> loop_control;
+    std::shared_ptr<LoopFunc> loop_rl;
+
+    // chained mode: one pinned thread waits for the backend's next state, runs the control
+    // step and hands the command over immediately instead of free-running loops
+    bool chained_mode;
+    int chained_cpu; // -1: not pinned, like LoopFunc's bindCPU
+    std::thread chained_thread;
+    std::atomic<bool> chained_running{false};
+    void ChainedLoop();
+
+    // backend plugin, hardware motor order on both sides
+    const rl_backend_api *backend_api;
+    rl_backend *backend;
+    rl_backend_state backend_state = {};
+    rl_backend_command backend_command = {};
+    uint64_t last_state_sequence = 0;
+
+    // others
+    int motiontime = 0;
+    std::vector<double> mapped_joint_positions;
+    std::vector<double> mapped_joint_velocities;
+
+#ifdef USE_ROS
+    // ros
+    geometry_msgs::Twist cmd_vel;
+    ros::Subscriber cmd_vel_subscriber;
+    void CmdvelCallback(const geometry_msgs::Twist::ConstPtr &msg);
+#endif
+};
+
+#endif // RL_REAL_HPP
@@ -9,9 +9,12 @@
 #include "rl_sdk.hpp"
 #include "observation_buffer.hpp"
 #include "loop.hpp"
+#include "triple_buffer.hpp"
 #include <csignal>
+#include <fstream>
 
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include "std_srvs/Empty.h"
 #include <sensor_msgs/Joy.h>
 #include <geometry_msgs/Twist.h>
@@ -19,9 +22,23 @@
 #include <gazebo_msgs/SetModelState.h>
 #include "robot_msgs/MotorCommand.h"
 #include "robot_msgs/MotorState.h"
+#include "robot_msgs/RobotCommand.h"
+#include "robot_msgs/RobotState.h"
+#include "robot_joint_shm.h"
 
-#include "matplotlibcpp.h"
-namespace plt = matplotlibcpp;
+// joint and base feedback written by the ROS callbacks, joints are indexed by slot (base.yaml order)
+struct SimState
+{
+    static constexpr int max_dofs = 32;
+    std::chrono::steady_clock::time_point stamp;
+    double quaternion[4] = {1.0, 0.0, 0.0, 0.0}; // w, x, y, z
+    double gyroscope[3] = {0.0, 0.0, 0.0};     // world frame, as Gazebo reports it
+    double accelerometer[3] = {0.0, 0.0, 9.81}; // body frame specific force, differentiated from the twist
+    double lin_vel[3] = {0.0, 0.0, 0.0};        // body frame, ground truth for the velocity estimator
+    double q[max_dofs] = {};
+    double dq[max_dofs] = {};
+    double tau_est[max_dofs] = {};
+};
 
 class RL_Sim : public RL
 {
@@ -35,24 +52,16 @@ private:
     void GetState(RobotState<double> *state) override;
     void SetCommand(const RobotCommand<double> *command) override;
     void RunModel();
+    void InitTransport();
     void RobotControl();
 
     // loop
     std::shared_ptr<LoopFunc> loop_keyboard;
     std::shared_ptr<LoopFunc> loop_control;
     std::shared_ptr<LoopFunc> loop_rl;
-    std::shared_ptr<LoopFunc> loop_plot;
-
-    // plot
-    const int plot_size = 100;
-    std::vector<int> plot_t;
-    std::vector<std::vector<double>> plot_real_joint_pos, plot_target_joint_pos;
-    void Plot();
 
     // ros interface
     std::string ros_namespace;
-    geometry_msgs::Twist vel;
-    geometry_msgs::Pose pose;
     geometry_msgs::Twist cmd_vel;
     sensor_msgs::Joy joy_msg;
     ros::Subscriber model_state_subscriber;
@@ -65,16 +74,50 @@ private:
     std::map<std::string, ros::Subscriber> joint_subscribers;
     std::vector<robot_msgs::MotorCommand> joint_publishers_commands;
     void ModelStatesCallback(const gazebo_msgs::ModelStates::ConstPtr &msg);
-    void JointStatesCallback(const robot_msgs::MotorState::ConstPtr &msg, const std::string &joint_name);
+    void JointStatesCallback(const robot_msgs::MotorState::ConstPtr &msg, int slot);
+
+    // group controller interface, one RobotCommand and one RobotState per tick
+    bool use_group_controller = false;
+    ros::Publisher robot_command_publisher;
+    ros::Subscriber robot_state_subscriber;
+    robot_msgs::RobotCommand robot_command_msg;
+    void RobotStateCallback(const robot_msgs::RobotState::ConstPtr &msg);
+
+    // shared memory interface to the group controller, replaces the group topics when set
+    std::string shared_memory_name;
+    robot_joint_controller::shm::Region *shm_region = nullptr;
+    robot_joint_controller::shm::State shm_state;
+    std::chrono::steady_clock::time_point shm_stamp; // when shm_state was read
+    robot_joint_controller::shm::Command shm_command;
+    uint32_t shm_state_seq = 0;
+    int shm_decimation = 1;
+    std::thread shm_thread;
+    std::atomic<bool> shm_running{false};
+    void SharedMemoryLoop();
     void CmdvelCallback(const geometry_msgs::Twist::ConstPtr &msg);
     void JoyCallback(const sensor_msgs::Joy::ConstPtr &msg);
 
     // others
     std::string gazebo_model_name;
     int motiontime = 0;
-    std::map<std::string, double> joint_positions;
-    std::map<std::string, double> joint_velocities;
-    std::map<std::string, double> joint_efforts;
+
+    // base twist of the previous model state, ros spinner only
+    ros::Time last_model_time;
+    double last_world_velocity[3] = {0.0, 0.0, 0.0};
+
+    // estimator inputs against the ground truth, for velocity_estimator_replay
+    std::ofstream velocity_log;
+    void VelocityLogInit(const std::string &path);
+    void VelocityLog();
+
+    // state snapshot, written by the ros spinner and read once per tick by loop_control
+    TripleBuffer<SimState> state_buffer;
+    SimState state_pending; // ros spinner only
+    SimState sim_state;     // loop_control only
+    std::vector<std::string> slot_joint_names; // slot order of the state block and the group controller (base.yaml)
+    std::vector<std::string> joint_slot_names;
+    std::vector<int> joint_slots;
+    void MapJointSlots();
 };
 
 #endif // RL_SIM_HPP
@@ -0,0 +1,948 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "config_bundle.hpp"
+#include "crc32.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <yaml-cpp/yaml.h>
+
+std::string ConfigBundle::Open(const std::string &path)
+{
+    this->Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return "cannot open";
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ConfigBundleHeader) + sizeof(BaseConfig))
+    {
+        close(fd);
+        return "too short";
+    }
+    size_t size = info.st_size;
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return "cannot map";
+    }
+
+    const ConfigBundleHeader *header = static_cast<const ConfigBundleHeader *>(addr);
+    std::string error;
+    if (header->magic != CONFIG_BUNDLE_MAGIC)
+    {
+        error = "not a config bundle";
+    }
+    else if (header->version != CONFIG_BUNDLE_VERSION || header->base_size != sizeof(BaseConfig) || header->config_size != sizeof(RLConfig))
+    {
+        error = "written by another version, rebuild it";
+    }
+    else if (header->size != size || size != sizeof(ConfigBundleHeader) + sizeof(BaseConfig) + header->num_configs * sizeof(RLConfig))
+    {
+        error = "truncated";
+    }
+    else if (crc32::Core(reinterpret_cast<const uint32_t *>(header + 1), (size - sizeof(ConfigBundleHeader)) >> 2) != header->crc)
+    {
+        error = "crc mismatch";
+    }
+    if (!error.empty())
+    {
+        munmap(addr, size);
+        return error;
+    }
+    this->header = header;
+    this->size = size;
+    return "";
+}
+
+void ConfigBundle::Close()
+{
+    if (this->header)
+    {
+        munmap(const_cast<ConfigBundleHeader *>(this->header), this->size);
+        this->header = nullptr;
+    }
+}
+
+const BaseConfig *ConfigBundle::Base() const
+{
+    return this->header ? reinterpret_cast<const BaseConfig *>(this->header + 1) : nullptr;
+}
+
+const RLConfig *ConfigBundle::Find(const std::string &config_name) const
+{
+    if (!this->header)
+    {
+        return nullptr;
+    }
+    const RLConfig *configs = reinterpret_cast<const RLConfig *>(this->Base() + 1);
+    for (uint32_t i = 0; i < this->header->num_configs; ++i)
+    {
+        if (config_name == configs[i].config_name)
+        {
+            return &configs[i];
+        }
+    }
+    return nullptr;
+}
+
+namespace
+{
+    // yaml-cpp reports a missing key or a bad value deep inside as<>(), wrap every access so
+    // the error names the file and the key instead
+    class Reader
+    {
+    public:
+        Reader(const std::string &path, const YAML::Node &node) : path(path), node(node) {}
+
+        [[noreturn]] void Fail(const std::string &key, const std::string &problem) const
+        {
+            throw ConfigError(this->path + ": " + key + ": " + problem);
+        }
+
+        bool Has(const std::string &key) const
+        {
+            return static_cast<bool>(this->node[key]);
+        }
+
+        YAML::Node Require(const std::string &key) const
+        {
+            YAML::Node value = this->node[key];
+            if (!value)
+            {
+                this->Fail(key, "missing");
+            }
+            return value;
+        }
+
+        template <typename T>
+        T Scalar(const std::string &key) const
+        {
+            YAML::Node value = this->Require(key);
+            try
+            {
+                return value.as<T>();
+            }
+            catch (const YAML::Exception &)
+            {
+                this->Fail(key, "cannot read '" + YAML::Dump(value) + "'");
+            }
+        }
+
+        // null is accepted as an empty list only where the runtime treats it that way
+        template <typename T>
+        std::vector<T> List(const std::string &key, bool allow_null = false) const
+        {
+            YAML::Node value = this->Require(key);
+            if (value.IsNull() && allow_null)
+            {
+                return {};
+            }
+            if (!value.IsSequence())
+            {
+                this->Fail(key, "expected a list");
+            }
+            std::vector<T> values;
+            for (size_t i = 0; i < value.size(); ++i)
+            {
+                try
+                {
+                    values.push_back(value[i].as<T>());
+                }
+                catch (const YAML::Exception &)
+                {
+                    this->Fail(key, "cannot read element " + std::to_string(i) + " '" + YAML::Dump(value[i]) + "'");
+                }
+            }
+            return values;
+        }
+
+        template <typename T>
+        std::vector<T> List(const std::string &key, size_t length) const
+        {
+            std::vector<T> values = this->List<T>(key);
+            if (values.size() != length)
+            {
+                this->Fail(key, "has " + std::to_string(values.size()) + " entries, num_of_dofs is " + std::to_string(length));
+            }
+            return values;
+        }
+
+        template <size_t N>
+        void Name(const std::string &key, const std::string &value, char (&out)[N]) const
+        {
+            if (value.empty() || value.size() >= N)
+            {
+                this->Fail(key, "'" + value + "' must have 1 to " + std::to_string(N - 1) + " characters");
+            }
+            memset(out, 0, N);
+            memcpy(out, value.data(), value.size());
+        }
+
+        const std::string &path;
+        YAML::Node node;
+    };
+
+    template <typename T, size_t N>
+    void Copy(const std::vector<T> &values, T (&out)[N])
+    {
+        std::fill(out, out + N, T());
+        std::copy(values.begin(), values.end(), out);
+    }
+
+    YAML::Node LoadSection(const std::string &path, const std::string &section)
+    {
+        YAML::Node file;
+        try
+        {
+            file = YAML::LoadFile(path);
+        }
+        catch (const YAML::BadFile &)
+        {
+            throw ConfigError(path + ": cannot open");
+        }
+        catch (const YAML::Exception &e)
+        {
+            throw ConfigError(path + ": " + e.what());
+        }
+        YAML::Node node = file[section];
+        if (!node || !node.IsMap())
+        {
+            throw ConfigError(path + ": " + section + ": missing top level section");
+        }
+        return node;
+    }
+
+    int NumOfDofs(const Reader &reader)
+    {
+        int num_of_dofs = reader.Scalar<int>("num_of_dofs");
+        if (num_of_dofs < 1 || num_of_dofs > CONFIG_MAX_DOFS)
+        {
+            reader.Fail("num_of_dofs", std::to_string(num_of_dofs) + " is outside 1.." + std::to_string(CONFIG_MAX_DOFS));
+        }
+        return num_of_dofs;
+    }
+
+    // fields base.yaml and config.yaml share, the structs use the same member names
+    template <typename Config>
+    void ParseJoints(const Reader &reader, Config &config)
+    {
+        const size_t n = config.num_of_dofs;
+
+        std::vector<int32_t> wheel_indices = reader.List<int32_t>("wheel_indices");
+        std::set<int32_t> wheels;
+        for (int32_t index : wheel_indices)
+        {
+            if (index < 0 || index >= static_cast<int32_t>(n) || !wheels.insert(index).second)
+            {
+                reader.Fail("wheel_indices", "index " + std::to_string(index) + " is out of range or repeated");
+            }
+        }
+        config.num_wheels = wheel_indices.size();
+        Copy(wheel_indices, config.wheel_indices);
+
+        for (const char *key : {"command_mapping", "state_mapping"})
+        {
+            std::vector<int32_t> mapping = reader.List<int32_t>(key, n);
+            std::vector<int32_t> sorted = mapping;
+            std::sort(sorted.begin(), sorted.end());
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (sorted[i] != static_cast<int32_t>(i))
+                {
+                    reader.Fail(key, "must be a permutation of 0.." + std::to_string(n - 1));
+                }
+            }
+            Copy(mapping, std::string(key) == "command_mapping" ? config.command_mapping : config.state_mapping);
+        }
+
+        std::vector<double> fixed_kp = reader.List<double>("fixed_kp", n);
+        std::vector<double> fixed_kd = reader.List<double>("fixed_kd", n);
+        std::vector<double> torque_limits = reader.List<double>("torque_limits", n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (fixed_kp[i] < 0.0 || fixed_kd[i] < 0.0)
+            {
+                reader.Fail(fixed_kp[i] < 0.0 ? "fixed_kp" : "fixed_kd", "gains must not be negative");
+            }
+            if (torque_limits[i] <= 0.0)
+            {
+                reader.Fail("torque_limits", "limits must be positive");
+            }
+        }
+        Copy(fixed_kp, config.fixed_kp);
+        Copy(fixed_kd, config.fixed_kd);
+        Copy(torque_limits, config.torque_limits);
+        Copy(reader.List<double>("default_dof_pos", n), config.default_dof_pos);
+
+        std::vector<std::string> names = reader.List<std::string>("joint_controller_names", n);
+        if (std::set<std::string>(names.begin(), names.end()).size() != n)
+        {
+            reader.Fail("joint_controller_names", "names must be unique");
+        }
+        memset(config.joint_controller_names, 0, sizeof(config.joint_controller_names));
+        for (size_t i = 0; i < n; ++i)
+        {
+            reader.Name("joint_controller_names", names[i], config.joint_controller_names[i]);
+        }
+    }
+
+    // width of each observation term, mirrors RL::ComputeObservation()
+    int ObservationSize(const std::string &observation, int num_of_dofs)
+    {
+        if (observation == "lin_vel" || observation == "ang_vel" || observation == "ang_vel_body" || observation == "ang_vel_world" ||
+            observation == "gravity_vec" || observation == "commands")
+        {
+            return 3;
+        }
+        if (observation == "dof_pos" || observation == "dof_vel" || observation == "actions")
+        {
+            return num_of_dofs;
+        }
+        if (observation == "phase")
+        {
+            return 6;
+        }
+        if (observation == "g1_phase")
+        {
+            return 2;
+        }
+        return -1;
+    }
+
+    std::string ShapeString(const std::vector<int64_t> &shape)
+    {
+        std::string text = "[";
+        for (size_t i = 0; i < shape.size(); ++i)
+        {
+            text += (i ? ", " : "") + std::to_string(shape[i]);
+        }
+        return text + "]";
+    }
+
+    void AddPolicyInput(const Reader &reader, RLConfig &config, const std::string &name, int32_t source, int32_t layout, int32_t index)
+    {
+        if (config.num_policy_inputs >= CONFIG_MAX_POLICY_INPUTS)
+        {
+            reader.Fail("policy_inputs", "a policy takes at most " + std::to_string(CONFIG_MAX_POLICY_INPUTS) + " inputs");
+        }
+        PolicyInputConfig &input = config.policy_inputs[config.num_policy_inputs++];
+        reader.Name("policy_inputs", name, input.name);
+        input.source = source;
+        input.layout = layout;
+        input.index = index;
+    }
+
+    // forward()'s arguments in order; without the key a policy takes the observation, or the
+    // flat history when there is one, followed by its hidden states
+    void ParsePolicyInputs(const std::string &path, const Reader &reader, RLConfig &config)
+    {
+        YAML::Node policy_inputs = reader.Has("policy_inputs") ? reader.Require("policy_inputs") : YAML::Node();
+        std::vector<bool> bound(config.num_hidden_states, false);
+        if (policy_inputs && !policy_inputs.IsNull())
+        {
+            if (!policy_inputs.IsSequence() || policy_inputs.size() == 0)
+            {
+                reader.Fail("policy_inputs", "expected a list of inputs");
+            }
+            for (size_t i = 0; i < policy_inputs.size(); ++i)
+            {
+                if (!policy_inputs[i].IsMap())
+                {
+                    reader.Fail("policy_inputs", "entry " + std::to_string(i) + " must be a map with a source");
+                }
+                const std::string entry_path = path + ": policy_inputs " + std::to_string(i);
+                Reader entry(entry_path, policy_inputs[i]);
+                const std::string source = entry.Scalar<std::string>("source");
+                if (entry.Has("layout") && source != "history")
+                {
+                    entry.Fail("layout", "only history inputs have a layout");
+                }
+                int32_t kind = POLICY_INPUT_OBS;
+                int32_t layout = POLICY_INPUT_FLAT;
+                int32_t index = 0;
+                std::string name = source;
+                if (source == "history")
+                {
+                    if (config.num_history == 0)
+                    {
+                        entry.Fail("source", "history needs observations_history");
+                    }
+                    const std::string layout_name = entry.Has("layout") ? entry.Scalar<std::string>("layout") : "flat";
+                    if (layout_name != "flat" && layout_name != "stacked")
+                    {
+                        entry.Fail("layout", "'" + layout_name + "' is neither flat nor stacked");
+                    }
+                    kind = POLICY_INPUT_HISTORY;
+                    layout = layout_name == "stacked" ? POLICY_INPUT_STACKED : POLICY_INPUT_FLAT;
+                }
+                else if (source == "commands")
+                {
+                    kind = POLICY_INPUT_COMMANDS;
+                }
+                else if (source == "hidden_state")
+                {
+                    index = entry.Scalar<int32_t>("index");
+                    if (index < 0 || index >= config.num_hidden_states || bound[index])
+                    {
+                        entry.Fail("index", std::to_string(index) + " is not one of the " + std::to_string(config.num_hidden_states) + " hidden_states or is bound twice");
+                    }
+                    bound[index] = true;
+                    kind = POLICY_INPUT_HIDDEN_STATE;
+                    name += "_" + std::to_string(index);
+                }
+                else if (source != "obs")
+                {
+                    entry.Fail("source", "'" + source + "' is none of obs, history, commands and hidden_state");
+                }
+                AddPolicyInput(entry, config, entry.Has("name") ? entry.Scalar<std::string>("name") : name, kind, layout, index);
+                // optional, documents and checks what the policy was exported with
+                if (entry.Has("shape"))
+                {
+                    std::vector<int64_t> shape = entry.List<int64_t>("shape");
+                    std::vector<int64_t> expected = config_bundle::PolicyInputShape(config, config.policy_inputs[config.num_policy_inputs - 1]);
+                    if (shape != expected)
+                    {
+                        entry.Fail("shape", ShapeString(shape) + " does not match the " + ShapeString(expected) + " the source provides");
+                    }
+                }
+            }
+        }
+        else
+        {
+            AddPolicyInput(reader, config, "obs", config.num_history == 0 ? POLICY_INPUT_OBS : POLICY_INPUT_HISTORY, POLICY_INPUT_FLAT, 0);
+        }
+
+        // hidden states the list leaves out follow it, all or none of them may be placed
+        const size_t num_bound = std::count(bound.begin(), bound.end(), true);
+        if (num_bound != 0 && num_bound != bound.size())
+        {
+            reader.Fail("policy_inputs", "place every hidden state or none of them");
+        }
+        if (num_bound == 0)
+        {
+            for (int32_t i = 0; i < config.num_hidden_states; ++i)
+            {
+                AddPolicyInput(reader, config, "hidden_state_" + std::to_string(i), POLICY_INPUT_HIDDEN_STATE, POLICY_INPUT_FLAT, i);
+            }
+        }
+    }
+
+    // optional, base velocity for the lin_vel observation from the IMU and the standing legs
+    void ParseVelocityEstimator(const std::string &path, const Reader &reader, BaseConfig &config)
+    {
+        VelocityEstimatorConfig &estimator = config.velocity_estimator;
+        if (!reader.Has("velocity_estimator") || reader.Require("velocity_estimator").IsNull())
+        {
+            return;
+        }
+        if (!reader.Require("velocity_estimator").IsMap())
+        {
+            reader.Fail("velocity_estimator", "expected a map with legs");
+        }
+        if (!reader.Has("kinematics"))
+        {
+            reader.Fail("velocity_estimator", "the feet come from the generated kinematics, add a kinematics section");
+        }
+        const std::string section_path = path + ": velocity_estimator";
+        Reader section(section_path, reader.Require("velocity_estimator"));
+        const YAML::Node legs = section.Require("legs");
+        if (!legs.IsSequence() || legs.size() < 2 || legs.size() > CONFIG_MAX_LEGS)
+        {
+            section.Fail("legs", "expected 2 to " + std::to_string(CONFIG_MAX_LEGS) + " legs");
+        }
+        const std::vector<std::string> names(config.joint_controller_names, config.joint_controller_names + config.num_of_dofs);
+        for (size_t i = 0; i < legs.size(); ++i)
+        {
+            const std::string leg_path = section_path + ": legs " + std::to_string(i);
+            if (!legs[i].IsMap())
+            {
+                section.Fail("legs", "entry " + std::to_string(i) + " must be a map with joints");
+            }
+            Reader leg(leg_path, legs[i]);
+            std::vector<std::string> joints = leg.List<std::string>("joints");
+            if (joints.size() != 3)
+            {
+                leg.Fail("joints", "expected the hip, thigh and calf controller");
+            }
+            for (size_t j = 0; j < joints.size(); ++j)
+            {
+                if (std::find(names.begin(), names.end(), joints[j]) == names.end())
+                {
+                    leg.Fail("joints", "'" + joints[j] + "' is not in joint_controller_names");
+                }
+                leg.Name("joints", joints[j], estimator.joints[i][j]);
+            }
+        }
+        estimator.num_legs = legs.size();
+
+        // defaults, check a change with velocity_estimator_replay on a recorded run
+        const struct
+        {
+            const char *key;
+            double fallback;
+            double *value;
+        } tuning[] = {
+            {"accelerometer_noise", 0.5, &estimator.accelerometer_noise},
+            {"bias_noise", 0.01, &estimator.bias_noise},
+            {"foot_velocity_noise", 0.1, &estimator.foot_velocity_noise},
+            {"contact_height", 0.03, &estimator.contact_height},
+            {"budget_us", 50.0, &estimator.budget_us},
+        };
+        for (const auto &entry : tuning)
+        {
+            *entry.value = section.Has(entry.key) ? section.Scalar<double>(entry.key) : entry.fallback;
+            if (!(*entry.value > 0.0))
+            {
+                section.Fail(entry.key, "must be positive");
+            }
+        }
+    }
+
+    // optional, the limits the safety supervisor checks every control tick
+    void ParseSafety(const std::string &path, const Reader &reader, BaseConfig &config)
+    {
+        SafetyConfig &safety = config.safety;
+        if (!reader.Has("safety") || reader.Require("safety").IsNull())
+        {
+            return;
+        }
+        if (!reader.Require("safety").IsMap())
+        {
+            reader.Fail("safety", "expected a map with the checks");
+        }
+        const std::string section_path = path + ": safety";
+        Reader section(section_path, reader.Require("safety"));
+        safety.enabled = 1;
+        const std::string fallback = section.Has("fallback") ? section.Scalar<std::string>("fallback") : "damping";
+        if (fallback != "damping" && fallback != "getdown")
+        {
+            section.Fail("fallback", "'" + fallback + "' is neither damping nor getdown");
+        }
+        safety.fallback = fallback == "getdown" ? SAFETY_FALLBACK_GETDOWN : SAFETY_FALLBACK_DAMPING;
+        safety.report_period = section.Has("report_period") ? section.Scalar<double>("report_period") : 1.0;
+        if (!(safety.report_period > 0.0))
+        {
+            section.Fail("report_period", "must be positive");
+        }
+
+        // every check is a map with its ticks and limits, a check that is not listed is not run
+        const struct
+        {
+            const char *key;
+            int32_t check;
+            bool urdf; // limits from the generated kinematics
+            struct
+            {
+                const char *key;
+                double fallback;
+                double *value;
+            } limits[2];
+        } checks[] = {
+            {"joint_position", SAFETY_JOINT_POSITION, true, {{"margin", 0.1, &safety.position_margin}, {nullptr, 0.0, nullptr}}},
+            {"joint_velocity", SAFETY_JOINT_VELOCITY, true, {{"scale", 1.0, &safety.velocity_scale}, {nullptr, 0.0, nullptr}}},
+            {"torque", SAFETY_TORQUE, false, {{"scale", 1.0, &safety.torque_scale}, {nullptr, 0.0, nullptr}}},
+            {"attitude", SAFETY_ATTITUDE, false, {{"max_roll", 60.0, &safety.max_roll}, {"max_pitch", 60.0, &safety.max_pitch}}},
+            {"command_age", SAFETY_COMMAND_AGE, false, {{"timeout", 0.1, &safety.command_timeout}, {nullptr, 0.0, nullptr}}},
+            {"non_finite", SAFETY_NON_FINITE, false, {{nullptr, 0.0, nullptr}, {nullptr, 0.0, nullptr}}},
+        };
+        for (const auto &entry : checks)
+        {
+            if (!section.Has(entry.key) || section.Require(entry.key).IsNull())
+            {
+                continue;
+            }
+            if (!section.Require(entry.key).IsMap())
+            {
+                section.Fail(entry.key, "expected a map with ticks and the limits");
+            }
+            if (entry.urdf && !reader.Has("kinematics"))
+            {
+                section.Fail(entry.key, "takes the URDF limits from the generated kinematics, add a kinematics section");
+            }
+            Reader check(section_path + ": " + entry.key, section.Require(entry.key));
+            // one tick over a limit is as likely a noisy sample as a fault
+            safety.ticks[entry.check] = check.Has("ticks") ? check.Scalar<int32_t>("ticks") : 3;
+            if (safety.ticks[entry.check] < 1)
+            {
+                check.Fail("ticks", "must be at least 1");
+            }
+            for (const auto &limit : entry.limits)
+            {
+                if (!limit.key)
+                {
+                    continue;
+                }
+                *limit.value = check.Has(limit.key) ? check.Scalar<double>(limit.key) : limit.fallback;
+                if (!(*limit.value >= 0.0))
+                {
+                    check.Fail(limit.key, "must not be negative");
+                }
+            }
+        }
+    }
+
+    // mtimes are only as fine as the kernel tick, so an equal one counts as possibly newer
+    bool NotOlderThan(const std::string &path, const struct stat &reference)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            return false;
+        }
+        return info.st_mtim.tv_sec > reference.st_mtim.tv_sec ||
+               (info.st_mtim.tv_sec == reference.st_mtim.tv_sec && info.st_mtim.tv_nsec >= reference.st_mtim.tv_nsec);
+    }
+
+    bool Exists(const std::string &path)
+    {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0;
+    }
+
+    // the bundle if it is usable and not older than any of the given sources
+    bool OpenFresh(ConfigBundle &bundle, const std::string &bundle_dir, const std::string &robot_name, const std::vector<std::string> &sources)
+    {
+        if (bundle_dir.empty())
+        {
+            return false;
+        }
+        std::string path = bundle_dir + "/" + robot_name + ".bundle";
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            return false;
+        }
+        for (const std::string &source : sources)
+        {
+            if (NotOlderThan(source, info))
+            {
+                return false; // edited since the last build
+            }
+        }
+        return bundle.Open(path).empty();
+    }
+}
+
+namespace config_bundle
+{
+    void ParseBase(const std::string &path, const std::string &robot_name, BaseConfig &config)
+    {
+        memset(&config, 0, sizeof(config));
+        Reader reader(path, LoadSection(path, robot_name));
+
+        config.dt = reader.Scalar<double>("dt");
+        if (!(config.dt > 0.0 && config.dt <= 1.0))
+        {
+            reader.Fail("dt", "must be in (0, 1] seconds");
+        }
+        config.decimation = reader.Scalar<int>("decimation");
+        if (config.decimation < 1)
+        {
+            reader.Fail("decimation", "must be at least 1");
+        }
+        config.num_of_dofs = NumOfDofs(reader);
+        ParseJoints(reader, config);
+        ParseVelocityEstimator(path, reader, config);
+        ParseSafety(path, reader, config);
+    }
+
+    void ParseRL(const std::string &path, const std::string &robot_name, const std::string &config_name, RLConfig &config)
+    {
+        memset(&config, 0, sizeof(config));
+        Reader reader(path, LoadSection(path, robot_name + "/" + config_name));
+
+        reader.Name("config_name", config_name, config.config_name);
+        reader.Name("model_name", reader.Scalar<std::string>("model_name"), config.model_name);
+        std::string framework = reader.Scalar<std::string>("framework");
+        if (framework != "isaacgym" && framework != "isaacsim")
+        {
+            reader.Fail("framework", "'" + framework + "' is neither isaacgym nor isaacsim");
+        }
+        reader.Name("framework", framework, config.framework);
+        // optional, "int8" runs the model written by scripts/quantize_policy.py
+        std::string precision = reader.Has("precision") ? reader.Scalar<std::string>("precision") : "fp32";
+        if (precision != "fp32" && precision != "int8")
+        {
+            reader.Fail("precision", "'" + precision + "' is neither fp32 nor int8");
+        }
+        reader.Name("precision", precision, config.precision);
+        config.num_of_dofs = NumOfDofs(reader);
+        const size_t n = config.num_of_dofs;
+
+        std::vector<std::string> observations = reader.List<std::string>("observations");
+        if (observations.empty() || observations.size() > CONFIG_MAX_OBSERVATIONS)
+        {
+            reader.Fail("observations", "needs 1 to " + std::to_string(CONFIG_MAX_OBSERVATIONS) + " terms");
+        }
+        int observation_size = 0;
+        for (size_t i = 0; i < observations.size(); ++i)
+        {
+            int size = ObservationSize(observations[i], config.num_of_dofs);
+            if (size < 0)
+            {
+                reader.Fail("observations", "unknown term '" + observations[i] + "'");
+            }
+            observation_size += size;
+            reader.Name("observations", observations[i], config.observations[i]);
+        }
+        config.num_observation_terms = observations.size();
+        config.num_observations = reader.Scalar<int>("num_observations");
+        if (config.num_observations != observation_size)
+        {
+            reader.Fail("num_observations", std::to_string(config.num_observations) + " does not match the " + std::to_string(observation_size) + " values the observations produce");
+        }
+
+        std::vector<int32_t> history = reader.List<int32_t>("observations_history", true);
+        if (history.size() > CONFIG_MAX_HISTORY)
+        {
+            reader.Fail("observations_history", "at most " + std::to_string(CONFIG_MAX_HISTORY) + " entries");
+        }
+        for (int32_t index : history)
+        {
+            if (index < 0 || index >= static_cast<int32_t>(history.size()))
+            {
+                reader.Fail("observations_history", "index " + std::to_string(index) + " is outside the history length");
+            }
+        }
+        config.num_history = history.size();
+        Copy(history, config.observations_history);
+
+        // optional, one shape per recurrent state the policy takes after the observations and
+        // returns after the actions: forward(obs, h, c) -> (actions, h, c)
+        YAML::Node hidden_states = reader.Has("hidden_states") ? reader.Require("hidden_states") : YAML::Node();
+        if (hidden_states && !hidden_states.IsNull())
+        {
+            if (!hidden_states.IsSequence() || hidden_states.size() > CONFIG_MAX_HIDDEN_STATES)
+            {
+                reader.Fail("hidden_states", "expected a list of at most " + std::to_string(CONFIG_MAX_HIDDEN_STATES) + " shapes");
+            }
+            for (size_t i = 0; i < hidden_states.size(); ++i)
+            {
+                const YAML::Node shape = hidden_states[i];
+                if (!shape.IsSequence() || shape.size() < 1 || shape.size() > CONFIG_MAX_HIDDEN_RANK)
+                {
+                    reader.Fail("hidden_states", "entry " + std::to_string(i) + " must be a shape with 1 to " + std::to_string(CONFIG_MAX_HIDDEN_RANK) + " dimensions");
+                }
+                for (size_t j = 0; j < shape.size(); ++j)
+                {
+                    int32_t size = 0;
+                    try
+                    {
+                        size = shape[j].as<int32_t>();
+                    }
+                    catch (const YAML::Exception &)
+                    {
+                    }
+                    if (size < 1)
+                    {
+                        reader.Fail("hidden_states", "entry " + std::to_string(i) + " has the invalid size '" + YAML::Dump(shape[j]) + "'");
+                    }
+                    config.hidden_state_shapes[i][j] = size;
+                }
+                config.hidden_state_ranks[i] = shape.size();
+            }
+            config.num_hidden_states = hidden_states.size();
+        }
+        ParsePolicyInputs(path, reader, config);
+
+        config.clip_obs = reader.Scalar<double>("clip_obs");
+        if (!(config.clip_obs > 0.0))
+        {
+            reader.Fail("clip_obs", "must be positive");
+        }
+        bool lower_null = reader.Require("clip_actions_lower").IsNull();
+        bool upper_null = reader.Require("clip_actions_upper").IsNull();
+        if (lower_null != upper_null)
+        {
+            reader.Fail(lower_null ? "clip_actions_lower" : "clip_actions_upper", "set both action clips or neither");
+        }
+        if (!lower_null)
+        {
+            std::vector<double> lower = reader.List<double>("clip_actions_lower", n);
+            std::vector<double> upper = reader.List<double>("clip_actions_upper", n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (lower[i] > upper[i])
+                {
+                    reader.Fail("clip_actions_lower", "entry " + std::to_string(i) + " is above clip_actions_upper");
+                }
+            }
+            config.has_clip_actions = 1;
+            Copy(lower, config.clip_actions_lower);
+            Copy(upper, config.clip_actions_upper);
+        }
+
+        Copy(reader.List<double>("action_scale", n), config.action_scale);
+        Copy(reader.List<double>("rl_kp", n), config.rl_kp);
+        Copy(reader.List<double>("rl_kd", n), config.rl_kd);
+        config.lin_vel_scale = reader.Scalar<double>("lin_vel_scale");
+        config.ang_vel_scale = reader.Scalar<double>("ang_vel_scale");
+        config.dof_pos_scale = reader.Scalar<double>("dof_pos_scale");
+        config.dof_vel_scale = reader.Scalar<double>("dof_vel_scale");
+        std::vector<double> commands_scale = reader.List<double>("commands_scale");
+        if (commands_scale.size() != CONFIG_COMMANDS)
+        {
+            reader.Fail("commands_scale", "expected " + std::to_string(CONFIG_COMMANDS) + " entries for x, y and yaw");
+        }
+        Copy(commands_scale, config.commands_scale);
+        ParseJoints(reader, config);
+    }
+
+    void CheckPair(const std::string &path, const BaseConfig &base, const RLConfig &config)
+    {
+        if (config.num_of_dofs > base.num_of_dofs)
+        {
+            throw ConfigError(path + ": num_of_dofs: " + std::to_string(config.num_of_dofs) + " exceeds the " + std::to_string(base.num_of_dofs) + " joints of base.yaml");
+        }
+        for (int i = 0; i < config.num_of_dofs; ++i)
+        {
+            bool known = false;
+            for (int j = 0; j < base.num_of_dofs && !known; ++j)
+            {
+                known = strcmp(config.joint_controller_names[i], base.joint_controller_names[j]) == 0;
+            }
+            if (!known)
+            {
+                throw ConfigError(path + ": joint_controller_names: '" + config.joint_controller_names[i] + "' is not in base.yaml");
+            }
+        }
+        // the estimator reads the legs from the joint order of the running config
+        const VelocityEstimatorConfig &estimator = base.velocity_estimator;
+        const bool uses_lin_vel = std::find_if(config.observations, config.observations + config.num_observation_terms,
+                                               [](const char *observation) { return std::string(observation) == "lin_vel"; }) != config.observations + config.num_observation_terms;
+        if (uses_lin_vel && estimator.num_legs == 0)
+        {
+            throw ConfigError(path + ": observations: lin_vel needs a velocity_estimator in base.yaml");
+        }
+        for (int i = 0; i < estimator.num_legs && uses_lin_vel; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                bool known = false;
+                for (int k = 0; k < config.num_of_dofs && !known; ++k)
+                {
+                    known = strcmp(estimator.joints[i][j], config.joint_controller_names[k]) == 0;
+                }
+                if (!known)
+                {
+                    throw ConfigError(path + ": joint_controller_names: the velocity estimator needs '" + estimator.joints[i][j] + "'");
+                }
+            }
+        }
+    }
+
+    std::vector<int64_t> PolicyInputShape(const RLConfig &config, const PolicyInputConfig &input)
+    {
+        switch (input.source)
+        {
+        case POLICY_INPUT_HISTORY:
+            if (input.layout == POLICY_INPUT_STACKED)
+            {
+                return {1, config.num_history, config.num_observations};
+            }
+            return {1, static_cast<int64_t>(config.num_history) * config.num_observations};
+        case POLICY_INPUT_COMMANDS:
+            return {1, CONFIG_COMMANDS};
+        case POLICY_INPUT_HIDDEN_STATE:
+            return std::vector<int64_t>(config.hidden_state_shapes[input.index], config.hidden_state_shapes[input.index] + config.hidden_state_ranks[input.index]);
+        default:
+            return {1, config.num_observations};
+        }
+    }
+
+    std::string ModelFile(const RLConfig &config)
+    {
+        std::string model_name = config.model_name;
+        if (std::string(config.precision) != "int8")
+        {
+            return model_name;
+        }
+        return model_name.substr(0, model_name.rfind('.')) + "_int8.pt";
+    }
+
+    std::vector<uint8_t> Serialize(const std::string &robot_name, const BaseConfig &base, const std::vector<RLConfig> &configs)
+    {
+        std::vector<uint8_t> data(sizeof(ConfigBundleHeader) + sizeof(BaseConfig) + configs.size() * sizeof(RLConfig), 0);
+        ConfigBundleHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = CONFIG_BUNDLE_MAGIC;
+        header.version = CONFIG_BUNDLE_VERSION;
+        header.size = data.size();
+        header.base_size = sizeof(BaseConfig);
+        header.config_size = sizeof(RLConfig);
+        header.num_configs = configs.size();
+        if (robot_name.empty() || robot_name.size() >= CONFIG_NAME_SIZE)
+        {
+            throw ConfigError(robot_name + ": robot name must have 1 to " + std::to_string(CONFIG_NAME_SIZE - 1) + " characters");
+        }
+        memcpy(header.robot_name, robot_name.data(), robot_name.size());
+
+        uint8_t *cursor = data.data() + sizeof(ConfigBundleHeader);
+        memcpy(cursor, &base, sizeof(BaseConfig));
+        cursor += sizeof(BaseConfig);
+        for (const RLConfig &config : configs)
+        {
+            memcpy(cursor, &config, sizeof(RLConfig));
+            cursor += sizeof(RLConfig);
+        }
+        header.crc = crc32::Core(reinterpret_cast<const uint32_t *>(data.data() + sizeof(ConfigBundleHeader)), (data.size() - sizeof(ConfigBundleHeader)) >> 2);
+        memcpy(data.data(), &header, sizeof(header));
+        return data;
+    }
+
+    Source LoadBase(const std::string &models_dir, const std::string &bundle_dir, const std::string &robot_name, BaseConfig &config)
+    {
+        std::string path = models_dir + "/" + robot_name + "/base.yaml";
+        ConfigBundle bundle;
+        if (OpenFresh(bundle, bundle_dir, robot_name, {path}))
+        {
+            config = *bundle.Base();
+            return SOURCE_BUNDLE;
+        }
+        if (!Exists(path))
+        {
+            return SOURCE_NONE;
+        }
+        ParseBase(path, robot_name, config);
+        return SOURCE_YAML;
+    }
+
+    Source LoadRL(const std::string &models_dir, const std::string &bundle_dir, const std::string &robot_name, const std::string &config_name, RLConfig &config)
+    {
+        std::string base_path = models_dir + "/" + robot_name + "/base.yaml";
+        std::string path = models_dir + "/" + robot_name + "/" + config_name + "/config.yaml";
+        ConfigBundle bundle;
+        if (OpenFresh(bundle, bundle_dir, robot_name, {base_path, path}))
+        {
+            const RLConfig *found = bundle.Find(config_name);
+            if (found)
+            {
+                config = *found;
+                return SOURCE_BUNDLE;
+            }
+        }
+        if (!Exists(path))
+        {
+            return SOURCE_NONE;
+        }
+        ParseRL(path, robot_name, config_name, config);
+        if (Exists(base_path))
+        {
+            BaseConfig base;
+            ParseBase(base_path, robot_name, base);
+            CheckPair(path, base, config);
+        }
+        return SOURCE_YAML;
+    }
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CONFIG_BUNDLE_HPP
+#define CONFIG_BUNDLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Binary image of one robot's models/<robot>/base.yaml and every models/<robot>/<config>/config.yaml,
+ * written at build time by config_bundler and mapped read-only at runtime.
+ *
+ *   ConfigBundleHeader                   offset 0
+ *   BaseConfig                           offset sizeof(ConfigBundleHeader)
+ *   RLConfig configs[num_configs]        right after, sizeof(RLConfig) each
+ *
+ * Everything is fixed size and in host byte order, the bundle is rebuilt with the binaries. The
+ * header records the struct sizes so a bundle from another layout is rejected instead of misread,
+ * and a crc over everything after the header catches truncated or corrupted files.
+ */
+
+#define CONFIG_BUNDLE_MAGIC 0x46435352 // "RSCF"
+#define CONFIG_BUNDLE_VERSION 7
+#define CONFIG_MAX_DOFS 32
+#define CONFIG_MAX_OBSERVATIONS 16
+#define CONFIG_MAX_HISTORY 64
+#define CONFIG_NAME_SIZE 64
+#define CONFIG_SHORT_NAME_SIZE 32
+#define CONFIG_COMMANDS 3
+#define CONFIG_MAX_HIDDEN_STATES 4
+#define CONFIG_MAX_HIDDEN_RANK 4
+#define CONFIG_MAX_POLICY_INPUTS 8
+#define CONFIG_MAX_LEGS 4
+
+struct ConfigBundleHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;        // whole file
+    uint32_t crc;         // crc32::Core over the words after the header
+    uint32_t base_size;   // sizeof(BaseConfig) of the writer
+    uint32_t config_size; // sizeof(RLConfig) of the writer
+    uint32_t num_configs;
+    uint32_t reserved;
+    char robot_name[CONFIG_NAME_SIZE];
+};
+
+// legs and noise of the base velocity estimator; the feet come from the kinematics generated
+// from the URDF, so base.yaml needs a kinematics section as well
+struct VelocityEstimatorConfig
+{
+    int32_t num_legs; // 0 when base.yaml has no velocity_estimator
+    int32_t reserved;
+    double accelerometer_noise; // m/s^2
+    double bias_noise;          // accelerometer bias random walk, m/s^2/sqrt(s)
+    double foot_velocity_noise; // m/s
+    double contact_height;      // feet this close to the lowest one count as standing, m
+    double budget_us;           // expected worst case of one update
+    char joints[CONFIG_MAX_LEGS][3][CONFIG_NAME_SIZE]; // hip, thigh and calf controller of each leg
+};
+
+// checks of the safety supervisor, in the order of the per-check tables
+enum SafetyCheck
+{
+    SAFETY_JOINT_POSITION = 0, // URDF limits widened by position_margin
+    SAFETY_JOINT_VELOCITY,     // URDF limits times velocity_scale
+    SAFETY_TORQUE,             // torque the command asks for against torque_limits times torque_scale
+    SAFETY_ATTITUDE,           // roll and pitch
+    SAFETY_COMMAND_AGE,        // age of the policy action applied in an RL state
+    SAFETY_NON_FINITE,         // NaN or Inf in the command
+    SAFETY_NUM_CHECKS,
+};
+
+enum SafetyFallback
+{
+    SAFETY_FALLBACK_DAMPING = 0,
+    SAFETY_FALLBACK_GETDOWN,
+};
+
+// limits of the safety supervisor; a check trips after ticks consecutive control ticks over its
+// limit and counts as clear again after as many ticks within it, 0 ticks leaves it out
+struct SafetyConfig
+{
+    int32_t enabled;  // 0 when base.yaml has no safety section
+    int32_t fallback; // SafetyFallback
+    int32_t ticks[SAFETY_NUM_CHECKS];
+    double position_margin; // rad or m beyond the URDF limits
+    double velocity_scale;
+    double torque_scale;
+    double max_roll;        // degrees
+    double max_pitch;       // degrees
+    double command_timeout; // s
+    double report_period;   // s between two reports of ongoing violations
+};
+
+struct BaseConfig
+{
+    double dt;
+    int32_t decimation;
+    int32_t num_of_dofs;
+    int32_t num_wheels;
+    int32_t reserved;
+    int32_t wheel_indices[CONFIG_MAX_DOFS];
+    int32_t command_mapping[CONFIG_MAX_DOFS];
+    int32_t state_mapping[CONFIG_MAX_DOFS];
+    double fixed_kp[CONFIG_MAX_DOFS];
+    double fixed_kd[CONFIG_MAX_DOFS];
+    double torque_limits[CONFIG_MAX_DOFS];
+    double default_dof_pos[CONFIG_MAX_DOFS];
+    char joint_controller_names[CONFIG_MAX_DOFS][CONFIG_NAME_SIZE];
+    VelocityEstimatorConfig velocity_estimator;
+    SafetyConfig safety;
+};
+
+// where an argument of the policy's forward() comes from
+enum PolicyInputSource
+{
+    POLICY_INPUT_OBS = 0,      // this tick's observation, [1, num_observations]
+    POLICY_INPUT_HISTORY,      // observations_history, [1, H * num_observations] flat or [1, H, num_observations] stacked
+    POLICY_INPUT_COMMANDS,     // scaled x, y and yaw command, [1, 3]
+    POLICY_INPUT_HIDDEN_STATE, // hidden_states[index]
+};
+
+enum PolicyInputLayout
+{
+    POLICY_INPUT_FLAT = 0,
+    POLICY_INPUT_STACKED,
+};
+
+struct PolicyInputConfig
+{
+    char name[CONFIG_SHORT_NAME_SIZE];
+    int32_t source; // PolicyInputSource
+    int32_t layout; // PolicyInputLayout, history only
+    int32_t index;  // hidden state, POLICY_INPUT_HIDDEN_STATE only
+    int32_t reserved;
+};
+
+struct RLConfig
+{
+    char config_name[CONFIG_NAME_SIZE]; // directory name, e.g. "robot_lab"
+    char model_name[CONFIG_NAME_SIZE];
+    char framework[CONFIG_SHORT_NAME_SIZE];
+    char precision[CONFIG_SHORT_NAME_SIZE]; // "fp32" or "int8"
+    int32_t num_of_dofs;
+    int32_t num_observations;
+    int32_t num_observation_terms;
+    int32_t num_history;
+    int32_t num_wheels;
+    int32_t has_clip_actions;
+    int32_t num_hidden_states; // recurrent policies, e.g. 2 for an LSTM's h and c
+    int32_t hidden_state_ranks[CONFIG_MAX_HIDDEN_STATES];
+    int32_t hidden_state_shapes[CONFIG_MAX_HIDDEN_STATES][CONFIG_MAX_HIDDEN_RANK];
+    int32_t num_policy_inputs; // always set, ParseRL() fills in the default signature
+    PolicyInputConfig policy_inputs[CONFIG_MAX_POLICY_INPUTS];
+    char observations[CONFIG_MAX_OBSERVATIONS][CONFIG_SHORT_NAME_SIZE];
+    int32_t observations_history[CONFIG_MAX_HISTORY];
+    int32_t wheel_indices[CONFIG_MAX_DOFS];
+    int32_t command_mapping[CONFIG_MAX_DOFS];
+    int32_t state_mapping[CONFIG_MAX_DOFS];
+    double clip_obs;
+    double lin_vel_scale;
+    double ang_vel_scale;
+    double dof_pos_scale;
+    double dof_vel_scale;
+    double commands_scale[CONFIG_COMMANDS];
+    double reserved;
+    double clip_actions_lower[CONFIG_MAX_DOFS];
+    double clip_actions_upper[CONFIG_MAX_DOFS];
+    double action_scale[CONFIG_MAX_DOFS];
+    double rl_kp[CONFIG_MAX_DOFS];
+    double rl_kd[CONFIG_MAX_DOFS];
+    double fixed_kp[CONFIG_MAX_DOFS];
+    double fixed_kd[CONFIG_MAX_DOFS];
+    double torque_limits[CONFIG_MAX_DOFS];
+    double default_dof_pos[CONFIG_MAX_DOFS];
+    char joint_controller_names[CONFIG_MAX_DOFS][CONFIG_NAME_SIZE];
+};
+
+static_assert(sizeof(ConfigBundleHeader) % 8 == 0 && sizeof(BaseConfig) % 8 == 0 && sizeof(RLConfig) % 8 == 0, "config bundle sections must stay 8-byte aligned");
+
+// Thrown with "<file>: <key>: <problem>" when a config does not describe a usable robot
+class ConfigError : public std::runtime_error
+{
+public:
+    explicit ConfigError(const std::string &message) : std::runtime_error(message) {}
+};
+
+/**
+ * @brief Read-only mapping of a bundle written by config_bundler.
+ *
+ * Open() checks magic, version, struct sizes and crc once; afterwards Base() and Find() return
+ * pointers into the mapping, so loading a config is a lookup and a copy.
+ */
+class ConfigBundle
+{
+public:
+    ConfigBundle() {}
+    ~ConfigBundle() { this->Close(); }
+    ConfigBundle(const ConfigBundle &) = delete;
+    ConfigBundle &operator=(const ConfigBundle &) = delete;
+
+    // empty string on success, otherwise why the file was rejected
+    std::string Open(const std::string &path);
+    void Close();
+
+    const BaseConfig *Base() const;
+    const RLConfig *Find(const std::string &config_name) const;
+
+private:
+    const ConfigBundleHeader *header = nullptr;
+    size_t size = 0;
+};
+
+namespace config_bundle
+{
+    // YAML front end shared by config_bundler and the development fallback, throws ConfigError
+    void ParseBase(const std::string &path, const std::string &robot_name, BaseConfig &config);
+    void ParseRL(const std::string &path, const std::string &robot_name, const std::string &config_name, RLConfig &config);
+    // checks that only make sense with both files at hand, e.g. joint names known to base.yaml
+    void CheckPair(const std::string &path, const BaseConfig &base, const RLConfig &config);
+
+    // shape the runtime binds for one of config.policy_inputs
+    std::vector<int64_t> PolicyInputShape(const RLConfig &config, const PolicyInputConfig &input);
+
+    // file the runtime runs, <model>_int8.pt from scripts/quantize_policy.py for precision int8
+    std::string ModelFile(const RLConfig &config);
+
+    std::vector<uint8_t> Serialize(const std::string &robot_name, const BaseConfig &base, const std::vector<RLConfig> &configs);
+
+    enum Source
+    {
+        SOURCE_NONE = 0, // neither a bundle nor the YAML file exists
+        SOURCE_BUNDLE,
+        SOURCE_YAML,
+    };
+
+    /*
+     * Loads from <bundle_dir>/<robot>.bundle when it exists, is valid and is newer than the YAML
+     * files it was built from; otherwise parses and validates the YAML under models_dir, which is
+     * the development path while editing configs between builds.
+     */
+    Source LoadBase(const std::string &models_dir, const std::string &bundle_dir, const std::string &robot_name, BaseConfig &config);
+    Source LoadRL(const std::string &models_dir, const std::string &bundle_dir, const std::string &robot_name, const std::string &config_name, RLConfig &config);
+}
+
+#endif // CONFIG_BUNDLE_HPP
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crc32.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC32_FOLDING_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CRC32_FOLDING_ARM
+#endif
+
+namespace crc32
+{
+    namespace
+    {
+        const uint32_t POLYNOMIAL = 0x04c11db7;
+
+        // T[k][b]: register after feeding byte b followed by k zero bytes
+        struct Tables
+        {
+            uint32_t t[8][256];
+
+            constexpr Tables() : t{}
+            {
+                for (uint32_t b = 0; b < 256; ++b)
+                {
+                    uint32_t crc = b << 24;
+                    for (int bit = 0; bit < 8; ++bit)
+                    {
+                        crc = (crc & 0x80000000) ? (crc << 1) ^ POLYNOMIAL : crc << 1;
+                    }
+                    t[0][b] = crc;
+                }
+                for (int k = 1; k < 8; ++k)
+                {
+                    for (uint32_t b = 0; b < 256; ++b)
+                    {
+                        t[k][b] = (t[k - 1][b] << 8) ^ t[0][t[k - 1][b] >> 24];
+                    }
+                }
+            }
+        };
+
+        constexpr Tables tables;
+
+        uint32_t SliceBy8(uint32_t crc, const uint32_t *ptr, uint32_t len)
+        {
+            const uint32_t (*t)[256] = tables.t;
+            for (; len >= 2; len -= 2, ptr += 2)
+            {
+                uint32_t v = crc ^ ptr[0];
+                uint32_t w = ptr[1];
+                crc = t[7][v >> 24] ^ t[6][(v >> 16) & 0xff] ^ t[5][(v >> 8) & 0xff] ^ t[4][v & 0xff] ^
+                      t[3][w >> 24] ^ t[2][(w >> 16) & 0xff] ^ t[1][(w >> 8) & 0xff] ^ t[0][w & 0xff];
+            }
+            if (len)
+            {
+                uint32_t v = crc ^ ptr[0];
+                crc = t[3][v >> 24] ^ t[2][(v >> 16) & 0xff] ^ t[1][(v >> 8) & 0xff] ^ t[0][v & 0xff];
+            }
+            return crc;
+        }
+
+        // x^n mod P, the folding distances as 32-bit constants
+        constexpr uint64_t XPowMod(int n)
+        {
+            uint32_t r = 1;
+            for (int i = 0; i < n; ++i)
+            {
+                r = (r & 0x80000000) ? (r << 1) ^ POLYNOMIAL : r << 1;
+            }
+            return r;
+        }
+
+        // Folding works on 128-bit chunks of four words with the first word in the top lane, so
+        // that bit i of the register is the coefficient of x^i. A chunk A followed by d bits is
+        // congruent to A.hi * (x^(d+64) mod P) + A.lo * (x^d mod P), which is what one carry-less
+        // multiply pair computes. Four chunks are folded in parallel, then merged, and the final
+        // 128-bit remainder plus any leftover words go through the table path.
+        constexpr uint64_t K128_LO = XPowMod(128);
+        constexpr uint64_t K128_HI = XPowMod(128 + 64);
+        constexpr uint64_t K512_LO = XPowMod(512);
+        constexpr uint64_t K512_HI = XPowMod(512 + 64);
+        constexpr uint32_t MIN_FOLDING_WORDS = 16;
+
+#if defined(CRC32_FOLDING_X86)
+        __attribute__((target("pclmul,sse4.1"))) inline __m128i Load(const uint32_t *ptr)
+        {
+            return _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)), 0x1b);
+        }
+
+        __attribute__((target("pclmul,sse4.1"))) inline __m128i Fold(__m128i x, __m128i k, __m128i next)
+        {
+            return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), next);
+        }
+
+        __attribute__((target("pclmul,sse4.1"))) uint32_t FoldingImpl(const uint32_t *ptr, uint32_t len)
+        {
+            const __m128i k128 = _mm_set_epi64x(K128_HI, K128_LO);
+            const __m128i k512 = _mm_set_epi64x(K512_HI, K512_LO);
+            uint32_t chunks = len / 4;
+
+            __m128i x = _mm_xor_si128(Load(ptr), _mm_set_epi32(-1, 0, 0, 0));
+            uint32_t i = 1;
+            if (chunks >= 8)
+            {
+                __m128i x1 = Load(ptr + 4), x2 = Load(ptr + 8), x3 = Load(ptr + 12);
+                for (i = 4; i + 4 <= chunks; i += 4)
+                {
+                    const uint32_t *p = ptr + 4 * i;
+                    x = Fold(x, k512, Load(p));
+                    x1 = Fold(x1, k512, Load(p + 4));
+                    x2 = Fold(x2, k512, Load(p + 8));
+                    x3 = Fold(x3, k512, Load(p + 12));
+                }
+                x = Fold(x, k128, x1);
+                x = Fold(x, k128, x2);
+                x = Fold(x, k128, x3);
+            }
+            for (; i < chunks; ++i)
+            {
+                x = Fold(x, k128, Load(ptr + 4 * i));
+            }
+
+            uint32_t rest[4] = {
+                static_cast<uint32_t>(_mm_extract_epi32(x, 3)), static_cast<uint32_t>(_mm_extract_epi32(x, 2)),
+                static_cast<uint32_t>(_mm_extract_epi32(x, 1)), static_cast<uint32_t>(_mm_extract_epi32(x, 0))};
+            uint32_t crc = SliceBy8(0, rest, 4);
+            return SliceBy8(crc, ptr + 4 * chunks, len - 4 * chunks);
+        }
+
+        bool DetectFolding()
+        {
+            // runs from a static initializer, before libgcc may have filled in its cpu model
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+        }
+
+        const char *FOLDING_NAME = "pclmulqdq";
+#elif defined(CRC32_FOLDING_ARM)
+        __attribute__((target("arch=armv8-a+crypto"))) inline uint64x2_t Load(const uint32_t *ptr)
+        {
+            uint32x4_t v = vrev64q_u32(vld1q_u32(ptr));
+            return vreinterpretq_u64_u32(vextq_u32(v, v, 2));
+        }
+
+        __attribute__((target("arch=armv8-a+crypto"))) inline uint64x2_t Fold(uint64x2_t x, uint64x2_t k, uint64x2_t next)
+        {
+            poly64x2_t px = vreinterpretq_p64_u64(x), pk = vreinterpretq_p64_u64(k);
+            uint64x2_t lo = vreinterpretq_u64_p128(vmull_p64(vgetq_lane_p64(px, 0), vgetq_lane_p64(pk, 0)));
+            uint64x2_t hi = vreinterpretq_u64_p128(vmull_p64(vgetq_lane_p64(px, 1), vgetq_lane_p64(pk, 1)));
+            return veorq_u64(veorq_u64(lo, hi), next);
+        }
+
+        __attribute__((target("arch=armv8-a+crypto"))) uint32_t FoldingImpl(const uint32_t *ptr, uint32_t len)
+        {
+            const uint64_t k128_values[2] = {K128_LO, K128_HI};
+            const uint64_t k512_values[2] = {K512_LO, K512_HI};
+            const uint64x2_t k128 = vld1q_u64(k128_values);
+            const uint64x2_t k512 = vld1q_u64(k512_values);
+            const uint32_t init_values[4] = {0, 0, 0, 0xffffffff};
+            uint32_t chunks = len / 4;
+
+            uint64x2_t x = veorq_u64(Load(ptr), vreinterpretq_u64_u32(vld1q_u32(init_values)));
+            uint32_t i = 1;
+            if (chunks >= 8)
+            {
+                uint64x2_t x1 = Load(ptr + 4), x2 = Load(ptr + 8), x3 = Load(ptr + 12);
+                for (i = 4; i + 4 <= chunks; i += 4)
+                {
+                    const uint32_t *p = ptr + 4 * i;
+                    x = Fold(x, k512, Load(p));
+                    x1 = Fold(x1, k512, Load(p + 4));
+                    x2 = Fold(x2, k512, Load(p + 8));
+                    x3 = Fold(x3, k512, Load(p + 12));
+                }
+                x = Fold(x, k128, x1);
+                x = Fold(x, k128, x2);
+                x = Fold(x, k128, x3);
+            }
+            for (; i < chunks; ++i)
+            {
+                x = Fold(x, k128, Load(ptr + 4 * i));
+            }
+
+            uint32_t lanes[4];
+            vst1q_u32(lanes, vreinterpretq_u32_u64(x));
+            uint32_t rest[4] = {lanes[3], lanes[2], lanes[1], lanes[0]};
+            uint32_t crc = SliceBy8(0, rest, 4);
+            return SliceBy8(crc, ptr + 4 * chunks, len - 4 * chunks);
+        }
+
+        bool DetectFolding()
+        {
+            return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+        }
+
+        const char *FOLDING_NAME = "pmull";
+#else
+        uint32_t FoldingImpl(const uint32_t *ptr, uint32_t len)
+        {
+            return SliceBy8(0xffffffff, ptr, len);
+        }
+
+        bool DetectFolding()
+        {
+            return false;
+        }
+
+        const char *FOLDING_NAME = "slice-by-8";
+#endif
+
+        const bool folding_supported = DetectFolding();
+    }
+
+    uint32_t Bitwise(const uint32_t *ptr, uint32_t len)
+    {
+        uint32_t crc = 0xffffffff;
+        for (uint32_t i = 0; i < len; ++i)
+        {
+            uint32_t data = ptr[i];
+            for (uint32_t bit = 1u << 31; bit != 0; bit >>= 1)
+            {
+                crc = (crc & 0x80000000) ? (crc << 1) ^ POLYNOMIAL : crc << 1;
+                if (data & bit)
+                {
+                    crc ^= POLYNOMIAL;
+                }
+            }
+        }
+        return crc;
+    }
+
+    uint32_t SliceBy8(const uint32_t *ptr, uint32_t len)
+    {
+        return SliceBy8(0xffffffff, ptr, len);
+    }
+
+    uint32_t Folding(const uint32_t *ptr, uint32_t len)
+    {
+        if (!folding_supported || len < MIN_FOLDING_WORDS)
+        {
+            return SliceBy8(0xffffffff, ptr, len);
+        }
+        return FoldingImpl(ptr, len);
+    }
+
+    bool FoldingSupported()
+    {
+        return folding_supported;
+    }
+
+    uint32_t Core(const uint32_t *ptr, uint32_t len)
+    {
+        return Folding(ptr, len);
+    }
+
+    const char *Implementation()
+    {
+        return folding_supported ? FOLDING_NAME : "slice-by-8";
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CRC32_HPP
+#define CRC32_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Checksum used by the Unitree low-level messages (Go2/B2/G1/H1 LowCmd_, legged_sdk
+ *        LowCmd/LowState).
+ *
+ * Non-reflected polynomial 0x04C11DB7, initial value 0xFFFFFFFF, no final xor, fed one
+ * native 32-bit word at a time, most significant bit first. Callers pass the message as
+ * words and the number of words in front of the crc field, usually (sizeof(msg) >> 2) - 1.
+ */
+namespace crc32
+{
+    // fastest implementation supported by the running CPU, selected once at load time
+    uint32_t Core(const uint32_t *ptr, uint32_t len);
+
+    // individual implementations, all bit-exact with each other
+    uint32_t Bitwise(const uint32_t *ptr, uint32_t len);
+    uint32_t SliceBy8(const uint32_t *ptr, uint32_t len);
+    // PCLMULQDQ on x86-64, PMULL on ARMv8; falls back to SliceBy8 when unsupported
+    uint32_t Folding(const uint32_t *ptr, uint32_t len);
+    bool FoldingSupported();
+
+    // name of the implementation Core() dispatches to
+    const char *Implementation();
+}
+
+#endif // CRC32_HPP
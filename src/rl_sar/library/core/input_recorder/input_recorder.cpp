@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "input_recorder.hpp"
+#include "logger.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+std::string InputRecorder::DefaultDirectory(const std::string &robot_path)
+{
+    const char *ros_home = getenv("ROS_HOME");
+    const char *home = getenv("HOME");
+    std::string base = ros_home && ros_home[0] ? ros_home : std::string(home ? home : "/tmp") + "/.ros";
+    return base + "/rl_sar/recordings/" + robot_path;
+}
+
+static bool MakeDirectories(const std::string &path)
+{
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1))
+    {
+        const std::string parent = path.substr(0, pos);
+        if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            return false;
+        }
+        if (pos == std::string::npos)
+        {
+            return true;
+        }
+    }
+}
+
+void InputRecorder::Toggle(const std::string &directory)
+{
+    if (!this->recording)
+    {
+        // drop whatever a tick pushed after the previous recording was stopped
+        std::vector<torch::Tensor> stale;
+        while (this->sample_queue.try_pop(stale)) {}
+        this->samples = 0;
+        this->directory = directory;
+        this->recording = true;
+        std::cout << std::endl << LOGGER::INFO << "Recording policy inputs, press again to stop" << std::endl;
+        return;
+    }
+    this->recording = false;
+    this->Write();
+}
+
+void InputRecorder::Record(const std::vector<torch::jit::IValue> &inputs)
+{
+    if (!this->recording.load(std::memory_order_relaxed) || this->samples.load(std::memory_order_relaxed) >= max_samples)
+    {
+        return;
+    }
+    // the live buffers are reused by the next tick, so the recording gets its own copy
+    std::vector<torch::Tensor> sample;
+    sample.reserve(inputs.size());
+    for (const auto &input : inputs)
+    {
+        if (!input.isTensor())
+        {
+            return;
+        }
+        sample.push_back(input.toTensor().clone());
+    }
+    this->samples++;
+    this->sample_queue.push(std::move(sample));
+}
+
+void InputRecorder::Write()
+{
+    std::vector<std::vector<torch::Tensor>> columns;
+    std::vector<torch::Tensor> sample;
+    while (this->sample_queue.try_pop(sample))
+    {
+        if (columns.empty())
+        {
+            columns.resize(sample.size());
+        }
+        if (sample.size() != columns.size())
+        {
+            continue; // the policy changed while recording, keep the first signature
+        }
+        for (size_t i = 0; i < sample.size(); ++i)
+        {
+            columns[i].push_back(sample[i]);
+        }
+    }
+    if (columns.empty())
+    {
+        std::cout << std::endl << LOGGER::WARNING << "Nothing recorded, no policy was running" << std::endl;
+        return;
+    }
+
+    std::vector<torch::jit::IValue> stacked;
+    for (const auto &column : columns)
+    {
+        stacked.push_back(torch::stack(column));
+    }
+    std::vector<char> data = torch::pickle_save(c10::ivalue::Tuple::create(std::move(stacked)));
+
+    if (!MakeDirectories(this->directory))
+    {
+        std::cout << std::endl << LOGGER::ERROR << "Cannot create " << this->directory << ": " << strerror(errno) << std::endl;
+        return;
+    }
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+    std::string path = this->directory + "/inputs_" + stamp + ".pt";
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.data(), data.size());
+    if (!file)
+    {
+        std::cout << std::endl << LOGGER::ERROR << "Cannot write " << path << std::endl;
+        return;
+    }
+    std::cout << std::endl << LOGGER::INFO << "Wrote " << columns[0].size() << " ticks of policy inputs to " << path << std::endl;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef INPUT_RECORDER_HPP
+#define INPUT_RECORDER_HPP
+
+#include <torch/script.h>
+#include <tbb/concurrent_queue.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Records the exact inputs fed to the live policy for offline replay.
+ *
+ * Toggle() starts a recording and, called again, writes it to <directory>/inputs_<time>.pt,
+ * by default DefaultDirectory() under ROS_HOME (~/.ros) rather than the package sources,
+ * as a tuple with one tensor per policy input, the ticks stacked along a new first dimension,
+ * so in Python inputs[k][i] is input k exactly as the policy saw it on tick i. scripts/quantize_policy.py
+ * replays these through the fp32 and int8 policies. Record() costs a relaxed load while not
+ * recording and a copy of the inputs while recording; a recording stops growing after
+ * max_samples ticks.
+ */
+class InputRecorder
+{
+public:
+    // $ROS_HOME/rl_sar/recordings/<robot>/<config>, scripts/quantize_policy.py reads the same
+    static std::string DefaultDirectory(const std::string &robot_path);
+    // keyboard thread
+    void Toggle(const std::string &directory);
+    // inference thread, with the inputs Forward() passed to the model
+    void Record(const std::vector<torch::jit::IValue> &inputs);
+
+private:
+    void Write();
+
+    static constexpr int max_samples = 15000; // 5 minutes at 50Hz
+    std::atomic<bool> recording{false};
+    std::atomic<int> samples{0};
+    tbb::concurrent_queue<std::vector<torch::Tensor>> sample_queue;
+    std::string directory; // keyboard thread only
+};
+
+#endif // INPUT_RECORDER_HPP
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "triple_buffer.hpp"
+
+struct LatencyStats
+{
+    double window = 0.0; // seconds covered by this report
+    uint64_t count = 0;
+    double mean = 0.0;   // ms
+    double p50 = 0.0;    // ms, upper edge of the bin holding the percentile, at most max
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;    // ms, exact
+    uint64_t overflow = 0; // samples beyond the histogram range
+};
+
+/**
+ * @brief Fixed-bin latency histogram for one measurement point.
+ *
+ * Record() belongs to a single thread and does not allocate: samples land in bins of
+ * bin_width milliseconds up to range, anything larger in an overflow bin. Every
+ * report_period the window is closed, published for Read() and optionally printed with
+ * the percentiles and a coarse distribution. The same samples also accumulate into
+ * lifetime bins that any thread can summarize with Total() or Print().
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram(const std::string &name, double bin_width = 0.01, double range = 20.0, double report_period = 5.0, bool verbose = true)
+        : name(name), bin_width(bin_width), report_period(report_period), verbose(verbose),
+          bins(static_cast<size_t>(range / bin_width) + 1, 0), total_bins(bins.size())
+    {
+        for (std::atomic<uint64_t> &bin : this->total_bins)
+        {
+            bin.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Record(std::chrono::steady_clock::duration latency, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now())
+    {
+        double ms = std::max(std::chrono::duration<double, std::milli>(latency).count(), 0.0);
+        if (this->window_start == std::chrono::steady_clock::time_point())
+        {
+            this->window_start = now;
+            if (this->total_count.load(std::memory_order_relaxed) == 0)
+            {
+                // published by the release store of total_count below
+                this->first_sample.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+            }
+        }
+        size_t bin = std::min(static_cast<size_t>(ms / this->bin_width), this->bins.size() - 1);
+        this->bins[bin]++;
+        this->count++;
+        this->sum += ms;
+        this->max = std::max(this->max, ms);
+
+        // single writer, plain load and store keep the record path free of locked instructions
+        this->total_bins[bin].store(this->total_bins[bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        this->total_sum.store(this->total_sum.load(std::memory_order_relaxed) + ms, std::memory_order_relaxed);
+        if (ms > this->total_max.load(std::memory_order_relaxed))
+        {
+            this->total_max.store(ms, std::memory_order_relaxed);
+        }
+        this->total_count.store(this->total_count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+        if (std::chrono::duration<double>(now - this->window_start).count() >= this->report_period)
+        {
+            this->CloseWindow(now);
+        }
+    }
+
+    // single consumer, returns true if a newer report is available
+    bool Read(LatencyStats &stats)
+    {
+        if (!this->reports.Update())
+        {
+            return false;
+        }
+        stats = this->reports.Front();
+        return true;
+    }
+
+    // any thread, all samples since construction; window is the time since the first one
+    LatencyStats Total() const
+    {
+        LatencyStats stats;
+        stats.count = this->total_count.load(std::memory_order_acquire);
+        if (stats.count == 0)
+        {
+            return stats;
+        }
+        const std::chrono::steady_clock::time_point first(std::chrono::steady_clock::duration(this->first_sample.load(std::memory_order_relaxed)));
+        stats.window = std::chrono::duration<double>(std::chrono::steady_clock::now() - first).count();
+        stats.mean = this->total_sum.load(std::memory_order_relaxed) / stats.count;
+        stats.max = this->total_max.load(std::memory_order_relaxed);
+        stats.p50 = this->Percentile(this->total_bins, stats.count, stats.max, 0.5);
+        stats.p90 = this->Percentile(this->total_bins, stats.count, stats.max, 0.9);
+        stats.p99 = this->Percentile(this->total_bins, stats.count, stats.max, 0.99);
+        stats.overflow = this->total_bins.back().load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void Print() const
+    {
+        LatencyStats stats = this->Total();
+        if (stats.count == 0)
+        {
+            std::cout << "[LatencyHistogram] " << this->name << " no samples" << std::endl;
+            return;
+        }
+        this->Print(stats, this->total_bins, " total");
+    }
+
+    const std::string &Name() const { return this->name; }
+
+private:
+    template <typename Bins>
+    double Percentile(const Bins &bins, uint64_t count, double max, double fraction) const
+    {
+        uint64_t target = static_cast<uint64_t>(fraction * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bins.size(); ++i)
+        {
+            seen += bins[i];
+            if (seen >= target)
+            {
+                return i + 1 < bins.size() ? std::min((i + 1) * this->bin_width, max) : max;
+            }
+        }
+        return max;
+    }
+
+    template <typename Bins>
+    uint64_t CountBelow(const Bins &bins, double ms) const
+    {
+        size_t end = std::min(static_cast<size_t>(ms / this->bin_width + 0.5), bins.size() - 1);
+        uint64_t below = 0;
+        for (size_t i = 0; i < end; ++i)
+        {
+            below += bins[i];
+        }
+        return below;
+    }
+
+    template <typename Bins>
+    void Print(const LatencyStats &stats, const Bins &bins, const char *label) const
+    {
+        std::cout << std::endl << "[LatencyHistogram] " << this->name << label << std::fixed << std::setprecision(3)
+                  << " n: " << stats.count
+                  << ", mean: " << stats.mean << "ms"
+                  << ", p50: " << stats.p50 << "ms"
+                  << ", p90: " << stats.p90 << "ms"
+                  << ", p99: " << stats.p99 << "ms"
+                  << ", max: " << stats.max << "ms" << std::endl
+                  << "[LatencyHistogram] " << this->name << label << std::setprecision(1);
+        const double edges[] = {0.1, 0.5, 1.0, 2.0, 5.0, 10.0};
+        uint64_t previous = 0;
+        for (double edge : edges)
+        {
+            uint64_t below = std::max(this->CountBelow(bins, edge), previous);
+            std::cout << " <" << edge << "ms: " << 100.0 * (below - previous) / stats.count << "%";
+            previous = below;
+        }
+        std::cout << " rest: " << 100.0 * (stats.count - std::min(previous, stats.count)) / stats.count << "%" << std::defaultfloat << std::endl;
+    }
+
+    void CloseWindow(std::chrono::steady_clock::time_point now)
+    {
+        LatencyStats &stats = this->reports.Back();
+        stats.window = std::chrono::duration<double>(now - this->window_start).count();
+        stats.count = this->count;
+        stats.mean = this->sum / this->count;
+        stats.p50 = this->Percentile(this->bins, this->count, this->max, 0.5);
+        stats.p90 = this->Percentile(this->bins, this->count, this->max, 0.9);
+        stats.p99 = this->Percentile(this->bins, this->count, this->max, 0.99);
+        stats.max = this->max;
+        stats.overflow = this->bins.back();
+
+        if (this->verbose)
+        {
+            this->Print(stats, this->bins, "");
+        }
+        this->reports.Publish();
+
+        this->window_start = now;
+        std::fill(this->bins.begin(), this->bins.end(), 0);
+        this->count = 0;
+        this->sum = 0.0;
+        this->max = 0.0;
+    }
+
+    std::string name;
+    double bin_width; // ms
+    double report_period;
+    bool verbose;
+    TripleBuffer<LatencyStats> reports;
+
+    // recording thread only
+    std::vector<uint64_t> bins; // the last one collects everything beyond the range
+    std::chrono::steady_clock::time_point window_start;
+    uint64_t count = 0;
+    double sum = 0.0;
+    double max = 0.0;
+
+    // lifetime, written by the recording thread only
+    std::vector<std::atomic<uint64_t>> total_bins;
+    std::atomic<int64_t> first_sample{0}; // steady_clock ticks
+    std::atomic<uint64_t> total_count{0};
+    std::atomic<double> total_sum{0.0};
+    std::atomic<double> total_max{0.0};
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PIPELINE_LATENCY_HPP
+#define PIPELINE_LATENCY_HPP
+
+#include <chrono>
+#include <string>
+#include "latency_histogram.hpp"
+
+// Where a command's action came from, carried from RunModel() to SetCommand()
+struct ActionStamp
+{
+    std::chrono::steady_clock::time_point observation; // transport receive time of the state the policy saw
+    std::chrono::steady_clock::time_point action;      // when the policy produced the action
+};
+
+/**
+ * @brief Observation and action age accounting for one robot pipeline.
+ *
+ * observation_age is recorded by the inference thread and is how old the newest received
+ * state is when the policy runs. sensor_to_actuation and action_age are recorded by the
+ * control thread each time a command reaches the transport: the first is measured from
+ * the receive time of the state the applied action was computed from, the second from the
+ * moment that action was produced, so it grows while the control loop keeps reapplying it.
+ * The histograms only report on request, Print() or LatencyHistogram::Read().
+ */
+class PipelineLatency
+{
+public:
+    explicit PipelineLatency(const std::string &name)
+        : observation_age(name + " observation age", 0.05, 100.0, 5.0, false),
+          sensor_to_actuation(name + " sensor->actuation", 0.05, 100.0, 5.0, false),
+          action_age(name + " action age", 0.05, 100.0, 5.0, false) {}
+
+    // inference thread, before the observation is built
+    void OnInference(std::chrono::steady_clock::time_point observation_stamp, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now())
+    {
+        if (observation_stamp != std::chrono::steady_clock::time_point())
+        {
+            this->observation_age.Record(now - observation_stamp, now);
+        }
+    }
+
+    // control thread, after the command was handed to the transport
+    void OnActuation(const ActionStamp &stamp, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now())
+    {
+        if (stamp.action == std::chrono::steady_clock::time_point())
+        {
+            return; // scripted states, no policy output involved
+        }
+        if (stamp.observation != std::chrono::steady_clock::time_point())
+        {
+            this->sensor_to_actuation.Record(now - stamp.observation, now);
+        }
+        this->action_age.Record(now - stamp.action, now);
+    }
+
+    void Print() const
+    {
+        this->observation_age.Print();
+        this->sensor_to_actuation.Print();
+        this->action_age.Print();
+    }
+
+    LatencyHistogram observation_age;
+    LatencyHistogram sensor_to_actuation;
+    LatencyHistogram action_age;
+};
+
+#endif // PIPELINE_LATENCY_HPP
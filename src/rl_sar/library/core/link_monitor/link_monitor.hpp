@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LINK_MONITOR_HPP
+#define LINK_MONITOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "triple_buffer.hpp"
+
+struct LinkStats
+{
+    double window = 0.0;          // seconds covered by this report
+    double rate = 0.0;            // received packets per second
+    double interval_mean = 0.0;   // ms between arrivals
+    double interval_jitter = 0.0; // ms, standard deviation of the arrival interval
+    double interval_max = 0.0;    // ms
+    double response_mean = 0.0;   // ms from the latest request to the packet answering it
+    double response_jitter = 0.0; // ms
+    double response_max = 0.0;    // ms
+    double age_mean = 0.0;        // ms between arrival and use by the consumer
+    double age_max = 0.0;         // ms
+    uint64_t received = 0;
+    uint64_t lost = 0;
+    uint64_t malformed = 0;
+    uint64_t reordered = 0;
+    uint64_t total_received = 0;
+    uint64_t total_lost = 0;
+    uint64_t total_malformed = 0;
+};
+
+/**
+ * @brief Packet rate, loss and inter-arrival jitter of one receive path.
+ *
+ * OnPacket/OnSequence/OnLost/OnMalformed belong to the receive thread. Loss is either
+ * counted from sequence gaps or derived from OnRequest, which any thread may call, for
+ * request/response links where every request should be answered; the time from a
+ * request to the first packet after it is reported as response latency. OnConsume is for
+ * the single thread that uses the data and records how old it was. Every report_period
+ * the window is closed, published for Read() and optionally printed.
+ */
+class LinkMonitor
+{
+public:
+    LinkMonitor(const std::string &name, double report_period = 5.0, bool verbose = true)
+        : name(name), report_period(report_period), verbose(verbose) {}
+
+    void OnRequest()
+    {
+        this->last_request.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        this->requests.fetch_add(1, std::memory_order_release);
+    }
+
+    void OnLost(uint64_t count = 1) { this->window_lost += count; }
+
+    void OnMalformed() { this->window_malformed++; }
+
+    // Sequence number or tick of each message. The smallest positive step seen so far is the
+    // nominal one, larger steps count as lost messages and repeated or older ones as reordered.
+    void OnSequence(uint32_t sequence)
+    {
+        if (this->has_sequence)
+        {
+            uint32_t step = sequence - this->last_sequence;
+            if (step == 0 || step > 0x80000000u)
+            {
+                this->window_reordered++;
+                return;
+            }
+            if (this->sequence_step == 0 || step < this->sequence_step)
+            {
+                this->sequence_step = step;
+            }
+            uint32_t missed = step / this->sequence_step - 1;
+            if (missed < max_sequence_gap) // larger jumps are a restarted sender, not loss
+            {
+                this->window_lost += missed;
+            }
+        }
+        this->has_sequence = true;
+        this->last_sequence = sequence;
+    }
+
+    void OnConsume(std::chrono::steady_clock::time_point arrival)
+    {
+        int64_t age = std::max<int64_t>((std::chrono::steady_clock::now() - arrival).count(), 0);
+        this->age_count.fetch_add(1, std::memory_order_relaxed);
+        this->age_sum.fetch_add(age, std::memory_order_relaxed);
+        int64_t max = this->age_max.load(std::memory_order_relaxed);
+        while (age > max && !this->age_max.compare_exchange_weak(max, age, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void OnPacket(std::chrono::steady_clock::time_point arrival)
+    {
+        if (this->window_received == 0 && this->window_start == std::chrono::steady_clock::time_point())
+        {
+            this->window_start = arrival;
+            this->window_requests_start = this->requests.load(std::memory_order_relaxed);
+        }
+        if (this->last_arrival != std::chrono::steady_clock::time_point())
+        {
+            double interval = std::chrono::duration<double, std::milli>(arrival - this->last_arrival).count();
+            this->interval_count++;
+            this->interval_sum += interval;
+            this->interval_sq_sum += interval * interval;
+            this->interval_max = std::max(this->interval_max, interval);
+        }
+        this->last_arrival = arrival;
+        this->window_received++;
+
+        int64_t request = this->last_request.load(std::memory_order_acquire);
+        if (request != 0 && request != this->answered_request)
+        {
+            this->answered_request = request;
+            double response = std::chrono::duration<double, std::milli>(
+                arrival.time_since_epoch() - std::chrono::steady_clock::duration(request)).count();
+            if (response >= 0.0)
+            {
+                this->response_count++;
+                this->response_sum += response;
+                this->response_sq_sum += response * response;
+                this->response_max = std::max(this->response_max, response);
+            }
+        }
+
+        if (std::chrono::duration<double>(arrival - this->window_start).count() >= this->report_period)
+        {
+            this->CloseWindow(arrival);
+        }
+    }
+
+    // single consumer, returns true if a newer report is available
+    bool Read(LinkStats &stats)
+    {
+        if (!this->reports.Update())
+        {
+            return false;
+        }
+        stats = this->reports.Front();
+        return true;
+    }
+
+private:
+    static constexpr uint32_t max_sequence_gap = 1000;
+
+    static double ToMilliseconds(int64_t ticks)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::duration(ticks)).count();
+    }
+
+    void CloseWindow(std::chrono::steady_clock::time_point now)
+    {
+        LinkStats &stats = this->reports.Back();
+        stats.window = std::chrono::duration<double>(now - this->window_start).count();
+        stats.received = this->window_received;
+        stats.malformed = this->window_malformed;
+        stats.lost = this->window_lost;
+        uint64_t requests_now = this->requests.load(std::memory_order_relaxed);
+        uint64_t window_requests = requests_now - this->window_requests_start;
+        if (window_requests > this->window_received)
+        {
+            stats.lost += window_requests - this->window_received;
+        }
+        stats.rate = stats.window > 0.0 ? stats.received / stats.window : 0.0;
+        if (this->interval_count > 0)
+        {
+            stats.interval_mean = this->interval_sum / this->interval_count;
+            double variance = this->interval_sq_sum / this->interval_count - stats.interval_mean * stats.interval_mean;
+            stats.interval_jitter = std::sqrt(std::max(variance, 0.0));
+        }
+        else
+        {
+            stats.interval_mean = stats.interval_jitter = 0.0;
+        }
+        stats.interval_max = this->interval_max;
+        if (this->response_count > 0)
+        {
+            stats.response_mean = this->response_sum / this->response_count;
+            double variance = this->response_sq_sum / this->response_count - stats.response_mean * stats.response_mean;
+            stats.response_jitter = std::sqrt(std::max(variance, 0.0));
+        }
+        else
+        {
+            stats.response_mean = stats.response_jitter = 0.0;
+        }
+        stats.response_max = this->response_max;
+        // the three counters are reset one by one, a sample landing in between only shifts the mean slightly
+        uint64_t age_count = this->age_count.exchange(0, std::memory_order_relaxed);
+        int64_t age_sum = this->age_sum.exchange(0, std::memory_order_relaxed);
+        int64_t age_max = this->age_max.exchange(0, std::memory_order_relaxed);
+        stats.age_mean = age_count > 0 ? ToMilliseconds(age_sum) / age_count : 0.0;
+        stats.age_max = ToMilliseconds(age_max);
+        stats.reordered = this->window_reordered;
+        this->total_received += stats.received;
+        this->total_lost += stats.lost;
+        this->total_malformed += stats.malformed;
+        stats.total_received = this->total_received;
+        stats.total_lost = this->total_lost;
+        stats.total_malformed = this->total_malformed;
+
+        if (this->verbose)
+        {
+            std::cout << std::endl << "[LinkMonitor] " << this->name << std::fixed << std::setprecision(2)
+                      << " rate: " << stats.rate << "Hz"
+                      << ", lost: " << stats.lost << "/" << (stats.received + stats.lost)
+                      << ", malformed: " << stats.malformed
+                      << ", interval mean: " << stats.interval_mean << "ms"
+                      << " jitter: " << stats.interval_jitter << "ms"
+                      << " max: " << stats.interval_max << "ms";
+            if (this->response_count > 0)
+            {
+                std::cout << ", response mean: " << stats.response_mean << "ms"
+                          << " jitter: " << stats.response_jitter << "ms"
+                          << " max: " << stats.response_max << "ms";
+            }
+            if (age_count > 0)
+            {
+                std::cout << ", age mean: " << stats.age_mean << "ms max: " << stats.age_max << "ms";
+            }
+            if (stats.reordered > 0)
+            {
+                std::cout << ", reordered: " << stats.reordered;
+            }
+            std::cout << std::defaultfloat << std::endl;
+        }
+        this->reports.Publish();
+
+        this->window_start = now;
+        this->window_requests_start = requests_now;
+        this->window_received = 0;
+        this->window_lost = 0;
+        this->window_malformed = 0;
+        this->window_reordered = 0;
+        this->interval_count = 0;
+        this->interval_sum = 0.0;
+        this->interval_sq_sum = 0.0;
+        this->interval_max = 0.0;
+        this->response_count = 0;
+        this->response_sum = 0.0;
+        this->response_sq_sum = 0.0;
+        this->response_max = 0.0;
+    }
+
+    std::string name;
+    double report_period;
+    bool verbose;
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<int64_t> last_request{0}; // steady_clock ticks of the latest request
+    std::atomic<uint64_t> age_count{0};
+    std::atomic<int64_t> age_sum{0};
+    std::atomic<int64_t> age_max{0};
+    TripleBuffer<LinkStats> reports;
+
+    // receive thread only
+    std::chrono::steady_clock::time_point window_start;
+    std::chrono::steady_clock::time_point last_arrival;
+    uint64_t window_requests_start = 0;
+    uint64_t window_received = 0;
+    uint64_t window_lost = 0;
+    uint64_t window_malformed = 0;
+    uint64_t window_reordered = 0;
+    bool has_sequence = false;
+    uint32_t last_sequence = 0;
+    uint32_t sequence_step = 0;
+    uint64_t interval_count = 0;
+    double interval_sum = 0.0;
+    double interval_sq_sum = 0.0;
+    double interval_max = 0.0;
+    int64_t answered_request = 0;
+    uint64_t response_count = 0;
+    double response_sum = 0.0;
+    double response_sq_sum = 0.0;
+    double response_max = 0.0;
+    uint64_t total_received = 0;
+    uint64_t total_lost = 0;
+    uint64_t total_malformed = 0;
+};
+
+#endif // LINK_MONITOR_HPP
@@ -65,6 +65,8 @@ private:
 
     void loop()
     {
+        // thread names show up in top -H, gdb and the tracer's timeline
+        pthread_setname_np(pthread_self(), _name.substr(0, 15).c_str());
         while (_running)
         {
             auto start = std::chrono::steady_clock::now();
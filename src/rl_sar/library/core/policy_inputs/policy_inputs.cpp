@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "policy_inputs.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+void PolicyInputs::Bind(const std::vector<PolicyInputConfig> &inputs, int num_observations, const std::vector<int> &observations_history,
+                        const std::vector<torch::Tensor> &hidden_states, const torch::Tensor &commands_scale)
+{
+    this->names.clear();
+    this->values.clear();
+    this->num_observations = num_observations;
+    this->observation = torch::zeros({1, this->num_observations});
+    this->commands = torch::zeros({1, CONFIG_COMMANDS});
+    this->commands_scale = commands_scale;
+
+    // observations_history counts back from the newest observation, 0 is this tick
+    this->has_history = !observations_history.empty();
+    this->history_ids = torch::Tensor();
+    const int64_t history_length = observations_history.size();
+    if (this->has_history)
+    {
+        this->window_length = *std::max_element(observations_history.begin(), observations_history.end()) + 1;
+        this->window = torch::zeros({1, this->window_length * this->num_observations});
+        bool ascending = true;
+        bool descending = history_length == this->window_length;
+        for (int64_t i = 0; i < history_length; ++i)
+        {
+            ascending = ascending && observations_history[i] == i;
+            descending = descending && observations_history[i] == this->window_length - 1 - i;
+        }
+        this->newest_first = ascending || !descending;
+        if (ascending || descending)
+        {
+            this->history = this->window;
+        }
+        else
+        {
+            // the window keeps the newest observation first, so an id is its row
+            this->history = torch::zeros({1, history_length * this->num_observations});
+            this->history_rows = this->history.view({history_length, this->num_observations});
+            this->history_ids = torch::tensor(std::vector<int64_t>(observations_history.begin(), observations_history.end()), torch::kLong);
+        }
+    }
+
+    for (const PolicyInputConfig &input : inputs)
+    {
+        switch (input.source)
+        {
+        case POLICY_INPUT_HISTORY:
+            if (!this->has_history)
+            {
+                throw std::runtime_error(std::string("policy input ") + input.name + " reads the history, but observations_history is empty");
+            }
+            this->values.push_back(input.layout == POLICY_INPUT_STACKED ? this->history.view({1, history_length, this->num_observations}) : this->history);
+            break;
+        case POLICY_INPUT_COMMANDS:
+            this->values.push_back(this->commands);
+            break;
+        case POLICY_INPUT_HIDDEN_STATE:
+            if (input.index < 0 || input.index >= static_cast<int>(hidden_states.size()))
+            {
+                throw std::runtime_error(std::string("policy input ") + input.name + " reads hidden state " + std::to_string(input.index) + ", which is not declared");
+            }
+            this->values.push_back(hidden_states[input.index]);
+            break;
+        default:
+            this->values.push_back(this->observation);
+            break;
+        }
+        this->names.push_back(input.name);
+    }
+}
+
+void PolicyInputs::Update(const torch::Tensor &obs, const torch::Tensor &commands)
+{
+    this->observation.copy_(obs);
+    torch::mul_out(this->commands, commands, this->commands_scale);
+    if (!this->has_history)
+    {
+        return;
+    }
+
+    // shift the window by one observation and put this tick's at the newest end
+    float *data = this->window.data_ptr<float>();
+    const int64_t row = this->num_observations;
+    const size_t shifted = (this->window_length - 1) * row * sizeof(float);
+    if (this->newest_first)
+    {
+        memmove(data + row, data, shifted);
+        memcpy(data, this->observation.data_ptr<float>(), row * sizeof(float));
+    }
+    else
+    {
+        memmove(data, data + row, shifted);
+        memcpy(data + (this->window_length - 1) * row, this->observation.data_ptr<float>(), row * sizeof(float));
+    }
+    if (this->history_ids.defined())
+    {
+        torch::index_select_out(this->history_rows, this->window.view({this->window_length, row}), 0, this->history_ids);
+    }
+}
+
+std::string PolicyInputs::Signature() const
+{
+    std::ostringstream signature;
+    for (size_t i = 0; i < this->values.size(); ++i)
+    {
+        signature << (i ? ", " : "") << this->names[i] << " " << this->values[i].toTensor().sizes();
+    }
+    return signature.str();
+}
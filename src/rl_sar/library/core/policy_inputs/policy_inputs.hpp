@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef POLICY_INPUTS_HPP
+#define POLICY_INPUTS_HPP
+
+#include <torch/script.h>
+#include <string>
+#include <vector>
+#include "config_bundle.hpp"
+
+/**
+ * @brief The arguments of the policy's forward(), bound once from the config's policy_inputs.
+ *
+ * Bind() allocates one persistent buffer per source and hands out views of them, so Values()
+ * returns the same tensors every tick and Update() only refills their memory: the observation is
+ * copied in, the history window shifts by one observation and the scaled commands are written in
+ * place. When observations_history lists consecutive ticks, newest or oldest first, the window is
+ * itself the flat input and a view of it the stacked one; any other selection is gathered into a
+ * buffer of its own. Hidden states are bound as the caller's tensors, which it updates in place.
+ */
+class PolicyInputs
+{
+public:
+    void Bind(const std::vector<PolicyInputConfig> &inputs, int num_observations, const std::vector<int> &observations_history,
+              const std::vector<torch::Tensor> &hidden_states, const torch::Tensor &commands_scale);
+    // obs is this tick's clamped observation, commands the unscaled x, y and yaw command
+    void Update(const torch::Tensor &obs, const torch::Tensor &commands);
+    std::vector<torch::jit::IValue> &Values() { return this->values; }
+    // e.g. "obs [1, 57], obs_history [1, 10, 57]"
+    std::string Signature() const;
+
+private:
+    std::vector<std::string> names;
+    std::vector<torch::jit::IValue> values;
+
+    torch::Tensor observation;
+    torch::Tensor commands;
+    torch::Tensor commands_scale;
+
+    bool has_history = false;
+    int64_t num_observations = 0;
+    int64_t window_length = 0;
+    bool newest_first = true;
+    torch::Tensor window;       // the last window_length observations, contiguous
+    torch::Tensor history;      // observations_history in order, the window itself or gathered from it
+    torch::Tensor history_rows; // history viewed as one row per observation, the gather target
+    torch::Tensor history_ids;  // rows of the window to gather, undefined when history is the window
+};
+
+#endif // POLICY_INPUTS_HPP
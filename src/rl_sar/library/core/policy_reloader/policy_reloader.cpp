@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "policy_reloader.hpp"
+#include "logger.hpp"
+#include <dirent.h>
+#include <sys/stat.h>
+
+static bool EndsWith(const std::string &str, const std::string &suffix)
+{
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::time_t FileMTime(const std::string &path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+        return 0;
+    }
+    return st.st_mtime;
+}
+
+PolicyReloader::~PolicyReloader()
+{
+    this->Shutdown();
+}
+
+void PolicyReloader::Start(int shadow_cpu)
+{
+    if (this->running)
+    {
+        return;
+    }
+    if (shadow_cpu < 0)
+    {
+        // keep the shadow policy away from the cores the control loops usually land on
+        shadow_cpu = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    }
+    this->running = true;
+    this->loop_watch = std::make_shared<LoopFunc>("loop_policy_watch", 1.0, std::bind(&PolicyReloader::WatchDirectory, this));
+    this->loop_shadow = std::make_shared<LoopFunc>("loop_policy_shadow", 0.001, std::bind(&PolicyReloader::EvaluateShadow, this), shadow_cpu);
+    this->loop_watch->start();
+    this->loop_shadow->start();
+}
+
+void PolicyReloader::Shutdown()
+{
+    if (!this->running)
+    {
+        return;
+    }
+    this->running = false;
+    this->loop_watch->shutdown();
+    this->loop_shadow->shutdown();
+}
+
+void PolicyReloader::Watch(const std::string &model_dir, const std::string &live_model_path)
+{
+    auto target = std::make_shared<WatchTarget>();
+    target->model_dir = model_dir;
+    target->live_model_path = live_model_path;
+    target->live_mtime = FileMTime(live_model_path);
+    std::atomic_store(&this->watch_target, std::shared_ptr<const WatchTarget>(target));
+
+    // a candidate from another robot/config must never be promoted
+    std::shared_ptr<Candidate> pending = std::atomic_load(&this->candidate);
+    if (pending && pending->path.compare(0, model_dir.size(), model_dir) != 0)
+    {
+        std::atomic_store(&this->candidate, std::shared_ptr<Candidate>());
+    }
+}
+
+std::string PolicyReloader::PromotedModelPath(const std::string &model_dir) const
+{
+    std::shared_ptr<const WatchTarget> last = std::atomic_load(&this->promoted);
+    if (last && last->model_dir == model_dir)
+    {
+        return last->live_model_path;
+    }
+    return "";
+}
+
+void PolicyReloader::Submit(const std::vector<torch::jit::IValue> &inputs, const torch::Tensor &actions)
+{
+    if (!this->running || !std::atomic_load(&this->candidate))
+    {
+        return;
+    }
+    if (this->pending_samples.load() >= max_pending_samples)
+    {
+        return;
+    }
+
+    // the live buffers are reused by the next tick, so the shadow gets its own copy
+    Sample sample;
+    sample.inputs.reserve(inputs.size());
+    for (const auto &input : inputs)
+    {
+        sample.inputs.push_back(input.isTensor() ? torch::jit::IValue(input.toTensor().clone()) : input);
+    }
+    sample.actions = actions.clone();
+    this->pending_samples++;
+    this->sample_queue.push(std::move(sample));
+}
+
+bool PolicyReloader::TryPromote(torch::jit::script::Module &model)
+{
+    if (!this->promote_requested.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    this->promote_requested = false;
+
+    std::shared_ptr<Candidate> next = std::atomic_exchange(&this->candidate, std::shared_ptr<Candidate>());
+    if (!next)
+    {
+        std::cout << std::endl << LOGGER::WARNING << "Policy reloader: no candidate policy to promote" << std::endl;
+        return false;
+    }
+
+    model = next->module;
+
+    std::shared_ptr<const WatchTarget> target = std::atomic_load(&this->watch_target);
+    auto live = std::make_shared<WatchTarget>();
+    live->model_dir = target ? target->model_dir : "";
+    live->live_model_path = next->path;
+    live->live_mtime = next->mtime;
+    std::atomic_store(&this->watch_target, std::shared_ptr<const WatchTarget>(live));
+    std::atomic_store(&this->promoted, std::shared_ptr<const WatchTarget>(live));
+
+    std::cout << std::endl << LOGGER::INFO << "Policy reloader: promoted " << next->path << std::endl;
+    return true;
+}
+
+void PolicyReloader::WatchDirectory()
+{
+    std::shared_ptr<const WatchTarget> target = std::atomic_load(&this->watch_target);
+    if (!target)
+    {
+        return;
+    }
+
+    DIR *dir = opendir(target->model_dir.c_str());
+    if (!dir)
+    {
+        return;
+    }
+    std::string newest_path;
+    std::time_t newest_mtime = target->live_mtime;
+    while (struct dirent *entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (!EndsWith(name, ".pt"))
+        {
+            continue;
+        }
+        std::string path = target->model_dir + "/" + name;
+        std::time_t mtime = FileMTime(path);
+        if (path != target->live_model_path && mtime > newest_mtime)
+        {
+            newest_path = path;
+            newest_mtime = mtime;
+        }
+    }
+    closedir(dir);
+
+    if (newest_path.empty())
+    {
+        return;
+    }
+    // skip files that may still be being written
+    if (std::time(nullptr) - newest_mtime < 1)
+    {
+        return;
+    }
+    std::shared_ptr<Candidate> pending = std::atomic_load(&this->candidate);
+    if (pending && pending->path == newest_path && pending->mtime == newest_mtime)
+    {
+        return;
+    }
+    if (newest_path == this->failed_path && newest_mtime == this->failed_mtime)
+    {
+        return;
+    }
+
+    auto next = std::make_shared<Candidate>();
+    try
+    {
+        next->module = torch::jit::load(newest_path);
+        next->module.eval();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << std::endl << LOGGER::WARNING << "Policy reloader: failed to load " << newest_path << ": " << e.what() << std::endl;
+        this->failed_path = newest_path;
+        this->failed_mtime = newest_mtime;
+        return;
+    }
+    next->path = newest_path;
+    next->mtime = newest_mtime;
+    std::atomic_store(&this->candidate, next);
+    std::cout << std::endl << LOGGER::INFO << "Policy reloader: loaded candidate " << newest_path << ", running in shadow" << std::endl;
+}
+
+void PolicyReloader::EvaluateShadow()
+{
+    torch::autograd::GradMode::set_enabled(false);
+
+    Sample sample;
+    while (this->sample_queue.try_pop(sample))
+    {
+        this->pending_samples--;
+
+        std::shared_ptr<Candidate> current = std::atomic_load(&this->candidate);
+        if (!current)
+        {
+            this->shadow_candidate.reset();
+            continue;
+        }
+        if (current != this->shadow_candidate)
+        {
+            this->shadow_candidate = current;
+            this->shadow_count = 0;
+            this->shadow_diff_sum = 0.0;
+            this->shadow_diff_max = 0.0;
+            this->shadow_latency_sum = 0.0;
+            this->shadow_latency_max = 0.0;
+            try
+            {
+                for (int i = 0; i < warmup_iterations; ++i)
+                {
+                    current->module.forward(sample.inputs);
+                }
+            }
+            catch (const std::exception &e)
+            {
+                std::cout << std::endl << LOGGER::WARNING << "Policy reloader: candidate " << current->path << " rejected: " << e.what() << std::endl;
+                std::atomic_compare_exchange_strong(&this->candidate, &current, std::shared_ptr<Candidate>());
+                this->shadow_candidate.reset();
+                continue;
+            }
+        }
+
+        torch::Tensor actions;
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            torch::jit::IValue output = current->module.forward(sample.inputs);
+            // recurrent policies return (actions, hidden states...)
+            actions = output.isTuple() ? output.toTuple()->elements()[0].toTensor() : output.toTensor();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << std::endl << LOGGER::WARNING << "Policy reloader: candidate " << current->path << " rejected: " << e.what() << std::endl;
+            std::atomic_compare_exchange_strong(&this->candidate, &current, std::shared_ptr<Candidate>());
+            this->shadow_candidate.reset();
+            continue;
+        }
+        double latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (actions.sizes() != sample.actions.sizes())
+        {
+            std::cout << std::endl << LOGGER::WARNING << "Policy reloader: candidate " << current->path << " rejected: action shape " << actions.sizes() << " does not match live policy " << sample.actions.sizes() << std::endl;
+            std::atomic_compare_exchange_strong(&this->candidate, &current, std::shared_ptr<Candidate>());
+            this->shadow_candidate.reset();
+            continue;
+        }
+
+        torch::Tensor diff = (actions - sample.actions).abs();
+        this->shadow_count++;
+        this->shadow_diff_sum += diff.mean().item<double>();
+        this->shadow_diff_max = std::max(this->shadow_diff_max, diff.max().item<double>());
+        this->shadow_latency_sum += latency_ms;
+        this->shadow_latency_max = std::max(this->shadow_latency_max, latency_ms);
+
+        if (this->shadow_count % report_interval == 0)
+        {
+            this->ReportShadow(*current);
+        }
+    }
+}
+
+void PolicyReloader::ReportShadow(const Candidate &candidate)
+{
+    std::cout << std::endl << LOGGER::INFO << "Policy reloader: shadow " << candidate.path
+              << " samples: " << this->shadow_count
+              << ", action diff mean: " << this->shadow_diff_sum / this->shadow_count
+              << " max: " << this->shadow_diff_max
+              << ", latency mean: " << this->shadow_latency_sum / this->shadow_count << "ms"
+              << " max: " << this->shadow_latency_max << "ms" << std::endl;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef POLICY_RELOADER_HPP
+#define POLICY_RELOADER_HPP
+
+#include <torch/script.h>
+#include <tbb/concurrent_queue.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+#include "loop.hpp"
+
+/**
+ * @brief Watches a model directory for a newer policy, loads it off the control
+ *        threads and evaluates it in shadow against the live policy.
+ *
+ * The candidate only replaces the live model when the operator requests it and
+ * TryPromote() is called at the start of a policy tick. Submit() and TryPromote()
+ * never lock, so loop_rl and loop_control are not blocked by loading or shadow
+ * inference.
+ */
+class PolicyReloader
+{
+public:
+    PolicyReloader() {}
+    ~PolicyReloader();
+
+    void Start(int shadow_cpu = -1);
+    void Shutdown();
+    bool IsRunning() const { return running; }
+
+    // called from InitRL() whenever a model is loaded
+    void Watch(const std::string &model_dir, const std::string &live_model_path);
+    // path of the last promoted model, empty if nothing was promoted
+    std::string PromotedModelPath(const std::string &model_dir) const;
+
+    // called from Forward() with the exact inputs fed to the live policy
+    void Submit(const std::vector<torch::jit::IValue> &inputs, const torch::Tensor &actions);
+
+    // operator command (keyboard/joystick), applied by the next TryPromote()
+    void RequestPromote() { promote_requested = true; }
+    bool TryPromote(torch::jit::script::Module &model);
+
+private:
+    struct WatchTarget
+    {
+        std::string model_dir;
+        std::string live_model_path;
+        std::time_t live_mtime = 0;
+    };
+
+    struct Candidate
+    {
+        torch::jit::script::Module module;
+        std::string path;
+        std::time_t mtime = 0;
+    };
+
+    struct Sample
+    {
+        std::vector<torch::jit::IValue> inputs;
+        torch::Tensor actions;
+    };
+
+    void WatchDirectory();
+    void EvaluateShadow();
+    void ReportShadow(const Candidate &candidate);
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> promote_requested{false};
+    std::shared_ptr<const WatchTarget> watch_target;
+    std::shared_ptr<Candidate> candidate;
+    std::shared_ptr<const WatchTarget> promoted;
+
+    // shadow samples, bounded so a slow candidate never grows memory
+    static constexpr int max_pending_samples = 4;
+    tbb::concurrent_queue<Sample> sample_queue;
+    std::atomic<int> pending_samples{0};
+
+    // watcher thread only
+    std::string failed_path;
+    std::time_t failed_mtime = 0;
+
+    // shadow thread only
+    static constexpr int warmup_iterations = 10;
+    static constexpr int report_interval = 250;
+    std::shared_ptr<Candidate> shadow_candidate;
+    int shadow_count = 0;
+    double shadow_diff_sum = 0.0;
+    double shadow_diff_max = 0.0;
+    double shadow_latency_sum = 0.0;
+    double shadow_latency_max = 0.0;
+
+    std::shared_ptr<LoopFunc> loop_watch;
+    std::shared_ptr<LoopFunc> loop_shadow;
+};
+
+#endif // POLICY_RELOADER_HPP
@@ -4,13 +4,19 @@
  */
 
 #include "rl_sdk.hpp"
+#include <algorithm>
+#include <sys/stat.h>
+
+#ifndef RL_CONFIG_BUNDLE_DIR
+#define RL_CONFIG_BUNDLE_DIR "" // no bundles, always read the YAML files
+#endif
 
 /* You may need to override this Forward() function
 torch::Tensor RL_XXX::Forward()
 {
     torch::autograd::GradMode::set_enabled(false);
     torch::Tensor clamped_obs = this->ComputeObservation();
-    torch::Tensor actions = this->model.forward({clamped_obs}).toTensor();
+    torch::Tensor actions = this->PolicyForward(clamped_obs);
     torch::Tensor clamped_actions = torch::clamp(actions, this->params.clip_actions_lower, this->params.clip_actions_upper);
     return clamped_actions;
 }
@@ -81,6 +87,10 @@ public:
 
     std::string checkChange() override
     {
+        if (rl.control.control_state == STATE::STATE_DAMPING)
+        {
+            return "RLFSMStateDamping";
+        }
         if (rl.running_percent >= 1.0f)
         {
             if (rl.control.control_state == STATE::STATE_RL_LOCOMOTION)
@@ -143,6 +153,10 @@ public:
 
     std::string checkChange() override
     {
+        if (rl.control.control_state == STATE::STATE_DAMPING)
+        {
+            return "RLFSMStateDamping";
+        }
         if (rl.running_percent >= 1.0f)
         {
             return "RLFSMStateWaiting";
@@ -157,6 +171,33 @@ public:
     void exit() override { }
 };
 
+// entered by the safety supervisor: no stiffness, the fixed damping lets the robot settle
+class RLFSMStateDamping : public RLFSMState
+{
+public:
+    RLFSMStateDamping(RL& rl, const RobotState<double>* state, RobotCommand<double>* command)
+        : RLFSMState(rl, state, command, "RLFSMStateDamping") {}
+
+    void enter() override { }
+
+    void run() override
+    {
+        rl.safety_supervisor.Hold(fsm_state->motor_state.q.data(), fsm_command->motor_command.q.data(), fsm_command->motor_command.dq.data(),
+                                  fsm_command->motor_command.kp.data(), fsm_command->motor_command.kd.data(), fsm_command->motor_command.tau.data());
+    }
+
+    std::string checkChange() override
+    {
+        if (rl.control.control_state == STATE::STATE_POS_GETUP)
+        {
+            return "RLFSMStateGetUp";
+        }
+        return _stateName;
+    }
+
+    void exit() override { }
+};
+
 class RLFSMStateRL_Locomotion : public RLFSMState
 {
 public:
@@ -187,18 +228,21 @@ public:
     {
         std::cout << "\r" << std::flush << LOGGER::INFO << "RL Controller x:" << rl.control.x << " y:" << rl.control.y << " yaw:" << rl.control.yaw << std::flush;
 
-        torch::Tensor _output_dof_pos, _output_dof_vel;
+        StampedOutput _output_dof_pos;
+        torch::Tensor _output_dof_vel;
         if (rl.output_dof_pos_queue.try_pop(_output_dof_pos) && rl.output_dof_vel_queue.try_pop(_output_dof_vel))
         {
+            // apply the dequeued action, loop_rl reassigns the output_dof_* members meanwhile
+            fsm_command->stamp = _output_dof_pos.stamp;
             for (int i = 0; i < rl.params.num_of_dofs; ++i)
             {
-                if (_output_dof_pos.defined() && _output_dof_pos.numel() > 0)
+                if (_output_dof_pos.dof_pos.defined() && _output_dof_pos.dof_pos.numel() > 0)
                 {
-                    fsm_command->motor_command.q[i] = rl.output_dof_pos[0][i].item<double>();
+                    fsm_command->motor_command.q[i] = _output_dof_pos.dof_pos[0][i].item<double>();
                 }
                 if (_output_dof_vel.defined() && _output_dof_vel.numel() > 0)
                 {
-                    fsm_command->motor_command.dq[i] = rl.output_dof_vel[0][i].item<double>();
+                    fsm_command->motor_command.dq[i] = _output_dof_vel[0][i].item<double>();
                 }
                 fsm_command->motor_command.kp[i] = rl.params.rl_kp[0][i].item<double>();
                 fsm_command->motor_command.kd[i] = rl.params.rl_kd[0][i].item<double>();
@@ -209,7 +253,11 @@ public:
 
     std::string checkChange() override
     {
-        if (rl.control.control_state == STATE::STATE_POS_GETDOWN)
+        if (rl.control.control_state == STATE::STATE_DAMPING)
+        {
+            return "RLFSMStateDamping";
+        }
+        else if (rl.control.control_state == STATE::STATE_POS_GETDOWN)
         {
             return "RLFSMStateGetDown";
         }
@@ -239,6 +287,7 @@ public:
     void exit() override
     {
         rl.rl_init_done = false;
+        fsm_command->stamp = ActionStamp();
     }
 };
 
@@ -272,18 +321,21 @@ public:
     {
         std::cout << "\r" << std::flush << LOGGER::INFO << "RL Controller x:" << rl.control.x << " y:" << rl.control.y << " yaw:" << rl.control.yaw << std::flush;
 
-        torch::Tensor _output_dof_pos, _output_dof_vel;
+        StampedOutput _output_dof_pos;
+        torch::Tensor _output_dof_vel;
         if (rl.output_dof_pos_queue.try_pop(_output_dof_pos) && rl.output_dof_vel_queue.try_pop(_output_dof_vel))
         {
+            // apply the dequeued action, loop_rl reassigns the output_dof_* members meanwhile
+            fsm_command->stamp = _output_dof_pos.stamp;
             for (int i = 0; i < rl.params.num_of_dofs; ++i)
             {
-                if (_output_dof_pos.defined() && _output_dof_pos.numel() > 0)
+                if (_output_dof_pos.dof_pos.defined() && _output_dof_pos.dof_pos.numel() > 0)
                 {
-                    fsm_command->motor_command.q[i] = rl.output_dof_pos[0][i].item<double>();
+                    fsm_command->motor_command.q[i] = _output_dof_pos.dof_pos[0][i].item<double>();
                 }
                 if (_output_dof_vel.defined() && _output_dof_vel.numel() > 0)
                 {
-                    fsm_command->motor_command.dq[i] = rl.output_dof_vel[0][i].item<double>();
+                    fsm_command->motor_command.dq[i] = _output_dof_vel[0][i].item<double>();
                 }
                 fsm_command->motor_command.kp[i] = rl.params.rl_kp[0][i].item<double>();
                 fsm_command->motor_command.kd[i] = rl.params.rl_kd[0][i].item<double>();
@@ -294,7 +346,11 @@ public:
 
     std::string checkChange() override
     {
-        if (rl.control.control_state == STATE::STATE_POS_GETDOWN)
+        if (rl.control.control_state == STATE::STATE_DAMPING)
+        {
+            return "RLFSMStateDamping";
+        }
+        else if (rl.control.control_state == STATE::STATE_POS_GETDOWN)
         {
             return "RLFSMStateGetDown";
         }
@@ -320,12 +376,14 @@ public:
     void exit() override
     {
         rl.rl_init_done = false;
+        fsm_command->stamp = ActionStamp();
     }
 };
 
 
 void RL::StateController(const RobotState<double>* state, RobotCommand<double>* command)
 {
+    TRACE_SCOPE("StateController");
     auto updateState = [&](std::shared_ptr<FSMState> statePtr)
     {
         if (auto rl_fsm_state = std::dynamic_pointer_cast<RLFSMState>(statePtr))
@@ -347,6 +405,7 @@ RL::RL()
     fsm.addState(std::make_shared<RLFSMStateWaiting>(*this, nullptr, nullptr));
     fsm.addState(std::make_shared<RLFSMStateGetUp>(*this, nullptr, nullptr));
     fsm.addState(std::make_shared<RLFSMStateGetDown>(*this, nullptr, nullptr));
+    fsm.addState(std::make_shared<RLFSMStateDamping>(*this, nullptr, nullptr));
     fsm.addState(std::make_shared<RLFSMStateRL_Locomotion>(*this, nullptr, nullptr));
     fsm.addState(std::make_shared<RLFSMStateRL_Navigation>(*this, nullptr, nullptr));
 
@@ -355,6 +414,7 @@ RL::RL()
 
 torch::Tensor RL::ComputeObservation()
 {
+    TRACE_SCOPE("ComputeObservation");
     std::vector<torch::Tensor> obs_list;
 
     for (const std::string &observation : this->params.observations)
@@ -405,7 +465,7 @@ torch::Tensor RL::ComputeObservation()
         }
         else if (observation == "phase")
         {
-            torch::Tensor phase = torch::tensor({{3.1415926 * this->episode_length_buf * this->params.dt * this->params.decimation / 2}});
+            torch::Tensor phase = torch::tensor({{static_cast<float>(3.1415926 * this->episode_length_buf * this->params.dt * this->params.decimation / 2)}}, torch::kFloat);
             torch::Tensor phase_tensor = torch::cat({
                 torch::sin(phase),
                 torch::cos(phase),
@@ -418,8 +478,8 @@ torch::Tensor RL::ComputeObservation()
         }
         else if (observation == "g1_phase")
         {
-            torch::Tensor period = torch::tensor({{0.8f}});
-            torch::Tensor count = torch::tensor({{this->episode_length_buf * this->params.dt * this->params.decimation}});
+            torch::Tensor period = torch::tensor({{0.8f}}, torch::kFloat);
+            torch::Tensor count = torch::tensor({{static_cast<float>(this->episode_length_buf * this->params.dt * this->params.decimation)}}, torch::kFloat);
             torch::Tensor phase = torch::fmod(count, period) / period;
             torch::Tensor phase_tensor = torch::cat({
                 torch::sin(2 * 3.1415926f * phase),
@@ -436,14 +496,218 @@ torch::Tensor RL::ComputeObservation()
 
 void RL::InitObservations()
 {
-    this->obs.lin_vel = torch::tensor({{0.0, 0.0, 0.0}});
-    this->obs.ang_vel = torch::tensor({{0.0, 0.0, 0.0}});
-    this->obs.gravity_vec = torch::tensor({{0.0, 0.0, -1.0}});
-    this->obs.commands = torch::tensor({{0.0, 0.0, 0.0}});
-    this->obs.base_quat = torch::tensor({{0.0, 0.0, 0.0, 1.0}});
-    this->obs.dof_pos = this->params.default_dof_pos;
-    this->obs.dof_vel = torch::zeros({1, this->params.num_of_dofs});
+    this->obs.gravity_vec = torch::tensor({{0.0f, 0.0f, -1.0f}}, torch::kFloat);
     this->obs.actions = torch::zeros({1, this->params.num_of_dofs});
+
+    // the terms read from the robot state are refilled in place by UpdateObservations()
+    this->obs_storage = ObservationStorage();
+    this->obs_storage.base_quat[3] = 1.0f;
+    this->obs.lin_vel = torch::from_blob(this->obs_storage.lin_vel, {1, 3}, torch::kFloat);
+    this->obs.ang_vel = torch::from_blob(this->obs_storage.ang_vel, {1, 3}, torch::kFloat);
+    this->obs.commands = torch::from_blob(this->obs_storage.commands, {1, 3}, torch::kFloat);
+    this->obs.base_quat = torch::from_blob(this->obs_storage.base_quat, {1, 4}, torch::kFloat);
+    this->obs.dof_pos = torch::from_blob(this->obs_storage.dof_pos, {1, this->params.num_of_dofs}, torch::kFloat);
+    this->obs.dof_vel = torch::from_blob(this->obs_storage.dof_vel, {1, this->params.num_of_dofs}, torch::kFloat);
+    this->obs.dof_pos.copy_(this->params.default_dof_pos);
+}
+
+void RL::UpdateObservations(const RobotState<double> *state)
+{
+    // writes through the obs views, no tensor is created and nothing is allocated
+    const std::array<double, 3> &lin_vel = this->base_velocity.Read();
+    for (int i = 0; i < 3; ++i)
+    {
+        this->obs_storage.lin_vel[i] = static_cast<float>(lin_vel[i]);
+        this->obs_storage.ang_vel[i] = static_cast<float>(state->imu.gyroscope[i]);
+    }
+    LatencyStats stats;
+    if (this->velocity_estimator_latency && this->velocity_estimator_latency->Read(stats) &&
+        stats.max * 1000.0 > this->params.velocity_estimator.budget_us)
+    {
+        std::cout << LOGGER::WARNING << "Velocity estimator took up to " << stats.max * 1000.0 << "us, budget "
+                  << this->params.velocity_estimator.budget_us << "us" << std::endl;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        this->obs_storage.base_quat[i] = static_cast<float>(state->imu.quaternion[i]);
+    }
+    for (int i = 0; i < this->params.num_of_dofs; ++i)
+    {
+        this->obs_storage.dof_pos[i] = static_cast<float>(state->motor_state.q[i]);
+        this->obs_storage.dof_vel[i] = static_cast<float>(state->motor_state.dq[i]);
+    }
+}
+
+void RL::ConfigureVelocityEstimator()
+{
+    // RobotState follows the joint order of the running config, so the legs are resolved again
+    // whenever it changes; the filter state is only cleared by InitRL() and a simulation reset
+    if (this->params.velocity_estimator.num_legs == 0)
+    {
+        return;
+    }
+    std::string error = this->velocity_estimator.Configure(this->params.velocity_estimator, this->params.joint_controller_names,
+                                                           FindRobotKinematics(this->robot_name));
+    if (!error.empty())
+    {
+        std::cout << LOGGER::WARNING << "Velocity estimator paused, " << error << std::endl;
+    }
+    this->velocity_estimator.SetWorldFrameGyroscope(this->is_simulation);
+    if (!this->velocity_estimator_latency)
+    {
+        this->velocity_estimator_latency.reset(new LatencyHistogram("velocity_estimator", 0.001, 1.0, 5.0, false));
+    }
+}
+
+void RL::EstimateBaseVelocity(const RobotState<double> *state)
+{
+    // the quaternion order of RobotState is only known once a config set the framework
+    if (!this->velocity_estimator.Configured() || this->params.framework.empty())
+    {
+        return;
+    }
+    TRACE_SCOPE("EstimateBaseVelocity");
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    const std::vector<double> &q = state->imu.quaternion;
+    double quaternion[4] = {q[0], q[1], q[2], q[3]};
+    if (this->params.framework == "isaacgym")
+    {
+        quaternion[0] = q[3];
+        quaternion[1] = q[0];
+        quaternion[2] = q[1];
+        quaternion[3] = q[2];
+    }
+    this->velocity_estimator.Update(quaternion, state->imu.gyroscope.data(), state->imu.accelerometer.data(),
+                                    state->motor_state.q.data(), state->motor_state.dq.data(), this->params.dt);
+    std::array<double, 3> &lin_vel = this->base_velocity.Back();
+    std::copy(this->velocity_estimator.Velocity(), this->velocity_estimator.Velocity() + 3, lin_vel.begin());
+    this->base_velocity.Publish();
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    this->velocity_estimator_latency->Record(end - begin, end);
+}
+
+// one-time copy of a 1 x num_of_dofs params tensor
+static std::vector<double> RowValues(const torch::Tensor &row)
+{
+    torch::Tensor values = row.to(torch::kDouble).contiguous();
+    return std::vector<double>(values.data_ptr<double>(), values.data_ptr<double>() + values.numel());
+}
+
+void RL::ConfigureSafety()
+{
+    // resolved again with every config, which brings its own joint order, gains and torque limits;
+    // a trip stays latched across it
+    if (!this->params.safety.enabled)
+    {
+        return;
+    }
+    std::string error = this->safety_supervisor.Configure(this->params.safety, this->params.joint_controller_names, RowValues(this->params.fixed_kp).data(),
+                                                          RowValues(this->params.fixed_kd).data(), RowValues(this->params.torque_limits).data(),
+                                                          FindRobotKinematics(this->robot_name));
+    if (!error.empty())
+    {
+        std::cout << LOGGER::WARNING << "Safety supervisor off, " << error << std::endl;
+    }
+}
+
+void RL::Supervise(const RobotState<double> *state, RobotCommand<double> *command)
+{
+    if (!this->safety_supervisor.Configured() || !this->fsm._currentState)
+    {
+        return;
+    }
+    TRACE_SCOPE("Supervise");
+    const std::string &name = this->fsm._currentState->getStateName();
+    const bool policy = name == "RLFSMStateRL_Locomotion" || name == "RLFSMStateRL_Navigation";
+    // RobotState keeps the quaternion in the order of the config's framework, the identity it
+    // starts with reads the same either way
+    const std::vector<double> &q = state->imu.quaternion;
+    double quaternion[4] = {q[0], q[1], q[2], q[3]};
+    if (this->params.framework == "isaacgym")
+    {
+        quaternion[0] = q[3];
+        quaternion[1] = q[0];
+        quaternion[2] = q[1];
+        quaternion[3] = q[2];
+    }
+    RobotCommand<double>::MotorCommand &motor = command->motor_command;
+    SafetyInput input;
+    input.quaternion = quaternion;
+    input.q = state->motor_state.q.data();
+    input.dq = state->motor_state.dq.data();
+    input.q_target = motor.q.data();
+    input.dq_target = motor.dq.data();
+    input.kp = motor.kp.data();
+    input.kd = motor.kd.data();
+    input.tau = motor.tau.data();
+    input.actuated = policy || name == "RLFSMStateGetUp" || name == "RLFSMStateGetDown";
+    input.policy = policy && this->rl_init_done;
+    input.action = command->stamp.action;
+    input.now = std::chrono::steady_clock::now();
+    if (!this->safety_supervisor.Update(input))
+    {
+        return;
+    }
+
+    // tripped: the fallback state takes over within two FSM ticks and the supervisor's command goes
+    // out until then; once it is in place, a get-up request re-arms
+    const bool getdown = this->safety_supervisor.Fallback() == SAFETY_FALLBACK_GETDOWN;
+    const bool settled = name == (getdown ? "RLFSMStateGetDown" : "RLFSMStateDamping") || name == "RLFSMStateWaiting";
+    if (settled && this->control.control_state == STATE_POS_GETUP)
+    {
+        this->safety_supervisor.Rearm();
+        return;
+    }
+    this->control.SetControlState(getdown ? STATE_POS_GETDOWN : STATE_DAMPING);
+    if (!settled)
+    {
+        this->safety_supervisor.Hold(input.q, motor.q.data(), motor.dq.data(), motor.kp.data(), motor.kd.data(), motor.tau.data());
+    }
+}
+
+void RL::ReportSafety()
+{
+    SafetyReport report;
+    if (!this->safety_supervisor.Read(report))
+    {
+        return;
+    }
+    for (int check = 0; check < SAFETY_NUM_CHECKS; ++check)
+    {
+        const SafetyCheckReport &result = report.checks[check];
+        if (result.trips > this->safety_trips[check])
+        {
+            std::cout << std::endl << LOGGER::WARNING << "Safety: " << SafetySupervisor::CheckName(check) << " tripped";
+            if (result.name[0])
+            {
+                std::cout << " by " << result.name;
+            }
+            std::cout << ", " << result.value << " against " << result.limit;
+            if (report.tripped && report.cause == check && !this->safety_tripped)
+            {
+                std::cout << ", falling back to " << (report.fallback == SAFETY_FALLBACK_GETDOWN ? "get-down" : "damping") << " until the next get-up";
+            }
+            std::cout << std::endl;
+        }
+        else if (result.violations > 0)
+        {
+            std::cout << std::endl << LOGGER::WARNING << "Safety: " << SafetySupervisor::CheckName(check) << " over the limit for "
+                      << result.violations << " ticks, worst " << result.name << " " << result.value << " against " << result.limit << std::endl;
+        }
+        this->safety_trips[check] = result.trips;
+    }
+    if (this->safety_tripped && !report.tripped)
+    {
+        std::cout << std::endl << LOGGER::INFO << "Safety: re-armed" << std::endl;
+    }
+    this->safety_tripped = report.tripped;
+}
+
+void RL::UpdateObservationCommands(double x, double y, double yaw)
+{
+    this->obs_storage.commands[0] = static_cast<float>(x);
+    this->obs_storage.commands[1] = static_cast<float>(y);
+    this->obs_storage.commands[2] = static_cast<float>(yaw);
 }
 
 void RL::InitOutputs()
@@ -460,6 +724,35 @@ void RL::InitControl()
     this->control.yaw = 0.0;
 }
 
+// Falls back to the fp32 model when an int8 config has no quantized model yet, and selects
+// the quantized engine before loading one: packed int8 weights are laid out for the engine
+// that is active when the model is loaded.
+static std::string PolicyPath(const std::string &model_dir, const std::string &model_name, const std::string &model_file)
+{
+    const std::string path = model_dir + "/" + model_file;
+    if (model_file == model_name)
+    {
+        return path;
+    }
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    {
+        std::cout << LOGGER::WARNING << model_file << " not found, running the fp32 " << model_name << ". Quantize it with scripts/quantize_policy.py" << std::endl;
+        return model_dir + "/" + model_name;
+    }
+#if defined(__aarch64__) || defined(__arm__)
+    const at::QEngine engine = at::QEngine::QNNPACK;
+#else
+    const at::QEngine engine = at::QEngine::FBGEMM;
+#endif
+    const std::vector<at::QEngine> &engines = at::globalContext().supportedQEngines();
+    if (std::find(engines.begin(), engines.end(), engine) != engines.end())
+    {
+        at::globalContext().setQEngine(engine);
+    }
+    return path;
+}
+
 void RL::InitRL(std::string robot_path)
 {
     this->ReadYamlRL(robot_path);
@@ -480,22 +773,142 @@ void RL::InitRL(std::string robot_path)
 
         }
     }
-    // init rl
-    if (!this->params.observations_history.empty())
+    // model
+    std::string model_dir = std::string(CMAKE_CURRENT_SOURCE_DIR) + "/models/" + robot_path;
+    std::string model_path = PolicyPath(model_dir, this->params.model_name, this->params.model_file);
+    // keep a hot-reloaded policy across FSM transitions
+    std::string promoted_model_path = this->policy_reloader.PromotedModelPath(model_dir);
+    if (!promoted_model_path.empty())
     {
-        this->history_obs_buf = ObservationBuffer(1, this->params.num_observations, this->params.observations_history.size());
+        model_path = promoted_model_path;
+    }
+    if (model_path == this->preloaded_model_path)
+    {
+        this->model = this->preloaded_model;
+        this->preloaded_model_path.clear(); // later entries reload the file like before
+        this->preloaded_model = torch::jit::script::Module();
+    }
+    else
+    {
+        this->model = torch::jit::load(model_path);
+    }
+    this->policy_reloader.Watch(model_dir, model_path);
+
+    // a recurrent policy starts from a zero state every time an RL state is entered
+    this->hidden_states.clear();
+    for (const std::vector<int64_t> &shape : this->params.hidden_states)
+    {
+        this->hidden_states.push_back(torch::zeros(shape));
+    }
+    this->model_inputs.Bind(this->params.policy_inputs, this->params.num_observations, this->params.observations_history, this->hidden_states, this->params.commands_scale);
+    // a signature mismatch fails here with both sides named instead of inside the first tick
+    const size_t num_arguments = this->model.get_method("forward").function().getSchema().arguments().size() - 1;
+    if (num_arguments != this->model_inputs.Values().size())
+    {
+        throw std::runtime_error(this->params.model_name + " forward() takes " + std::to_string(num_arguments) + " inputs, config.yaml binds " +
+                                 this->model_inputs.Signature() + ". Declare them with policy_inputs");
     }
-    // model
-    std::string model_path = std::string(CMAKE_CURRENT_SOURCE_DIR) + "/models/" + robot_path + "/" + this->params.model_name;
-    this->model = torch::jit::load(model_path);
 
     this->InitObservations();
     this->InitOutputs();
     this->InitControl();
+    // the estimate carried over from the getup or a previous policy is not this policy's to inherit;
+    // same thread as EstimateBaseVelocity()
+    this->velocity_estimator.Reset();
+}
+
+void RL::PreloadModel(const std::string &robot_path)
+{
+    // runs during startup next to ReadYamlBase() and the transport bring-up, so it reads its own
+    // copy of the config and writes nothing but the preloaded_* members
+    std::string models_dir = std::string(CMAKE_CURRENT_SOURCE_DIR) + "/models";
+    size_t separator = robot_path.find('/');
+    std::string robot_name = robot_path.substr(0, separator);
+    std::string config_name = separator == std::string::npos ? "" : robot_path.substr(separator + 1);
+    RLConfig config;
+    if (config_bundle::LoadRL(models_dir, RL_CONFIG_BUNDLE_DIR, robot_name, config_name, config) == config_bundle::SOURCE_NONE)
+    {
+        return; // InitRL() reports it
+    }
+    std::string model_path = PolicyPath(models_dir + "/" + robot_path, config.model_name, config_bundle::ModelFile(config));
+
+    torch::jit::script::Module module;
+    {
+        StartupPhase phase("policy load");
+        module = torch::jit::load(model_path);
+    }
+    {
+        // the first calls of a TorchScript module run the profiling and optimization passes,
+        // do them here instead of in the first control ticks; the inputs are bound like InitRL() binds them
+        StartupPhase phase("policy warm-up");
+        torch::NoGradGuard no_grad;
+        std::vector<torch::Tensor> hidden_states;
+        for (int i = 0; i < config.num_hidden_states; ++i)
+        {
+            hidden_states.push_back(torch::zeros(std::vector<int64_t>(config.hidden_state_shapes[i], config.hidden_state_shapes[i] + config.hidden_state_ranks[i])));
+        }
+        PolicyInputs inputs;
+        inputs.Bind(std::vector<PolicyInputConfig>(config.policy_inputs, config.policy_inputs + config.num_policy_inputs), config.num_observations,
+                    std::vector<int>(config.observations_history, config.observations_history + config.num_history), hidden_states,
+                    torch::ones({1, CONFIG_COMMANDS}));
+        try
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                module.forward(inputs.Values());
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << LOGGER::WARNING << "Policy warm-up skipped: " << e.what() << std::endl;
+        }
+    }
+    this->preloaded_model = module;
+    this->preloaded_model_path = model_path;
+}
+
+torch::Tensor RL::PolicyForward(const torch::Tensor &clamped_obs)
+{
+    // the inputs are bound once in InitRL(), a tick only refills them; recurrent policies return
+    // their next state after the actions: forward(obs, h, c) -> (actions, h, c)
+    {
+        TRACE_SCOPE("UpdateInputs");
+        this->model_inputs.Update(clamped_obs, this->obs.commands);
+    }
+    std::vector<torch::jit::IValue> &inputs = this->model_inputs.Values();
+
+    torch::jit::IValue output;
+    {
+        TRACE_SCOPE("ModelForward");
+        output = this->model.forward(inputs);
+    }
+    if (this->hidden_states.empty())
+    {
+        torch::Tensor actions = output.toTensor();
+        this->policy_reloader.Submit(inputs, actions);
+        this->input_recorder.Record(inputs);
+        return actions;
+    }
+
+    if (!output.isTuple() || output.toTuple()->elements().size() != this->hidden_states.size() + 1)
+    {
+        throw std::runtime_error("the policy must return (actions, " + std::to_string(this->hidden_states.size()) + " hidden states) as declared in hidden_states");
+    }
+    const auto &elements = output.toTuple()->elements();
+    torch::Tensor actions = elements[0].toTensor();
+    // before the state below is overwritten, the inputs still hold the one this tick used
+    this->policy_reloader.Submit(inputs, actions);
+    this->input_recorder.Record(inputs);
+    for (size_t i = 0; i < this->hidden_states.size(); ++i)
+    {
+        this->hidden_states[i].copy_(elements[i + 1].toTensor());
+    }
+    return actions;
 }
 
 void RL::ComputeOutput(const torch::Tensor &actions, torch::Tensor &output_dof_pos, torch::Tensor &output_dof_vel, torch::Tensor &output_dof_tau)
 {
+    TRACE_SCOPE("ComputeOutput");
     torch::Tensor actions_scaled = actions * this->params.action_scale;
     torch::Tensor pos_actions_scaled = actions_scaled.clone();
     torch::Tensor vel_actions_scaled = torch::zeros_like(actions);
@@ -533,88 +946,6 @@ torch::Tensor RL::QuatRotateInverse(torch::Tensor q, torch::Tensor v, const std:
     return a - b + c;
 }
 
-void RL::TorqueProtect(torch::Tensor origin_output_dof_tau)
-{
-    std::vector<int> out_of_range_indices;
-    std::vector<double> out_of_range_values;
-    for (int i = 0; i < origin_output_dof_tau.size(1); ++i)
-    {
-        double torque_value = origin_output_dof_tau[0][i].item<double>();
-        double limit_lower = -this->params.torque_limits[0][i].item<double>();
-        double limit_upper = this->params.torque_limits[0][i].item<double>();
-
-        if (torque_value < limit_lower || torque_value > limit_upper)
-        {
-            out_of_range_indices.push_back(i);
-            out_of_range_values.push_back(torque_value);
-        }
-    }
-    if (!out_of_range_indices.empty())
-    {
-        for (int i = 0; i < out_of_range_indices.size(); ++i)
-        {
-            int index = out_of_range_indices[i];
-            double value = out_of_range_values[i];
-            double limit_lower = -this->params.torque_limits[0][index].item<double>();
-            double limit_upper = this->params.torque_limits[0][index].item<double>();
-
-            std::cout << LOGGER::WARNING << "Torque(" << index + 1 << ")=" << value << " out of range(" << limit_lower << ", " << limit_upper << ")" << std::endl;
-        }
-        // Just a reminder, no protection
-        // this->control.SetControlState(STATE_POS_GETDOWN);
-        // std::cout << LOGGER::INFO << "Switching to STATE_POS_GETDOWN"<< std::endl;
-    }
-}
-
-void RL::AttitudeProtect(const std::vector<double> &quaternion, float pitch_threshold, float roll_threshold)
-{
-    float rad2deg = 57.2958;
-    float w, x, y, z;
-
-    if (this->params.framework == "isaacgym")
-    {
-        w = quaternion[3];
-        x = quaternion[0];
-        y = quaternion[1];
-        z = quaternion[2];
-    }
-    else if (this->params.framework == "isaacsim")
-    {
-        w = quaternion[0];
-        x = quaternion[1];
-        y = quaternion[2];
-        z = quaternion[3];
-    }
-
-    // Calculate roll (rotation around the X-axis)
-    float sinr_cosp = 2 * (w * x + y * z);
-    float cosr_cosp = 1 - 2 * (x * x + y * y);
-    float roll = std::atan2(sinr_cosp, cosr_cosp) * rad2deg;
-
-    // Calculate pitch (rotation around the Y-axis)
-    float sinp = 2 * (w * y - z * x);
-    float pitch;
-    if (std::fabs(sinp) >= 1)
-    {
-        pitch = std::copysign(90.0, sinp); // Clamp to avoid out-of-range values
-    }
-    else
-    {
-        pitch = std::asin(sinp) * rad2deg;
-    }
-
-    if (std::fabs(roll) > roll_threshold)
-    {
-        // this->control.SetControlState(STATE_POS_GETDOWN);
-        std::cout << LOGGER::WARNING << "Roll exceeds " << roll_threshold << " degrees. Current: " << roll << " degrees." << std::endl;
-    }
-    if (std::fabs(pitch) > pitch_threshold)
-    {
-        // this->control.SetControlState(STATE_POS_GETDOWN);
-        std::cout << LOGGER::WARNING << "Pitch exceeds " << pitch_threshold << " degrees. Current: " << pitch << " degrees." << std::endl;
-    }
-}
-
 #include <termios.h>
 #include <sys/ioctl.h>
 static bool kbhit()
@@ -636,6 +967,7 @@ static bool kbhit()
 
 void RL::KeyboardInterface()
 {
+    this->ReportSafety();
     if (kbhit())
     {
         int c = fgetc(stdin);
@@ -655,6 +987,18 @@ void RL::KeyboardInterface()
             break;
         case 'q':
             break;
+        case 'm':
+            this->policy_reloader.RequestPromote();
+            break;
+        case 'o':
+            this->input_recorder.Toggle(InputRecorder::DefaultDirectory(this->robot_name + "/" + this->config_name));
+            break;
+        case 't':
+            if (this->latency)
+            {
+                this->latency->Print();
+            }
+            break;
         case 'w':
             this->control.x += 0.1;
             break;
@@ -694,101 +1038,113 @@ void RL::KeyboardInterface()
     }
 }
 
-template <typename T>
-std::vector<T> ReadVectorFromYaml(const YAML::Node &node)
+// params keep the joint tables as 1 x num_of_dofs tensors, float like the observations they scale
+static torch::Tensor RowTensor(const double *values, int count)
 {
-    std::vector<T> values;
-    for (const auto &val : node)
-    {
-        values.push_back(val.as<T>());
-    }
-    return values;
+    return torch::tensor(std::vector<float>(values, values + count), torch::kFloat).view({1, -1});
+}
+
+static std::vector<std::string> Names(const char (*names)[CONFIG_NAME_SIZE], int count)
+{
+    return std::vector<std::string>(names, names + count);
 }
 
 void RL::ReadYamlBase(std::string robot_path)
 {
-    // The config file is located at "rl_sar/src/rl_sar/models/<robot_path>/base.yaml"
-    std::string config_path = std::string(CMAKE_CURRENT_SOURCE_DIR) + "/models/" + robot_path + "/base.yaml";
-    YAML::Node config;
-    try
+    // "rl_sar/src/rl_sar/models/<robot_path>/base.yaml", served from the build's config bundle while it is current
+    std::string models_dir = std::string(CMAKE_CURRENT_SOURCE_DIR) + "/models";
+    BaseConfig config;
+    config_bundle::Source source = config_bundle::LoadBase(models_dir, RL_CONFIG_BUNDLE_DIR, robot_path, config);
+    if (source == config_bundle::SOURCE_NONE)
     {
-        config = YAML::LoadFile(config_path)[robot_path];
+        std::cout << LOGGER::ERROR << "The file '" << models_dir << "/" << robot_path << "/base.yaml' does not exist" << std::endl;
+        return;
     }
-    catch (YAML::BadFile &e)
+    if (source == config_bundle::SOURCE_YAML)
     {
-        std::cout << LOGGER::ERROR << "The file '" << config_path << "' does not exist" << std::endl;
-        return;
+        std::cout << LOGGER::INFO << "Read " << robot_path << "/base.yaml from YAML, the config bundle is missing or older" << std::endl;
     }
 
-    this->params.dt = config["dt"].as<double>();
-    this->params.decimation = config["decimation"].as<int>();
-    this->params.wheel_indices = ReadVectorFromYaml<int>(config["wheel_indices"]);
-    this->params.num_of_dofs = config["num_of_dofs"].as<int>();
-    this->params.fixed_kp = torch::tensor(ReadVectorFromYaml<double>(config["fixed_kp"])).view({1, -1});
-    this->params.fixed_kd = torch::tensor(ReadVectorFromYaml<double>(config["fixed_kd"])).view({1, -1});
-    this->params.torque_limits = torch::tensor(ReadVectorFromYaml<double>(config["torque_limits"])).view({1, -1});
-    this->params.default_dof_pos = torch::tensor(ReadVectorFromYaml<double>(config["default_dof_pos"])).view({1, -1});
-    this->params.joint_controller_names = ReadVectorFromYaml<std::string>(config["joint_controller_names"]);
-    this->params.command_mapping = ReadVectorFromYaml<int>(config["command_mapping"]);
-    this->params.state_mapping = ReadVectorFromYaml<int>(config["state_mapping"]);
+    this->params.dt = config.dt;
+    this->params.decimation = config.decimation;
+    this->params.wheel_indices.assign(config.wheel_indices, config.wheel_indices + config.num_wheels);
+    this->params.num_of_dofs = config.num_of_dofs;
+    this->params.fixed_kp = RowTensor(config.fixed_kp, config.num_of_dofs);
+    this->params.fixed_kd = RowTensor(config.fixed_kd, config.num_of_dofs);
+    this->params.torque_limits = RowTensor(config.torque_limits, config.num_of_dofs);
+    this->params.default_dof_pos = RowTensor(config.default_dof_pos, config.num_of_dofs);
+    this->params.joint_controller_names = Names(config.joint_controller_names, config.num_of_dofs);
+    this->params.command_mapping.assign(config.command_mapping, config.command_mapping + config.num_of_dofs);
+    this->params.state_mapping.assign(config.state_mapping, config.state_mapping + config.num_of_dofs);
+    this->params.velocity_estimator = config.velocity_estimator;
+    this->params.safety = config.safety;
+    this->ConfigureVelocityEstimator();
+    this->ConfigureSafety();
 }
 
 void RL::ReadYamlRL(std::string robot_path)
 {
-    // The config file is located at "rl_sar/src/rl_sar/models/<robot_path>/config.yaml"
-    std::string config_path = std::string(CMAKE_CURRENT_SOURCE_DIR) + "/models/" + robot_path + "/config.yaml";
-    YAML::Node config;
-    try
-    {
-        config = YAML::LoadFile(config_path)[robot_path];
-    }
-    catch (YAML::BadFile &e)
+    // "rl_sar/src/rl_sar/models/<robot_path>/config.yaml", robot_path is "<robot>/<config>"
+    std::string models_dir = std::string(CMAKE_CURRENT_SOURCE_DIR) + "/models";
+    size_t separator = robot_path.find('/');
+    std::string robot_name = robot_path.substr(0, separator);
+    std::string config_name = separator == std::string::npos ? "" : robot_path.substr(separator + 1);
+    RLConfig config;
+    config_bundle::Source source = config_bundle::LoadRL(models_dir, RL_CONFIG_BUNDLE_DIR, robot_name, config_name, config);
+    if (source == config_bundle::SOURCE_NONE)
     {
-        std::cout << LOGGER::ERROR << "The file '" << config_path << "' does not exist" << std::endl;
+        std::cout << LOGGER::ERROR << "The file '" << models_dir << "/" << robot_path << "/config.yaml' does not exist" << std::endl;
         return;
     }
-
-    this->params.model_name = config["model_name"].as<std::string>();
-    this->params.framework = config["framework"].as<std::string>();
-    this->params.num_observations = config["num_observations"].as<int>();
-    this->params.observations = ReadVectorFromYaml<std::string>(config["observations"]);
-    if (config["observations_history"].IsNull())
+    if (source == config_bundle::SOURCE_YAML)
     {
-        this->params.observations_history = {};
+        std::cout << LOGGER::INFO << "Read " << robot_path << "/config.yaml from YAML, the config bundle is missing or older" << std::endl;
     }
-    else
+
+    const int num_of_dofs = config.num_of_dofs;
+    this->params.model_name = config.model_name;
+    this->params.model_file = config_bundle::ModelFile(config);
+    this->params.framework = config.framework;
+    this->params.num_observations = config.num_observations;
+    this->params.observations.assign(config.observations, config.observations + config.num_observation_terms);
+    this->params.observations_history.assign(config.observations_history, config.observations_history + config.num_history);
+    this->params.hidden_states.clear();
+    for (int i = 0; i < config.num_hidden_states; ++i)
     {
-        this->params.observations_history = ReadVectorFromYaml<int>(config["observations_history"]);
+        this->params.hidden_states.emplace_back(config.hidden_state_shapes[i], config.hidden_state_shapes[i] + config.hidden_state_ranks[i]);
     }
-    this->params.clip_obs = config["clip_obs"].as<double>();
-    if (config["clip_actions_lower"].IsNull() && config["clip_actions_upper"].IsNull())
+    this->params.policy_inputs.assign(config.policy_inputs, config.policy_inputs + config.num_policy_inputs);
+    this->params.clip_obs = config.clip_obs;
+    if (!config.has_clip_actions)
     {
-        this->params.clip_actions_upper = torch::tensor({}).view({1, -1});
-        this->params.clip_actions_lower = torch::tensor({}).view({1, -1});
+        this->params.clip_actions_upper = torch::empty({1, 0}, torch::kFloat);
+        this->params.clip_actions_lower = torch::empty({1, 0}, torch::kFloat);
     }
     else
     {
-        this->params.clip_actions_upper = torch::tensor(ReadVectorFromYaml<double>(config["clip_actions_upper"])).view({1, -1});
-        this->params.clip_actions_lower = torch::tensor(ReadVectorFromYaml<double>(config["clip_actions_lower"])).view({1, -1});
-    }
-    this->params.action_scale = torch::tensor(ReadVectorFromYaml<double>(config["action_scale"])).view({1, -1});
-    this->params.wheel_indices = ReadVectorFromYaml<int>(config["wheel_indices"]);
-    this->params.num_of_dofs = config["num_of_dofs"].as<int>();
-    this->params.lin_vel_scale = config["lin_vel_scale"].as<double>();
-    this->params.ang_vel_scale = config["ang_vel_scale"].as<double>();
-    this->params.dof_pos_scale = config["dof_pos_scale"].as<double>();
-    this->params.dof_vel_scale = config["dof_vel_scale"].as<double>();
-    this->params.commands_scale = torch::tensor(ReadVectorFromYaml<double>(config["commands_scale"])).view({1, -1});
+        this->params.clip_actions_upper = RowTensor(config.clip_actions_upper, num_of_dofs);
+        this->params.clip_actions_lower = RowTensor(config.clip_actions_lower, num_of_dofs);
+    }
+    this->params.action_scale = RowTensor(config.action_scale, num_of_dofs);
+    this->params.wheel_indices.assign(config.wheel_indices, config.wheel_indices + config.num_wheels);
+    this->params.num_of_dofs = num_of_dofs;
+    this->params.lin_vel_scale = config.lin_vel_scale;
+    this->params.ang_vel_scale = config.ang_vel_scale;
+    this->params.dof_pos_scale = config.dof_pos_scale;
+    this->params.dof_vel_scale = config.dof_vel_scale;
+    this->params.commands_scale = RowTensor(config.commands_scale, CONFIG_COMMANDS);
     // this->params.commands_scale = torch::tensor({this->params.lin_vel_scale, this->params.lin_vel_scale, this->params.ang_vel_scale});
-    this->params.rl_kp = torch::tensor(ReadVectorFromYaml<double>(config["rl_kp"])).view({1, -1});
-    this->params.rl_kd = torch::tensor(ReadVectorFromYaml<double>(config["rl_kd"])).view({1, -1});
-    this->params.fixed_kp = torch::tensor(ReadVectorFromYaml<double>(config["fixed_kp"])).view({1, -1});
-    this->params.fixed_kd = torch::tensor(ReadVectorFromYaml<double>(config["fixed_kd"])).view({1, -1});
-    this->params.torque_limits = torch::tensor(ReadVectorFromYaml<double>(config["torque_limits"])).view({1, -1});
-    this->params.default_dof_pos = torch::tensor(ReadVectorFromYaml<double>(config["default_dof_pos"])).view({1, -1});
-    this->params.joint_controller_names = ReadVectorFromYaml<std::string>(config["joint_controller_names"]);
-    this->params.command_mapping = ReadVectorFromYaml<int>(config["command_mapping"]);
-    this->params.state_mapping = ReadVectorFromYaml<int>(config["state_mapping"]);
+    this->params.rl_kp = RowTensor(config.rl_kp, num_of_dofs);
+    this->params.rl_kd = RowTensor(config.rl_kd, num_of_dofs);
+    this->params.fixed_kp = RowTensor(config.fixed_kp, num_of_dofs);
+    this->params.fixed_kd = RowTensor(config.fixed_kd, num_of_dofs);
+    this->params.torque_limits = RowTensor(config.torque_limits, num_of_dofs);
+    this->params.default_dof_pos = RowTensor(config.default_dof_pos, num_of_dofs);
+    this->params.joint_controller_names = Names(config.joint_controller_names, num_of_dofs);
+    this->params.command_mapping.assign(config.command_mapping, config.command_mapping + num_of_dofs);
+    this->params.state_mapping.assign(config.state_mapping, config.state_mapping + num_of_dofs);
+    this->ConfigureVelocityEstimator();
+    this->ConfigureSafety();
 }
 
 void RL::CSVInit(std::string robot_path)
@@ -819,6 +1175,7 @@ void RL::CSVInit(std::string robot_path)
 
 void RL::CSVLogger(torch::Tensor torque, torch::Tensor tau_est, torch::Tensor joint_pos, torch::Tensor joint_pos_target, torch::Tensor joint_vel)
 {
+    TRACE_SCOPE("CSVLogger");
     std::ofstream file(csv_filename.c_str(), std::ios_base::app);
 
     for(int i = 0; i < 12; ++i) { file << torque[0][i].item<double>() << ","; }
@@ -831,3 +1188,35 @@ void RL::CSVLogger(torch::Tensor torque, torch::Tensor tau_est, torch::Tensor jo
 
     file.close();
 }
+
+void RL::TelemetryInit()
+{
+    if (this->telemetry.Open(this->params.joint_controller_names, this->params.dt))
+    {
+        std::cout << LOGGER::INFO << "Telemetry published to " << TELEMETRY_RING_NAME << ", view with scripts/telemetry_viewer.py" << std::endl;
+    }
+    else
+    {
+        std::cout << LOGGER::WARNING << "Cannot open telemetry ring " << TELEMETRY_RING_NAME << ": " << strerror(errno) << std::endl;
+    }
+    this->telemetry_start = std::chrono::steady_clock::now();
+}
+
+void RL::TelemetryPublish(uint64_t tick, const RobotState<double> *state, const RobotCommand<double> *command)
+{
+    TRACE_SCOPE("TelemetryPublish");
+    TelemetryData &sample = this->telemetry.Back();
+    sample.tick = tick;
+    sample.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->telemetry_start).count();
+    sample.control_state = this->control.control_state;
+    for (int i = 0; i < this->params.num_of_dofs; ++i)
+    {
+        sample.q[i] = state->motor_state.q[i];
+        sample.dq[i] = state->motor_state.dq[i];
+        sample.tau_est[i] = state->motor_state.tau_est[i];
+        sample.q_target[i] = command->motor_command.q[i];
+        sample.dq_target[i] = command->motor_command.dq[i];
+        sample.tau_target[i] = command->motor_command.tau[i];
+    }
+    this->telemetry.Publish();
+}
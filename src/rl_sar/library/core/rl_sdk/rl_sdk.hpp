@@ -7,6 +7,9 @@
 #define RL_SDK_HPP
 
 #include <torch/script.h>
+#include <array>
+#include <cerrno>
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <exception>
@@ -15,15 +18,18 @@
 
 #include <yaml-cpp/yaml.h>
 #include "fsm.hpp"
-#include "observation_buffer.hpp"
-
-namespace LOGGER
-{
-    const char *const INFO    = "\033[0;37m[INFO]\033[0m ";
-    const char *const WARNING = "\033[0;33m[WARNING]\033[0m ";
-    const char *const ERROR   = "\033[0;31m[ERROR]\033[0m ";
-    const char *const DEBUG   = "\033[0;32m[DEBUG]\033[0m ";
-}
+#include "policy_reloader.hpp"
+#include "logger.hpp"
+#include "telemetry_ring.hpp"
+#include "tracer.hpp"
+#include "pipeline_latency.hpp"
+#include "config_bundle.hpp"
+#include "startup_profiler.hpp"
+#include "input_recorder.hpp"
+#include "policy_inputs.hpp"
+#include "velocity_estimator.hpp"
+#include "safety_supervisor.hpp"
+#include "triple_buffer.hpp"
 
 template <typename T>
 struct RobotCommand
@@ -37,6 +43,8 @@ struct RobotCommand
         std::vector<T> kp = std::vector<T>(32, 0.0);
         std::vector<T> kd = std::vector<T>(32, 0.0);
     } motor_command;
+
+    ActionStamp stamp; // policy action this command applies, empty for scripted states
 };
 
 template <typename T>
@@ -57,6 +65,8 @@ struct RobotState
         std::vector<T> tau_est = std::vector<T>(32, 0.0);
         std::vector<T> cur = std::vector<T>(32, 0.0);
     } motor_state;
+
+    std::chrono::steady_clock::time_point stamp; // when the transport received this state
 };
 
 enum STATE
@@ -68,6 +78,7 @@ enum STATE
     STATE_POS_GETDOWN,
     STATE_RESET_SIMULATION,
     STATE_TOGGLE_SIMULATION,
+    STATE_DAMPING, // safety fallback, left with STATE_POS_GETUP
 };
 
 struct Control
@@ -90,12 +101,15 @@ struct Control
 struct ModelParams
 {
     std::string model_name;
+    std::string model_file; // model_name, or its int8 version for precision int8
     std::string framework;
     double dt;
     int decimation;
     int num_observations;
     std::vector<std::string> observations;
     std::vector<int> observations_history;
+    std::vector<std::vector<int64_t>> hidden_states; // shapes, empty for stateless policies
+    std::vector<PolicyInputConfig> policy_inputs; // forward()'s arguments in order
     double damping;
     double stiffness;
     torch::Tensor action_scale;
@@ -118,6 +132,8 @@ struct ModelParams
     std::vector<std::string> joint_controller_names;
     std::vector<int> command_mapping;
     std::vector<int> state_mapping;
+    VelocityEstimatorConfig velocity_estimator; // from base.yaml, num_legs is 0 without one
+    SafetyConfig safety;                        // from base.yaml, enabled is 0 without one
 };
 
 struct Observations
@@ -132,6 +148,25 @@ struct Observations
     torch::Tensor actions;
 };
 
+// joint position targets of one policy step, queued together with where they came from
+struct StampedOutput
+{
+    torch::Tensor dof_pos;
+    ActionStamp stamp;
+};
+
+// float32 storage behind the state-backed observations, which are from_blob views of it;
+// sized for the largest robot so the views never move
+struct ObservationStorage
+{
+    float lin_vel[3];
+    float ang_vel[3];
+    float base_quat[4];
+    float commands[3];
+    float dof_pos[CONFIG_MAX_DOFS];
+    float dof_vel[CONFIG_MAX_DOFS];
+};
+
 class RL
 {
 public:
@@ -140,10 +175,11 @@ public:
 
     ModelParams params;
     Observations obs;
+    ObservationStorage obs_storage;
 
     RobotState<double> robot_state;
     RobotCommand<double> robot_command;
-    tbb::concurrent_queue<torch::Tensor> output_dof_pos_queue;
+    tbb::concurrent_queue<StampedOutput> output_dof_pos_queue;
     tbb::concurrent_queue<torch::Tensor> output_dof_vel_queue;
     tbb::concurrent_queue<torch::Tensor> output_dof_tau_queue;
 
@@ -158,10 +194,14 @@ public:
     void InitOutputs();
     void InitControl();
     void InitRL(std::string robot_path);
+    void PreloadModel(const std::string &robot_path);
 
     // rl functions
     virtual torch::Tensor Forward() = 0;
     torch::Tensor ComputeObservation();
+    void UpdateObservations(const RobotState<double> *state);
+    void UpdateObservationCommands(double x, double y, double yaw);
+    torch::Tensor PolicyForward(const torch::Tensor &clamped_obs);
     virtual void GetState(RobotState<double> *state) = 0;
     virtual void SetCommand(const RobotCommand<double> *command) = 0;
     void StateController(const RobotState<double> *state, RobotCommand<double> *command);
@@ -177,13 +217,30 @@ public:
     void CSVInit(std::string robot_name);
     void CSVLogger(torch::Tensor torque, torch::Tensor tau_est, torch::Tensor joint_pos, torch::Tensor joint_pos_target, torch::Tensor joint_vel);
 
+    // live telemetry for scripts/telemetry_viewer.py
+    TelemetryRing telemetry;
+    std::chrono::steady_clock::time_point telemetry_start;
+    void TelemetryInit();
+    void TelemetryPublish(uint64_t tick, const RobotState<double> *state, const RobotCommand<double> *command);
+
+    // observation and action age, created by the runtime with its backend name
+    std::unique_ptr<PipelineLatency> latency;
+
     // control
     Control control;
     void KeyboardInterface();
 
-    // history buffer
-    ObservationBuffer history_obs_buf;
-    torch::Tensor history_obs;
+    // recurrent policy state, allocated and zeroed by InitRL() and overwritten in place every tick
+    std::vector<torch::Tensor> hidden_states;
+    // the model's inputs, bound by InitRL() and refilled in place by PolicyForward()
+    PolicyInputs model_inputs;
+
+    // base velocity for the lin_vel observation, estimated every control tick and read by UpdateObservations()
+    VelocityEstimator velocity_estimator;
+    TripleBuffer<std::array<double, 3>> base_velocity;
+    std::unique_ptr<LatencyHistogram> velocity_estimator_latency;
+    void ConfigureVelocityEstimator();
+    void EstimateBaseVelocity(const RobotState<double> *state);
 
     // others
     std::string robot_name, config_name, default_rl_config;
@@ -191,12 +248,22 @@ public:
     bool is_simulation = false;
     unsigned long long episode_length_buf = 0;
 
-    // protect func
-    void TorqueProtect(torch::Tensor origin_output_dof_tau);
-    void AttitudeProtect(const std::vector<double> &quaternion, float pitch_threshold, float roll_threshold);
+    // safety checks of every control tick, between StateController() and SetCommand(); reported
+    // from the keyboard loop so the control thread never prints them
+    SafetySupervisor safety_supervisor;
+    bool safety_tripped = false;                   // last report, keyboard loop only
+    uint64_t safety_trips[SAFETY_NUM_CHECKS] = {}; // keyboard loop only
+    void ConfigureSafety();
+    void Supervise(const RobotState<double> *state, RobotCommand<double> *command);
+    void ReportSafety();
 
     // rl module
     torch::jit::script::Module model;
+    PolicyReloader policy_reloader;
+    InputRecorder input_recorder;
+    // loaded and warmed up during startup, handed to the first InitRL() that asks for the same file
+    torch::jit::script::Module preloaded_model;
+    std::string preloaded_model_path;
     // output buffer
     torch::Tensor output_dof_tau;
     torch::Tensor output_dof_pos;
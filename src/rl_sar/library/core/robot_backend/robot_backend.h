@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ROBOT_BACKEND_H
+#define ROBOT_BACKEND_H
+
+/*
+ * C ABI between the rl_real runtime and the robot transport plugins (librl_backend_<name>.so).
+ *
+ * A plugin only moves data: it turns whatever the robot sends into an rl_backend_state and an
+ * rl_backend_command into whatever the robot expects. Observations, inference, the FSM, joint
+ * mapping, scheduling and telemetry stay in the runtime. Everything crossing the boundary is
+ * plain data in hardware motor order, so plugins can be built against a different C++ runtime
+ * or SDK without affecting the controller.
+ *
+ * Call order: create (main thread) -> start -> get_state/set_command/wait_state from the
+ * control thread -> destroy. The runtime never calls into a plugin from two threads at once,
+ * but start() may run while the runtime loads the policy on another thread.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RL_BACKEND_ABI_VERSION 2
+#define RL_BACKEND_ENTRY "rl_backend_entry"
+#define RL_BACKEND_MAX_MOTORS 32
+#define RL_BACKEND_NAME_SIZE 64
+
+/* state transition requested by the robot's own remote, mirrors the runtime's STATE values */
+enum
+{
+    RL_BACKEND_REQUEST_NONE = 0,
+    RL_BACKEND_REQUEST_GETUP,
+    RL_BACKEND_REQUEST_LOCOMOTION,
+    RL_BACKEND_REQUEST_GETDOWN,
+};
+
+/* start flags */
+#define RL_BACKEND_FLAG_CHAINED 0x1 /* the runtime drives the link through wait_state */
+
+typedef struct rl_backend rl_backend;
+
+typedef struct
+{
+    char robot_name[RL_BACKEND_NAME_SIZE];        /* models/<robot_name>/base.yaml */
+    char default_rl_config[RL_BACKEND_NAME_SIZE]; /* models/<robot_name>/<default_rl_config> */
+} rl_backend_info;
+
+typedef struct
+{
+    int num_of_dofs;   /* motors the runtime commands, from base.yaml */
+    double dt;         /* control period in seconds */
+    uint32_t flags;    /* RL_BACKEND_FLAG_* */
+    /* reports a named step of start() to the runtime's startup breakdown, steady_clock
+       nanoseconds; may be NULL, callable from any thread until start() returns */
+    void (*startup_phase)(const char *name, int64_t begin_ns, int64_t end_ns);
+} rl_backend_config;
+
+typedef struct
+{
+    double quaternion[4]; /* w, x, y, z */
+    double gyroscope[3];
+    double accelerometer[3];
+    double q[RL_BACKEND_MAX_MOTORS];
+    double dq[RL_BACKEND_MAX_MOTORS];
+    double tau_est[RL_BACKEND_MAX_MOTORS];
+    int has_remote;       /* the fields below are valid */
+    double remote_x;      /* velocity commands from the robot's remote */
+    double remote_y;
+    double remote_yaw;
+    int remote_request;   /* RL_BACKEND_REQUEST_* */
+    int64_t stamp;        /* steady_clock nanoseconds when the transport received this state */
+    uint64_t sequence;    /* increases with every new state, 0 until the first one arrives */
+} rl_backend_state;
+
+typedef struct
+{
+    int num_motors;
+    double q[RL_BACKEND_MAX_MOTORS];
+    double dq[RL_BACKEND_MAX_MOTORS];
+    double tau[RL_BACKEND_MAX_MOTORS];
+    double kp[RL_BACKEND_MAX_MOTORS];
+    double kd[RL_BACKEND_MAX_MOTORS];
+} rl_backend_command;
+
+typedef struct
+{
+    uint32_t abi_version; /* RL_BACKEND_ABI_VERSION the plugin was built with */
+    const char *name;
+    const char *usage;    /* backend arguments, for the runtime's help text */
+
+    /* parses the backend arguments and fills info, returns NULL on bad arguments */
+    rl_backend *(*create)(int argc, char **argv, rl_backend_info *info);
+    /* brings the link up once the runtime has read base.yaml, returns 0 on success */
+    int (*start)(rl_backend *backend, const rl_backend_config *config);
+    /* copies the newest state out, returns 0 on success */
+    int (*get_state)(rl_backend *backend, rl_backend_state *state);
+    /* hands a command to the transport, returns 0 on success */
+    int (*set_command)(rl_backend *backend, const rl_backend_command *command);
+    /* optional, NULL if unsupported: blocks until a new state arrives or timeout_us passes,
+       returns 1 for a new state and 0 on timeout; only used with RL_BACKEND_FLAG_CHAINED */
+    int (*wait_state)(rl_backend *backend, int64_t timeout_us);
+    void (*destroy)(rl_backend *backend);
+} rl_backend_api;
+
+/* the only symbol a plugin exports */
+typedef const rl_backend_api *(*rl_backend_entry_fn)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROBOT_BACKEND_H */
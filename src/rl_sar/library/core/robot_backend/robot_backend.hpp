@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ROBOT_BACKEND_HPP
+#define ROBOT_BACKEND_HPP
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <new>
+#include "robot_backend.h"
+#include "logger.hpp"
+
+/**
+ * @brief C++ side of the plugin ABI.
+ *
+ * A plugin derives from RobotBackend, adds a static Create(argc, argv, info) returning a new
+ * instance or nullptr, and exports it with RL_BACKEND_EXPORT. Exceptions never cross the C
+ * boundary: they are logged and turned into a failed call.
+ */
+class RobotBackend
+{
+public:
+    virtual ~RobotBackend() {}
+    virtual int Start(const rl_backend_config &config) = 0;
+    virtual int GetState(rl_backend_state &state) = 0;
+    virtual int SetCommand(const rl_backend_command &command) = 0;
+    virtual int WaitState(int64_t timeout_us) { return 0; }
+
+    // plugins hold cache-line aligned TripleBuffers, which plain new ignores before C++17
+    static void *operator new(size_t size)
+    {
+        void *ptr = aligned_alloc(64, (size + 63) & ~static_cast<size_t>(63));
+        if (!ptr)
+        {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+    static void operator delete(void *ptr) { free(ptr); }
+};
+
+namespace robot_backend
+{
+    inline RobotBackend *Cast(rl_backend *backend) { return reinterpret_cast<RobotBackend *>(backend); }
+
+    // reports the enclosing scope as a step of Start() through rl_backend_config::startup_phase
+    class StartupStep
+    {
+    public:
+        StartupStep(const rl_backend_config &config, const char *name)
+            : report(config.startup_phase), name(name), begin(Now()) {}
+        ~StartupStep()
+        {
+            if (this->report)
+            {
+                this->report(this->name, this->begin, Now());
+            }
+        }
+        StartupStep(const StartupStep &) = delete;
+        StartupStep &operator=(const StartupStep &) = delete;
+
+    private:
+        static int64_t Now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+        void (*report)(const char *, int64_t, int64_t);
+        const char *name;
+        int64_t begin;
+    };
+
+    template <typename F>
+    int Guard(const char *name, F &&call)
+    {
+        try
+        {
+            return call();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << LOGGER::ERROR << "Backend " << name << ": " << e.what() << std::endl;
+            return -1;
+        }
+    }
+}
+
+#define RL_BACKEND_EXPORT(Class, backend_name, backend_usage, supports_wait)                                  \
+    extern "C" __attribute__((visibility("default"))) const rl_backend_api *rl_backend_entry()                \
+    {                                                                                                         \
+        static const rl_backend_api api = {                                                                   \
+            RL_BACKEND_ABI_VERSION,                                                                           \
+            backend_name,                                                                                     \
+            backend_usage,                                                                                    \
+            [](int argc, char **argv, rl_backend_info *info) -> rl_backend *                                  \
+            {                                                                                                 \
+                RobotBackend *backend = nullptr;                                                              \
+                robot_backend::Guard(backend_name, [&] { backend = Class::Create(argc, argv, *info); return 0; }); \
+                return reinterpret_cast<rl_backend *>(backend);                                               \
+            },                                                                                                \
+            [](rl_backend *backend, const rl_backend_config *config) -> int                                   \
+            { return robot_backend::Guard(backend_name, [&] { return robot_backend::Cast(backend)->Start(*config); }); }, \
+            [](rl_backend *backend, rl_backend_state *state) -> int                                           \
+            { return robot_backend::Guard(backend_name, [&] { return robot_backend::Cast(backend)->GetState(*state); }); }, \
+            [](rl_backend *backend, const rl_backend_command *command) -> int                                 \
+            { return robot_backend::Guard(backend_name, [&] { return robot_backend::Cast(backend)->SetCommand(*command); }); }, \
+            (supports_wait) ? static_cast<int (*)(rl_backend *, int64_t)>(                                    \
+                [](rl_backend *backend, int64_t timeout_us) -> int                                            \
+                { return robot_backend::Guard(backend_name, [&] { return robot_backend::Cast(backend)->WaitState(timeout_us); }); }) \
+                            : nullptr,                                                                        \
+            [](rl_backend *backend) { delete robot_backend::Cast(backend); },                                 \
+        };                                                                                                    \
+        return &api;                                                                                          \
+    }
+
+#endif // ROBOT_BACKEND_HPP
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ROBOT_BACKEND_LOADER_HPP
+#define ROBOT_BACKEND_LOADER_HPP
+
+#include <dlfcn.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "robot_backend.h"
+#include "logger.hpp"
+
+// "a1" -> librl_backend_a1.so in RL_BACKEND_DIR of the including target, then on
+// LD_LIBRARY_PATH; anything with a '/' is used as a path
+inline const rl_backend_api *LoadBackend(const std::string &name)
+{
+    std::vector<std::string> candidates;
+    if (name.find('/') != std::string::npos)
+    {
+        candidates.push_back(name);
+    }
+    else
+    {
+#ifdef RL_BACKEND_DIR
+        candidates.push_back(std::string(RL_BACKEND_DIR) + "/librl_backend_" + name + ".so");
+#endif
+        candidates.push_back("librl_backend_" + name + ".so"); // LD_LIBRARY_PATH
+    }
+
+    for (const std::string &path : candidates)
+    {
+        void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle)
+        {
+            std::cout << LOGGER::WARNING << "Cannot load " << path << ": " << dlerror() << std::endl;
+            continue;
+        }
+        // the plugin stays loaded for the lifetime of the process
+        rl_backend_entry_fn entry = reinterpret_cast<rl_backend_entry_fn>(dlsym(handle, RL_BACKEND_ENTRY));
+        const rl_backend_api *api = entry ? entry() : nullptr;
+        if (!api)
+        {
+            std::cout << LOGGER::ERROR << path << " does not export " << RL_BACKEND_ENTRY << std::endl;
+            dlclose(handle);
+            return nullptr;
+        }
+        if (api->abi_version != RL_BACKEND_ABI_VERSION)
+        {
+            std::cout << LOGGER::ERROR << path << " was built for backend ABI " << api->abi_version << ", expected " << RL_BACKEND_ABI_VERSION << std::endl;
+            dlclose(handle);
+            return nullptr;
+        }
+        std::cout << LOGGER::INFO << "Loaded backend " << api->name << " from " << path << std::endl;
+        return api;
+    }
+    return nullptr;
+}
+
+#endif // ROBOT_BACKEND_LOADER_HPP
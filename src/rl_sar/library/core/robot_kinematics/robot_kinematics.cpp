@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "robot_kinematics.hpp"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    struct Transform
+    {
+        double R[3][3];
+        double p[3];
+    };
+
+    void AxisAngle(const double axis[3], double angle, double R[3][3])
+    {
+        const double c = std::cos(angle), s = std::sin(angle);
+        const double x = axis[0], y = axis[1], z = axis[2];
+        R[0][0] = c + x * x * (1.0 - c);
+        R[0][1] = x * y * (1.0 - c) - z * s;
+        R[0][2] = x * z * (1.0 - c) + y * s;
+        R[1][0] = y * x * (1.0 - c) + z * s;
+        R[1][1] = c + y * y * (1.0 - c);
+        R[1][2] = y * z * (1.0 - c) - x * s;
+        R[2][0] = z * x * (1.0 - c) - y * s;
+        R[2][1] = z * y * (1.0 - c) + x * s;
+        R[2][2] = c + z * z * (1.0 - c);
+    }
+
+    void RPY(const double rpy[3], double R[3][3])
+    {
+        const double x[3] = {1.0, 0.0, 0.0}, y[3] = {0.0, 1.0, 0.0}, z[3] = {0.0, 0.0, 1.0};
+        double Rx[3][3], Ry[3][3], Rz[3][3], Rzy[3][3];
+        AxisAngle(x, rpy[0], Rx);
+        AxisAngle(y, rpy[1], Ry);
+        AxisAngle(z, rpy[2], Rz);
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                Rzy[i][j] = Rz[i][0] * Ry[0][j] + Rz[i][1] * Ry[1][j] + Rz[i][2] * Ry[2][j];
+            }
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                R[i][j] = Rzy[i][0] * Rx[0][j] + Rzy[i][1] * Rx[1][j] + Rzy[i][2] * Rx[2][j];
+            }
+        }
+    }
+
+    // out = a * (R, p)
+    void Compose(const Transform &a, const double R[3][3], const double p[3], Transform &out)
+    {
+        Transform result;
+        for (int i = 0; i < 3; ++i)
+        {
+            result.p[i] = a.p[i] + a.R[i][0] * p[0] + a.R[i][1] * p[1] + a.R[i][2] * p[2];
+            for (int j = 0; j < 3; ++j)
+            {
+                result.R[i][j] = a.R[i][0] * R[0][j] + a.R[i][1] * R[1][j] + a.R[i][2] * R[2][j];
+            }
+        }
+        out = result;
+    }
+
+    // frames of every link, and for a moving joint its axis and origin in the base frame
+    void Walk(const RobotKinematics &kinematics, const double *q, std::vector<Transform> &links, std::vector<Transform> &joints)
+    {
+        links.resize(kinematics.num_links);
+        joints.resize(kinematics.num_links);
+        const double zero[3] = {0.0, 0.0, 0.0};
+        const double identity[3][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+        Transform base;
+        memcpy(base.R, identity, sizeof(base.R));
+        memcpy(base.p, zero, sizeof(base.p));
+        for (int i = 0; i < kinematics.num_links; ++i)
+        {
+            const KinematicsLink &link = kinematics.tree[i];
+            double R[3][3];
+            RPY(link.rpy, R);
+            Compose(link.parent >= 0 ? links[link.parent] : base, R, link.xyz, joints[i]);
+            if (link.type == KINEMATICS_REVOLUTE)
+            {
+                AxisAngle(link.axis, q[link.q], R);
+                Compose(joints[i], R, zero, links[i]);
+            }
+            else if (link.type == KINEMATICS_PRISMATIC)
+            {
+                const double p[3] = {link.axis[0] * q[link.q], link.axis[1] * q[link.q], link.axis[2] * q[link.q]};
+                Compose(joints[i], identity, p, links[i]);
+            }
+            else
+            {
+                links[i] = joints[i];
+            }
+        }
+    }
+}
+
+const RobotKinematics *FindRobotKinematics(const std::string &robot_name)
+{
+    for (int i = 0; i < num_robot_kinematics; ++i)
+    {
+        if (robot_name == robot_kinematics[i].robot_name)
+        {
+            return &robot_kinematics[i];
+        }
+    }
+    return nullptr;
+}
+
+void KinematicsTreePositions(const RobotKinematics &kinematics, const double *q, double *p)
+{
+    std::vector<Transform> links, joints;
+    Walk(kinematics, q, links, joints);
+    for (int e = 0; e < kinematics.num_end_effectors; ++e)
+    {
+        memcpy(p + 3 * e, links[kinematics.end_effector_links[e]].p, 3 * sizeof(double));
+    }
+}
+
+void KinematicsTreeJacobians(const RobotKinematics &kinematics, const double *q, double *J)
+{
+    std::vector<Transform> links, joints;
+    Walk(kinematics, q, links, joints);
+    const int n = kinematics.num_joints;
+    memset(J, 0, 3 * kinematics.num_end_effectors * n * sizeof(double));
+    for (int e = 0; e < kinematics.num_end_effectors; ++e)
+    {
+        const double *end = links[kinematics.end_effector_links[e]].p;
+        for (int i = kinematics.end_effector_links[e]; i >= 0; i = kinematics.tree[i].parent)
+        {
+            const KinematicsLink &link = kinematics.tree[i];
+            if (link.type == KINEMATICS_FIXED)
+            {
+                continue;
+            }
+            const Transform &joint = joints[i];
+            double axis[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                axis[k] = joint.R[k][0] * link.axis[0] + joint.R[k][1] * link.axis[1] + joint.R[k][2] * link.axis[2];
+            }
+            double column[3] = {axis[0], axis[1], axis[2]};
+            if (link.type == KINEMATICS_REVOLUTE)
+            {
+                const double d[3] = {end[0] - joint.p[0], end[1] - joint.p[1], end[2] - joint.p[2]};
+                column[0] = axis[1] * d[2] - axis[2] * d[1];
+                column[1] = axis[2] * d[0] - axis[0] * d[2];
+                column[2] = axis[0] * d[1] - axis[1] * d[0];
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                J[(3 * e + k) * n + link.q] = column[k];
+            }
+        }
+    }
+}
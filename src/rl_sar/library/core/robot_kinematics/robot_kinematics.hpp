@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ROBOT_KINEMATICS_HPP
+#define ROBOT_KINEMATICS_HPP
+
+#include <string>
+
+#define KINEMATICS_MAX_END_EFFECTORS 8
+
+enum KinematicsJointType
+{
+    KINEMATICS_FIXED = 0,
+    KINEMATICS_REVOLUTE, // revolute and continuous
+    KINEMATICS_PRISMATIC,
+};
+
+// one link of the URDF tree below the base, reached through the joint from its parent
+struct KinematicsLink
+{
+    int parent; // index into the tree, -1 for the base link
+    int type;   // KinematicsJointType
+    int q;      // joint_controller_names index, -1 when fixed
+    double xyz[3];
+    double rpy[3];
+    double axis[3]; // unit length, in the joint frame
+};
+
+// URDF <limit> of the joint a controller drives
+struct KinematicsJointLimits
+{
+    int has_position; // 0 for continuous joints
+    double lower;
+    double upper;
+    double velocity; // 0 when the URDF gives none
+    double effort;
+};
+
+/**
+ * @brief End-effector kinematics of one robot, generated from its URDF at build time.
+ *
+ * scripts/generate_kinematics.py multiplies the transforms out with the URDF constants folded in,
+ * so positions(), velocities() and jacobians() are straight-line code over sin and cos of the
+ * joints: no tree is walked and nothing is allocated. Joints are in base.yaml's
+ * joint_controller_names order and everything is in the base link frame. The tree the code was
+ * generated from is kept for KinematicsTree*(), the generic evaluator the generated code is
+ * checked against. The URDF joint limits come along for the safety supervisor.
+ */
+struct RobotKinematics
+{
+    const char *robot_name;
+    int num_joints;
+    int num_end_effectors;
+    const char *const *joint_names;   // controller names
+    const char *const *end_effectors; // URDF link names
+    const int *chains;                // [end effector * num_joints + joint], 1 when the joint moves it
+
+    // p[3 * end effector + axis]
+    void (*positions)(const double *q, double *p);
+    // v = J dq, laid out like p
+    void (*velocities)(const double *q, const double *dq, double *v);
+    // J[(3 * end effector + axis) * num_joints + joint]
+    void (*jacobians)(const double *q, double *J);
+
+    int num_links;
+    const KinematicsLink *tree; // parents first
+    const int *end_effector_links;
+
+    const KinematicsJointLimits *joint_limits; // joint_controller_names order
+};
+
+// generated, terminated by an entry without robot_name
+extern const RobotKinematics robot_kinematics[];
+extern const int num_robot_kinematics;
+
+// nullptr when the robot's base.yaml has no kinematics section
+const RobotKinematics *FindRobotKinematics(const std::string &robot_name);
+
+// generic evaluation by walking the tree, same layout as RobotKinematics; slow, for checks only
+void KinematicsTreePositions(const RobotKinematics &kinematics, const double *q, double *p);
+void KinematicsTreeJacobians(const RobotKinematics &kinematics, const double *q, double *J);
+
+#endif // ROBOT_KINEMATICS_HPP
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "safety_supervisor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+const char *SafetySupervisor::CheckName(int check)
+{
+    // the keys of base.yaml's safety section
+    static const char *const names[SAFETY_NUM_CHECKS] = {"joint_position", "joint_velocity", "torque", "attitude", "command_age", "non_finite"};
+    return check >= 0 && check < SAFETY_NUM_CHECKS ? names[check] : "none";
+}
+
+std::string SafetySupervisor::Configure(const SafetyConfig &config, const std::vector<std::string> &joint_names, const double *fixed_kp,
+                                        const double *fixed_kd, const double *torque_limits, const RobotKinematics *kinematics)
+{
+    this->config = config;
+    this->num_joints = 0;
+    if (!config.enabled)
+    {
+        return "";
+    }
+    if (joint_names.size() > CONFIG_MAX_DOFS)
+    {
+        this->config.enabled = 0;
+        return "safety: " + std::to_string(joint_names.size()) + " joints, at most " + std::to_string(CONFIG_MAX_DOFS) + " are supported";
+    }
+    if ((config.ticks[SAFETY_JOINT_POSITION] || config.ticks[SAFETY_JOINT_VELOCITY]) && !kinematics)
+    {
+        this->config.enabled = 0;
+        return "safety: the joint limits come from the generated kinematics, the robot has none";
+    }
+    for (size_t i = 0; i < joint_names.size(); ++i)
+    {
+        memset(this->joint_names[i], 0, CONFIG_NAME_SIZE);
+        strncpy(this->joint_names[i], joint_names[i].c_str(), CONFIG_NAME_SIZE - 1);
+        this->position_lower[i] = -std::numeric_limits<double>::infinity();
+        this->position_upper[i] = std::numeric_limits<double>::infinity();
+        this->velocity_limits[i] = 0.0;
+        this->torque_limits[i] = torque_limits[i] * config.torque_scale;
+        this->fixed_kp[i] = fixed_kp[i];
+        this->fixed_kd[i] = fixed_kd[i];
+        if (!kinematics)
+        {
+            continue;
+        }
+        int j = 0;
+        while (j < kinematics->num_joints && joint_names[i] != kinematics->joint_names[j])
+        {
+            ++j;
+        }
+        if (j == kinematics->num_joints)
+        {
+            this->config.enabled = 0;
+            return "safety: " + joint_names[i] + " is not a joint of the generated kinematics";
+        }
+        const KinematicsJointLimits &limits = kinematics->joint_limits[j];
+        if (limits.has_position)
+        {
+            this->position_lower[i] = limits.lower - config.position_margin;
+            this->position_upper[i] = limits.upper + config.position_margin;
+        }
+        this->velocity_limits[i] = limits.velocity * config.velocity_scale;
+    }
+    this->num_joints = joint_names.size();
+    return "";
+}
+
+SafetySupervisor::Limit SafetySupervisor::JointPosition(const SafetyInput &input) const
+{
+    Limit worst = {false, 0.0, 0.0, -1};
+    double worst_excess = 0.0;
+    for (int i = 0; i < this->num_joints; ++i)
+    {
+        const double below = this->position_lower[i] - input.q[i];
+        const double above = input.q[i] - this->position_upper[i];
+        if (below > worst_excess)
+        {
+            worst = {true, input.q[i], this->position_lower[i], i};
+            worst_excess = below;
+        }
+        else if (above > worst_excess)
+        {
+            worst = {true, input.q[i], this->position_upper[i], i};
+            worst_excess = above;
+        }
+    }
+    return worst;
+}
+
+SafetySupervisor::Limit SafetySupervisor::JointVelocity(const SafetyInput &input) const
+{
+    Limit worst = {false, 0.0, 0.0, -1};
+    double worst_excess = 0.0;
+    for (int i = 0; i < this->num_joints; ++i)
+    {
+        const double excess = std::fabs(input.dq[i]) - this->velocity_limits[i];
+        if (this->velocity_limits[i] > 0.0 && excess > worst_excess)
+        {
+            worst = {true, input.dq[i], this->velocity_limits[i], i};
+            worst_excess = excess;
+        }
+    }
+    return worst;
+}
+
+SafetySupervisor::Limit SafetySupervisor::Torque(const SafetyInput &input) const
+{
+    // what the joint PD loop will apply for this command
+    Limit worst = {false, 0.0, 0.0, -1};
+    double worst_excess = 0.0;
+    for (int i = 0; i < this->num_joints; ++i)
+    {
+        const double torque = input.kp[i] * (input.q_target[i] - input.q[i]) + input.kd[i] * (input.dq_target[i] - input.dq[i]) + input.tau[i];
+        const double excess = std::fabs(torque) - this->torque_limits[i];
+        if (excess > worst_excess)
+        {
+            worst = {true, torque, this->torque_limits[i], i};
+            worst_excess = excess;
+        }
+    }
+    return worst;
+}
+
+SafetySupervisor::Limit SafetySupervisor::Attitude(const SafetyInput &input) const
+{
+    const double rad2deg = 180.0 / M_PI;
+    const double w = input.quaternion[0], x = input.quaternion[1], y = input.quaternion[2], z = input.quaternion[3];
+    const double roll = std::atan2(2.0 * (w * x + y * z), 1.0 - 2.0 * (x * x + y * y)) * rad2deg;
+    const double pitch = std::asin(std::max(-1.0, std::min(1.0, 2.0 * (w * y - z * x)))) * rad2deg;
+    const double roll_excess = std::fabs(roll) - this->config.max_roll;
+    const double pitch_excess = std::fabs(pitch) - this->config.max_pitch;
+    if (roll_excess <= 0.0 && pitch_excess <= 0.0)
+    {
+        return {false, 0.0, 0.0, -1};
+    }
+    return roll_excess >= pitch_excess ? Limit{true, roll, this->config.max_roll, 0} : Limit{true, pitch, this->config.max_pitch, 1};
+}
+
+SafetySupervisor::Limit SafetySupervisor::NonFinite(const SafetyInput &input) const
+{
+    for (int i = 0; i < this->num_joints; ++i)
+    {
+        const double values[5] = {input.q_target[i], input.dq_target[i], input.kp[i], input.kd[i], input.tau[i]};
+        for (double value : values)
+        {
+            if (!std::isfinite(value))
+            {
+                return {true, value, 0.0, i};
+            }
+        }
+    }
+    return {false, 0.0, 0.0, -1};
+}
+
+void SafetySupervisor::Count(int check, const Limit &limit)
+{
+    SafetyCheckReport &window = this->window[check];
+    const int ticks = this->config.ticks[check];
+    if (!limit.over)
+    {
+        this->violations[check] = 0;
+        if (window.active && ++this->clean[check] >= ticks)
+        {
+            window.active = false;
+        }
+        return;
+    }
+    this->clean[check] = 0;
+    if (window.violations++ == 0 || std::fabs(limit.value - limit.limit) > std::fabs(window.value - window.limit))
+    {
+        window.value = limit.value;
+        window.limit = limit.limit;
+        window.index = limit.index;
+    }
+    if (++this->violations[check] >= ticks && !window.active)
+    {
+        window.active = true;
+        window.trips++;
+        if (!this->tripped)
+        {
+            this->tripped = true;
+            this->cause = check;
+            this->trip_pending = true;
+        }
+    }
+}
+
+bool SafetySupervisor::Update(const SafetyInput &input)
+{
+    if (!this->Configured())
+    {
+        return false;
+    }
+    // a control loop that did not run for longer than the timeout (simulation paused, process
+    // stopped) gives the policy a fresh timeout, its action is not older than the loop's last tick
+    const bool resumed = std::chrono::duration<double>(input.now - this->last_update).count() > this->config.command_timeout;
+    if (input.policy && (!this->was_policy || resumed))
+    {
+        this->policy_start = input.now;
+    }
+    this->was_policy = input.policy;
+    this->last_update = input.now;
+
+    if (input.actuated)
+    {
+        if (this->config.ticks[SAFETY_JOINT_POSITION])
+        {
+            this->Count(SAFETY_JOINT_POSITION, this->JointPosition(input));
+        }
+        if (this->config.ticks[SAFETY_JOINT_VELOCITY])
+        {
+            this->Count(SAFETY_JOINT_VELOCITY, this->JointVelocity(input));
+        }
+        if (this->config.ticks[SAFETY_TORQUE])
+        {
+            this->Count(SAFETY_TORQUE, this->Torque(input));
+        }
+        if (this->config.ticks[SAFETY_ATTITUDE])
+        {
+            this->Count(SAFETY_ATTITUDE, this->Attitude(input));
+        }
+        if (this->config.ticks[SAFETY_COMMAND_AGE])
+        {
+            // from entering the RL state or resuming until the next action arrives, from that action afterwards
+            Limit limit = {false, 0.0, 0.0, -1};
+            if (input.policy)
+            {
+                const double age = std::chrono::duration<double>(input.now - std::max(input.action, this->policy_start)).count();
+                if (age > this->config.command_timeout)
+                {
+                    limit = {true, age, this->config.command_timeout, -1};
+                }
+            }
+            this->Count(SAFETY_COMMAND_AGE, limit);
+        }
+        if (this->config.ticks[SAFETY_NON_FINITE])
+        {
+            this->Count(SAFETY_NON_FINITE, this->NonFinite(input));
+        }
+    }
+    else
+    {
+        // the joints are not driven, nothing carries over into the next actuated state
+        for (int check = 0; check < SAFETY_NUM_CHECKS; ++check)
+        {
+            this->violations[check] = 0;
+            this->clean[check] = 0;
+            this->window[check].active = false;
+        }
+    }
+
+    if (this->trip_pending)
+    {
+        this->Publish(input.now);
+    }
+    else if (std::chrono::duration<double>(input.now - this->last_report).count() >= this->config.report_period)
+    {
+        for (const SafetyCheckReport &window : this->window)
+        {
+            if (window.violations > 0)
+            {
+                this->Publish(input.now);
+                break;
+            }
+        }
+    }
+    return this->tripped;
+}
+
+void SafetySupervisor::Publish(std::chrono::steady_clock::time_point now)
+{
+    SafetyReport &report = this->reports.Back();
+    report.tripped = this->tripped;
+    report.cause = this->cause;
+    report.fallback = this->config.fallback;
+    for (int check = 0; check < SAFETY_NUM_CHECKS; ++check)
+    {
+        SafetyCheckReport &window = this->window[check];
+        report.checks[check] = window;
+        const char *name = "";
+        if (check == SAFETY_ATTITUDE && window.index >= 0)
+        {
+            name = window.index == 0 ? "roll" : "pitch";
+        }
+        else if (window.index >= 0 && window.index < this->num_joints)
+        {
+            name = this->joint_names[window.index];
+        }
+        strncpy(report.checks[check].name, name, CONFIG_NAME_SIZE - 1);
+        report.checks[check].name[CONFIG_NAME_SIZE - 1] = '\0';
+        window.violations = 0;
+        window.value = 0.0;
+        window.limit = 0.0;
+        window.index = -1;
+    }
+    this->reports.Publish();
+    this->last_report = now;
+    this->trip_pending = false;
+}
+
+void SafetySupervisor::Rearm()
+{
+    this->tripped = false;
+    this->cause = -1;
+    for (int check = 0; check < SAFETY_NUM_CHECKS; ++check)
+    {
+        this->violations[check] = 0;
+        this->clean[check] = 0;
+        this->window[check].active = false;
+    }
+    this->trip_pending = true; // the consumer sees the release with the next tick
+}
+
+void SafetySupervisor::Hold(const double *q, double *q_target, double *dq_target, double *kp, double *kd, double *tau) const
+{
+    for (int i = 0; i < this->num_joints; ++i)
+    {
+        q_target[i] = q[i];
+        dq_target[i] = 0.0;
+        kp[i] = this->config.fallback == SAFETY_FALLBACK_GETDOWN ? this->fixed_kp[i] : 0.0;
+        kd[i] = this->fixed_kd[i];
+        tau[i] = 0.0;
+    }
+}
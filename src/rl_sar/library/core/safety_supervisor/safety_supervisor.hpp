@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SAFETY_SUPERVISOR_HPP
+#define SAFETY_SUPERVISOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "config_bundle.hpp"
+#include "robot_kinematics.hpp"
+#include "triple_buffer.hpp"
+
+// what one control tick hands to the supervisor, joints in RobotState order
+struct SafetyInput
+{
+    const double *quaternion; // w, x, y, z
+    const double *q;
+    const double *dq;
+    // the command about to be sent
+    const double *q_target;
+    const double *dq_target;
+    const double *kp;
+    const double *kd;
+    const double *tau;
+    bool actuated; // the FSM drives the joints, only then are the checks run
+    bool policy;   // the applied command comes from the policy
+    std::chrono::steady_clock::time_point action; // when the policy produced it, empty before the first action
+    std::chrono::steady_clock::time_point now;
+};
+
+struct SafetyCheckReport
+{
+    uint64_t trips = 0;      // since the start
+    uint64_t violations = 0; // ticks over the limit since the previous report
+    double value = 0.0;      // furthest beyond the limit since the previous report
+    double limit = 0.0;
+    int index = -1; // joint, or 0 for roll and 1 for pitch
+    char name[CONFIG_NAME_SIZE] = {}; // of index
+    bool active = false;
+};
+
+struct SafetyReport
+{
+    bool tripped = false;
+    int cause = -1; // SafetyCheck that tripped
+    int fallback = SAFETY_FALLBACK_DAMPING;
+    SafetyCheckReport checks[SAFETY_NUM_CHECKS];
+};
+
+/**
+ * @brief Joint, torque, attitude and command checks of every control tick, with a latched fallback.
+ *
+ * Update() runs on the control thread between the state machine and the transport and only reads
+ * flat arrays against limits resolved once by Configure(): the joint position and velocity limits
+ * of the URDF, the torque limits of the config and the thresholds of base.yaml's safety section.
+ * A check trips after its ticks consecutive violations and clears after as many clean ticks, so a
+ * single noisy sample neither trips nor resets it. The first trip latches: from then on Hold()
+ * overrides the command until the fallback state has taken over, and only Rearm() releases it.
+ * Update() does not allocate or print; violations are collected per check and published at most
+ * once per report_period, the trip itself at once, for Read() on another thread.
+ */
+class SafetySupervisor
+{
+public:
+    // resolves the limits against the order RobotState uses, empty string on success; gains and
+    // torque limits are the running config's, kinematics may be nullptr without joint checks
+    std::string Configure(const SafetyConfig &config, const std::vector<std::string> &joint_names, const double *fixed_kp,
+                          const double *fixed_kd, const double *torque_limits, const RobotKinematics *kinematics);
+    bool Configured() const { return this->config.enabled != 0; }
+
+    // true while tripped
+    bool Update(const SafetyInput &input);
+    bool Tripped() const { return this->tripped; }
+    SafetyFallback Fallback() const { return static_cast<SafetyFallback>(this->config.fallback); }
+    void Rearm();
+
+    // the command of the fallback until its state runs: damping lets the joints go with the
+    // fixed damping, get-down holds them where they are
+    void Hold(const double *q, double *q_target, double *dq_target, double *kp, double *kd, double *tau) const;
+
+    // single consumer, returns true if a newer report is available
+    bool Read(SafetyReport &report)
+    {
+        if (!this->reports.Update())
+        {
+            return false;
+        }
+        report = this->reports.Front();
+        return true;
+    }
+
+    static const char *CheckName(int check);
+
+private:
+    struct Limit
+    {
+        bool over;
+        double value;
+        double limit;
+        int index;
+    };
+    // the worst offender of this tick, over is false when everything is within the limits
+    Limit JointPosition(const SafetyInput &input) const;
+    Limit JointVelocity(const SafetyInput &input) const;
+    Limit Torque(const SafetyInput &input) const;
+    Limit Attitude(const SafetyInput &input) const;
+    Limit NonFinite(const SafetyInput &input) const;
+    void Count(int check, const Limit &limit);
+    void Publish(std::chrono::steady_clock::time_point now);
+
+    SafetyConfig config = {};
+    int num_joints = 0;
+    char joint_names[CONFIG_MAX_DOFS][CONFIG_NAME_SIZE];
+    double position_lower[CONFIG_MAX_DOFS];
+    double position_upper[CONFIG_MAX_DOFS];
+    double velocity_limits[CONFIG_MAX_DOFS]; // 0 when unchecked
+    double torque_limits[CONFIG_MAX_DOFS];
+    double fixed_kp[CONFIG_MAX_DOFS];
+    double fixed_kd[CONFIG_MAX_DOFS];
+
+    // control thread only
+    bool tripped = false;
+    int cause = -1;
+    bool was_policy = false;
+    std::chrono::steady_clock::time_point policy_start;
+    std::chrono::steady_clock::time_point last_update;
+    int violations[SAFETY_NUM_CHECKS] = {}; // consecutive
+    int clean[SAFETY_NUM_CHECKS] = {};      // consecutive
+    SafetyCheckReport window[SAFETY_NUM_CHECKS];
+    std::chrono::steady_clock::time_point last_report;
+    bool trip_pending = false;
+    TripleBuffer<SafetyReport> reports;
+};
+
+#endif // SAFETY_SUPERVISOR_HPP
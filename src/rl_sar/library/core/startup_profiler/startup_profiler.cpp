@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "startup_profiler.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <unistd.h>
+
+StartupProfiler &StartupProfiler::Instance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+StartupProfiler::StartupProfiler() : process_start(ProcessStart())
+{
+    // whatever ran before the first use, mostly the loader and static initializers
+    this->Record("process start", this->process_start, std::chrono::steady_clock::now());
+}
+
+std::chrono::steady_clock::time_point StartupProfiler::ProcessStart()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    // field 22 of /proc/self/stat is the start time in clock ticks since boot, the fields
+    // are counted after the command name, which may itself contain spaces and parentheses
+    std::ifstream file("/proc/self/stat");
+    std::string stat((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t comm_end = stat.rfind(')');
+    unsigned long long start_ticks = 0;
+    struct timespec boot;
+    if (comm_end == std::string::npos ||
+        sscanf(stat.c_str() + comm_end + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &start_ticks) != 1 ||
+        clock_gettime(CLOCK_BOOTTIME, &boot) != 0)
+    {
+        return now;
+    }
+    const double age = boot.tv_sec + boot.tv_nsec * 1e-9 - static_cast<double>(start_ticks) / sysconf(_SC_CLK_TCK);
+    if (age < 0.0)
+    {
+        return now;
+    }
+    return now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(age));
+}
+
+void StartupProfiler::Record(const std::string &name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    const std::thread::id id = std::this_thread::get_id();
+    std::vector<std::thread::id>::iterator it = std::find(this->threads.begin(), this->threads.end(), id);
+    if (it == this->threads.end())
+    {
+        it = this->threads.insert(it, id);
+    }
+    this->phases.push_back({name, begin, end, static_cast<int>(it - this->threads.begin())});
+}
+
+void StartupProfiler::RecordNs(const char *name, int64_t begin_ns, int64_t end_ns)
+{
+    typedef std::chrono::steady_clock::time_point TimePoint;
+    Instance().Record(name ? name : "", TimePoint(std::chrono::nanoseconds(begin_ns)), TimePoint(std::chrono::nanoseconds(end_ns)));
+}
+
+void StartupProfiler::Report(const std::string &milestone)
+{
+    const std::chrono::steady_clock::time_point ready = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->reported)
+    {
+        return;
+    }
+    this->reported = true;
+
+    std::vector<Phase> sorted = this->phases;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Phase &a, const Phase &b) { return a.begin < b.begin; });
+
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+    const double total = Milliseconds(ready - this->process_start).count();
+    const int width = 40;
+    double serial = 0.0;
+    std::cout << LOGGER::INFO << "Ready (" << milestone << ") " << static_cast<int>(total) << "ms after process start" << std::endl;
+    std::cout << "     start  duration thread  timeline" << std::endl;
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        const Phase &phase = sorted[i];
+        const double start = Milliseconds(phase.begin - this->process_start).count();
+        const double duration = Milliseconds(phase.end - phase.begin).count();
+        // a phase inside an earlier one on the same thread is a detail of it, not extra work
+        bool nested = false;
+        for (size_t j = 0; j < i && !nested; ++j)
+        {
+            nested = sorted[j].thread == phase.thread && sorted[j].end >= phase.end;
+        }
+        if (!nested)
+        {
+            serial += duration;
+        }
+        // one character per 1/width of the time to ready, at least one per phase
+        char bar[width + 1];
+        memset(bar, ' ', width);
+        bar[width] = '\0';
+        int first = std::max(0, std::min(width - 1, static_cast<int>(start / total * width)));
+        int last = std::max(first, std::min(width - 1, static_cast<int>((start + duration) / total * width)));
+        memset(bar + first, '#', last - first + 1);
+        char line[256];
+        snprintf(line, sizeof(line), "  %6.0fms  %6.0fms %6d  |%s| %s", start, duration, phase.thread, bar, ((nested ? "  " : "") + phase.name).c_str());
+        std::cout << line << std::endl;
+    }
+    std::cout << LOGGER::INFO << "Startup phases take " << static_cast<int>(serial) << "ms one after another, " << static_cast<int>(total) << "ms wall clock" << std::endl;
+}
+
+void StartupTasks::Add(const std::string &name, const std::vector<std::string> &after, std::function<void()> step)
+{
+    Task task;
+    task.name = name;
+    task.step = std::move(step);
+    for (const std::string &dependency : after)
+    {
+        std::vector<Task>::const_iterator it = std::find_if(this->tasks.begin(), this->tasks.end(), [&](const Task &t) { return t.name == dependency; });
+        if (it == this->tasks.end())
+        {
+            throw std::logic_error("startup step " + name + " depends on " + dependency + ", which was not added before it");
+        }
+        task.after.push_back(it - this->tasks.begin());
+    }
+    this->tasks.push_back(std::move(task));
+}
+
+void StartupTasks::Run()
+{
+    // RL_SAR_SERIAL_STARTUP=1 runs the steps one after another in the order they were added, on
+    // this thread, for comparing the time to ready against the concurrent bring-up
+    const char *serial = getenv("RL_SAR_SERIAL_STARTUP");
+    if (serial && std::string(serial) == "1")
+    {
+        std::vector<Task> tasks;
+        tasks.swap(this->tasks);
+        for (const Task &task : tasks)
+        {
+            StartupPhase phase(task.name);
+            task.step();
+        }
+        return;
+    }
+    std::vector<std::shared_future<void>> done;
+    done.reserve(this->tasks.size());
+    for (const Task &task : this->tasks)
+    {
+        std::vector<std::shared_future<void>> after;
+        for (size_t index : task.after)
+        {
+            after.push_back(done[index]);
+        }
+        done.push_back(std::async(std::launch::async, [after, &task]()
+        {
+            for (const std::shared_future<void> &dependency : after)
+            {
+                dependency.get();
+            }
+            StartupPhase phase(task.name);
+            task.step();
+        }).share());
+    }
+    for (const std::shared_future<void> &step : done)
+    {
+        step.wait();
+    }
+    this->tasks.clear();
+    for (const std::shared_future<void> &step : done)
+    {
+        step.get();
+    }
+}
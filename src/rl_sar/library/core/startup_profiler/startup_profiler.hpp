@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef STARTUP_PROFILER_HPP
+#define STARTUP_PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Time-to-ready breakdown of the runtime's startup.
+ *
+ * Phases are recorded with their thread, so overlapping phases show up as such in Report().
+ * Times are relative to the moment the kernel started the process (/proc/self/stat), which
+ * also accounts for the dynamic loader and the shared library constructors of libtorch and
+ * the robot SDKs that run before main(). Recording takes a mutex and is meant for startup
+ * only, the control loops use the Tracer instead.
+ */
+class StartupProfiler
+{
+public:
+    static StartupProfiler &Instance();
+
+    void Record(const std::string &name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end);
+    // C callback for backend plugins (rl_backend_config::startup_phase), steady_clock nanoseconds
+    static void RecordNs(const char *name, int64_t begin_ns, int64_t end_ns);
+
+    // marks the runtime as ready and prints every phase recorded so far; later calls do nothing
+    void Report(const std::string &milestone);
+
+private:
+    struct Phase
+    {
+        std::string name;
+        std::chrono::steady_clock::time_point begin;
+        std::chrono::steady_clock::time_point end;
+        int thread; // order in which threads recorded their first phase, 0 is the first one seen
+    };
+
+    StartupProfiler();
+    static std::chrono::steady_clock::time_point ProcessStart();
+
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point process_start;
+    std::vector<Phase> phases;
+    std::vector<std::thread::id> threads;
+    bool reported = false;
+};
+
+// records the enclosing scope as a startup phase
+class StartupPhase
+{
+public:
+    explicit StartupPhase(const std::string &name) : name(name), begin(std::chrono::steady_clock::now()) {}
+    ~StartupPhase() { StartupProfiler::Instance().Record(this->name, this->begin, std::chrono::steady_clock::now()); }
+    StartupPhase(const StartupPhase &) = delete;
+    StartupPhase &operator=(const StartupPhase &) = delete;
+
+private:
+    std::string name;
+    std::chrono::steady_clock::time_point begin;
+};
+
+/**
+ * @brief Startup steps with explicit dependencies, run concurrently.
+ *
+ * Add() registers a step together with the steps it has to wait for, which must have been
+ * added before, so the graph cannot have cycles. Run() starts every step on its own thread,
+ * each one first waits for its dependencies and is then recorded as a startup phase. Run()
+ * returns once all steps finished and rethrows the first failure in the order the steps were
+ * added; steps that depend on a failed one fail with the same exception without running.
+ */
+class StartupTasks
+{
+public:
+    void Add(const std::string &name, const std::vector<std::string> &after, std::function<void()> step);
+    void Run();
+
+private:
+    struct Task
+    {
+        std::string name;
+        std::vector<size_t> after;
+        std::function<void()> step;
+    };
+    std::vector<Task> tasks;
+};
+
+#endif // STARTUP_PROFILER_HPP
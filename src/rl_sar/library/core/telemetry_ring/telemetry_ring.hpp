@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_RING_HPP
+#define TELEMETRY_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Shared-memory layout read by scripts/telemetry_viewer.py, keep both in sync.
+ *
+ *   TelemetryHeader                       offset 0, TELEMETRY_HEADER_SIZE bytes
+ *   TelemetrySample slots[capacity]       offset TELEMETRY_HEADER_SIZE, sample_size bytes each
+ *
+ * Sample n lives in slots[n % capacity]. Its seq is 2n+1 while the writer fills it and 2n+2
+ * once complete, so a reader copying a slot accepts it only if seq was 2n+2 before and after
+ * the copy. head is the number of samples completed. All values are in policy joint order.
+ */
+
+#define TELEMETRY_RING_NAME "/rl_sar_telemetry"
+#define TELEMETRY_MAGIC 0x4c54524c // "LRTL"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_MAX_JOINTS 32
+#define TELEMETRY_NAME_SIZE 32
+#define TELEMETRY_HEADER_SIZE 1088
+
+struct TelemetryHeader
+{
+    std::atomic<uint32_t> magic;                                 // 0, written last on creation
+    uint32_t version;                                            // 4
+    uint32_t num_joints;                                         // 8
+    uint32_t capacity;                                           // 12, samples, power of two
+    uint32_t sample_size;                                        // 16, bytes per slot
+    uint32_t pid;                                                // 20, writer process, changes on restart
+    double dt;                                                   // 24, seconds between samples
+    std::atomic<uint64_t> head;                                  // 32
+    uint8_t padding[24];                                         // 40
+    char joint_names[TELEMETRY_MAX_JOINTS][TELEMETRY_NAME_SIZE]; // 64
+};
+
+struct TelemetryData
+{
+    uint64_t tick;                          // 8, control step counter
+    double time;                            // 16, seconds since the ring was opened
+    int32_t control_state;                  // 24, STATE_* requested by the user
+    int32_t reserved;                       // 28
+    float q[TELEMETRY_MAX_JOINTS];          // 32
+    float dq[TELEMETRY_MAX_JOINTS];         // 160
+    float tau_est[TELEMETRY_MAX_JOINTS];    // 288
+    float q_target[TELEMETRY_MAX_JOINTS];   // 416
+    float dq_target[TELEMETRY_MAX_JOINTS];  // 544
+    float tau_target[TELEMETRY_MAX_JOINTS]; // 672
+};
+
+struct alignas(64) TelemetrySample
+{
+    std::atomic<uint64_t> seq; // 0
+    TelemetryData data;        // 8, offsets above are from the start of the sample
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == 8 && sizeof(std::atomic<uint32_t>) == 4, "telemetry atomics must be plain words");
+static_assert(offsetof(TelemetryHeader, head) == 32 && offsetof(TelemetryHeader, joint_names) == 64, "telemetry header layout changed");
+static_assert(sizeof(TelemetryHeader) == TELEMETRY_HEADER_SIZE, "telemetry header layout changed");
+static_assert(offsetof(TelemetrySample, data) == 8 && offsetof(TelemetryData, tau_target) == 664, "telemetry sample layout changed");
+static_assert(sizeof(TelemetrySample) == 832, "telemetry sample layout changed");
+
+/**
+ * @brief Lock-free single-writer ring of controller samples in POSIX shared memory.
+ *
+ * The control thread fills Back() and calls Publish(), which costs a copy into the mapping
+ * and two stores: no syscall, lock or allocation. Viewers map the same object read-only and
+ * render at their own pace; a viewer that falls behind by more than the capacity simply
+ * skips samples, the writer never waits. The object is private to the user running the
+ * controller. Open() replaces any object left under the name instead of resizing it under a
+ * viewer's mapping, and Close() clears the magic and unlinks it, so an attached viewer keeps a
+ * valid mapping, sees the cleared magic and attaches again once a controller is back.
+ */
+class TelemetryRing
+{
+public:
+    TelemetryRing() {}
+    ~TelemetryRing() { this->Close(); }
+
+    bool Open(const std::vector<std::string> &joint_names, double dt, uint32_t capacity = 1024, const std::string &name = TELEMETRY_RING_NAME)
+    {
+        this->Close();
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0 || joint_names.size() > TELEMETRY_MAX_JOINTS)
+        {
+            return false;
+        }
+        this->size = TELEMETRY_HEADER_SIZE + static_cast<size_t>(capacity) * sizeof(TelemetrySample);
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        if (ftruncate(fd, this->size) != 0 || fstat(fd, &st) != 0)
+        {
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        void *addr = mmap(nullptr, this->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+            return false;
+        }
+        this->name = name;
+        this->inode = st.st_ino;
+
+        this->header = static_cast<TelemetryHeader *>(addr);
+        this->slots = reinterpret_cast<TelemetrySample *>(static_cast<uint8_t *>(addr) + TELEMETRY_HEADER_SIZE);
+        this->header->magic.store(0, std::memory_order_release);
+        this->header->version = TELEMETRY_VERSION;
+        this->header->num_joints = joint_names.size();
+        this->header->capacity = capacity;
+        this->header->sample_size = sizeof(TelemetrySample);
+        this->header->pid = getpid();
+        this->header->dt = dt;
+        memset(this->header->joint_names, 0, sizeof(this->header->joint_names));
+        for (size_t i = 0; i < joint_names.size(); ++i)
+        {
+            strncpy(this->header->joint_names[i], joint_names[i].c_str(), TELEMETRY_NAME_SIZE - 1);
+        }
+        for (uint32_t i = 0; i < capacity; ++i)
+        {
+            this->slots[i].seq.store(0, std::memory_order_relaxed);
+        }
+        this->header->head.store(0, std::memory_order_relaxed);
+        this->header->magic.store(TELEMETRY_MAGIC, std::memory_order_release);
+
+        this->mask = capacity - 1;
+        this->count = 0;
+        memset(&this->back, 0, sizeof(this->back));
+        return true;
+    }
+
+    void Close()
+    {
+        if (this->header)
+        {
+            this->header->magic.store(0, std::memory_order_release);
+            munmap(this->header, this->size);
+            // a controller started since may own the name by now, leave its object alone
+            int fd = shm_open(this->name.c_str(), O_RDONLY, 0);
+            if (fd >= 0)
+            {
+                struct stat st;
+                const bool own = fstat(fd, &st) == 0 && st.st_ino == this->inode;
+                close(fd);
+                if (own)
+                {
+                    shm_unlink(this->name.c_str());
+                }
+            }
+            this->header = nullptr;
+            this->slots = nullptr;
+        }
+    }
+
+    bool IsOpen() const { return this->header != nullptr; }
+
+    // Sample to fill before Publish(), private to the writer
+    TelemetryData &Back() { return this->back; }
+
+    void Publish()
+    {
+        if (!this->header)
+        {
+            return;
+        }
+        TelemetrySample &slot = this->slots[this->count & this->mask];
+        slot.seq.store(2 * this->count + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&slot.data, &this->back, sizeof(TelemetryData));
+        slot.seq.store(2 * this->count + 2, std::memory_order_release);
+        this->header->head.store(++this->count, std::memory_order_release);
+    }
+
+private:
+    TelemetryHeader *header = nullptr;
+    TelemetrySample *slots = nullptr;
+    TelemetryData back;
+    std::string name;
+    ino_t inode = 0;
+    size_t size = 0;
+    uint64_t mask = 0;
+    uint64_t count = 0;
+};
+
+#endif // TELEMETRY_RING_HPP
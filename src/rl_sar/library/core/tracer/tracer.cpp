@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "tracer.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+std::atomic<bool> Tracer::enabled{false};
+thread_local Tracer::ThreadBuffer *Tracer::thread_buffer = nullptr;
+sem_t Tracer::signal_sem;
+
+Tracer &Tracer::Instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::ThreadBuffer *Tracer::RegisterThread()
+{
+    std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer(thread_capacity));
+    buffer->tid = syscall(SYS_gettid);
+    char name[16] = {};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 && name[0])
+    {
+        buffer->thread_name = name;
+    }
+    else
+    {
+        buffer->thread_name = "thread " + std::to_string(buffer->tid);
+    }
+
+    Tracer &tracer = Instance();
+    std::lock_guard<std::mutex> lock(tracer.buffers_mutex);
+    tracer.buffers.push_back(std::move(buffer));
+    return tracer.buffers.back().get();
+}
+
+uint64_t Tracer::Begin()
+{
+    if (!thread_buffer)
+    {
+        thread_buffer = RegisterThread();
+    }
+    // pairs with Stop(): either it sees the open scope and waits, or this sees tracing off
+    thread_buffer->open.fetch_add(1, std::memory_order_seq_cst);
+    if (!enabled.load(std::memory_order_seq_cst))
+    {
+        thread_buffer->open.fetch_sub(1, std::memory_order_release);
+        return 0;
+    }
+    return Now();
+}
+
+void Tracer::Record(const char *name, uint64_t begin, uint64_t end)
+{
+    uint64_t index = thread_buffer->head.load(std::memory_order_relaxed);
+    TraceEvent &event = thread_buffer->events[index & (thread_capacity - 1)];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    thread_buffer->head.store(index + 1, std::memory_order_release);
+    thread_buffer->open.fetch_sub(1, std::memory_order_release);
+}
+
+void Tracer::Start()
+{
+    std::lock_guard<std::mutex> lock(this->buffers_mutex);
+    for (auto &buffer : this->buffers)
+    {
+        buffer->start = buffer->head.load(std::memory_order_acquire);
+    }
+    this->start_time = std::chrono::steady_clock::now();
+    this->start_ticks = Now();
+    enabled.store(true, std::memory_order_release);
+}
+
+bool Tracer::Stop(const std::string &path)
+{
+    enabled.store(false, std::memory_order_seq_cst);
+    std::unique_lock<std::mutex> lock(this->buffers_mutex);
+    // scopes that began before tracing stopped still record, wait for them
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    for (auto &buffer : this->buffers)
+    {
+        while (buffer->open.load(std::memory_order_seq_cst) != 0)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                // a thread blocked inside a scope, its ring is dumped as it is
+                std::cout << LOGGER::WARNING << "Tracer: " << buffer->thread_name << " is still inside a trace scope" << std::endl;
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    uint64_t stop_ticks = Now();
+    std::chrono::steady_clock::time_point stop_time = std::chrono::steady_clock::now();
+    double elapsed_us = std::chrono::duration<double, std::micro>(stop_time - this->start_time).count();
+    double ticks_per_us = elapsed_us > 0.0 ? (stop_ticks - this->start_ticks) / elapsed_us : 1.0;
+
+    std::ofstream file(path.c_str());
+    if (!file)
+    {
+        return false;
+    }
+    const long pid = getpid();
+    char line[256];
+    bool first = true;
+    auto separator = [&]() -> const char * { const char *s = first ? "\n" : ",\n"; first = false; return s; };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (auto &buffer : this->buffers)
+    {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = std::max(buffer->start, head > thread_capacity ? head - thread_capacity : 0);
+        if (begin == head)
+        {
+            continue;
+        }
+        file << separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+             << ",\"args\":{\"name\":\"" << buffer->thread_name << "\"}}";
+        for (uint64_t i = begin; i < head; ++i)
+        {
+            const TraceEvent &event = buffer->events[i & (thread_capacity - 1)];
+            snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%ld,\"tid\":%ld,\"ts\":%.3f,\"dur\":%.3f}",
+                     event.name, pid, buffer->tid,
+                     (static_cast<int64_t>(event.begin - this->start_ticks)) / ticks_per_us,
+                     (event.end - event.begin) / ticks_per_us);
+            file << separator() << line;
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+void Tracer::OnSignal(int)
+{
+    int saved_errno = errno;
+    sem_post(&signal_sem);
+    errno = saved_errno;
+}
+
+void Tracer::SignalLoop()
+{
+    while (true)
+    {
+        if (sem_wait(&signal_sem) != 0)
+        {
+            continue;
+        }
+        if (!Enabled())
+        {
+            this->Start();
+            std::cout << LOGGER::INFO << "Tracer recording" << std::endl;
+        }
+        else
+        {
+            std::string path = "/tmp/rl_sar_trace_" + std::to_string(getpid()) + "_" + std::to_string(this->dump_count++) + ".json";
+            if (this->Stop(path))
+            {
+                std::cout << LOGGER::INFO << "Trace written to " << path << std::endl;
+            }
+            else
+            {
+                std::cout << LOGGER::ERROR << "Cannot write trace " << path << std::endl;
+            }
+        }
+    }
+}
+
+void Tracer::InstallSignalHandler(int signum)
+{
+    if (this->signal_installed)
+    {
+        return;
+    }
+    this->signal_installed = true;
+    sem_init(&signal_sem, 0, 0);
+    std::thread(&Tracer::SignalLoop, this).detach();
+    signal(signum, &Tracer::OnSignal);
+    std::cout << LOGGER::INFO << "kill -" << (signum == SIGUSR1 ? "USR1" : std::to_string(signum)) << " " << getpid() << " starts and stops a trace" << std::endl;
+}
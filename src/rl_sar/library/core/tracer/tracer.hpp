@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <semaphore.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+struct TraceEvent
+{
+    const char *name; // must outlive the dump, trace points use string literals
+    uint64_t begin;   // Tracer::Now() ticks
+    uint64_t end;
+};
+
+/**
+ * @brief Timeline tracer for the control and inference loops.
+ *
+ * TRACE_SCOPE("name") records one complete event per scope into a ring owned by the calling
+ * thread, timestamped with the cycle counter, so recording takes no lock and makes no
+ * syscall. While tracing is off a scope costs a relaxed load and a predicted branch. A
+ * thread's ring is allocated the first time it records; when it wraps, the oldest events
+ * are dropped. Each ring counts the scopes open on its thread, so Stop() waits for the
+ * ones that began before it instead of reading a ring that is still being written.
+ *
+ * Start() begins a recording and Stop() writes it as Chrome trace-event JSON, which
+ * chrome://tracing and ui.perfetto.dev open directly. With InstallSignalHandler() the same
+ * signal alternately starts and stops a recording; each stop writes a new file.
+ */
+class Tracer
+{
+public:
+    static Tracer &Instance();
+
+    static bool Enabled() { return __builtin_expect(enabled.load(std::memory_order_relaxed), 0); }
+
+    static uint64_t Now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    // Begin() returns 0 when tracing stopped in the meantime, otherwise Record() must follow
+    static uint64_t Begin();
+    static void Record(const char *name, uint64_t begin, uint64_t end);
+
+    void Start();
+    bool Stop(const std::string &path);
+    void InstallSignalHandler(int signum = SIGUSR1);
+
+private:
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(size_t capacity) : events(capacity) {}
+        std::vector<TraceEvent> events;
+        std::atomic<uint64_t> head{0}; // events recorded by the owning thread
+        std::atomic<uint32_t> open{0}; // scopes begun and not yet recorded
+        uint64_t start = 0;            // head when the current recording started
+        long tid = 0;
+        std::string thread_name;
+    };
+
+    Tracer() {}
+    static ThreadBuffer *RegisterThread();
+    static void OnSignal(int);
+    void SignalLoop();
+
+    static const size_t thread_capacity = 1 << 14; // power of two
+    static std::atomic<bool> enabled;
+    static thread_local ThreadBuffer *thread_buffer;
+    static sem_t signal_sem;
+
+    std::mutex buffers_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    uint64_t start_ticks = 0;
+    std::chrono::steady_clock::time_point start_time;
+    bool signal_installed = false;
+    int dump_count = 0;
+};
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name) : name(name), begin(Tracer::Enabled() ? Tracer::Begin() : 0) {}
+    ~TraceScope()
+    {
+        if (this->begin)
+        {
+            Tracer::Record(this->name, this->begin, Tracer::Now());
+        }
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;
+    uint64_t begin;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+#endif // TRACER_HPP
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+/**
+ * @brief Lock-free single-producer/single-consumer triple buffer.
+ *
+ * The producer fills Back() and calls Publish(); the consumer calls Read() and
+ * always gets the latest complete snapshot. Neither side ever blocks or sees a
+ * partially written value, and T is never allocated after construction.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : back(0), latest(1), front(2) {}
+
+    // producer
+    T &Back() { return buffers[back].value; }
+
+    void Publish()
+    {
+        back = latest.exchange(back | dirty_flag, std::memory_order_acq_rel) & index_mask;
+    }
+
+    void Write(const T &value)
+    {
+        Back() = value;
+        Publish();
+    }
+
+    // consumer, returns true if a newer snapshot was swapped in
+    bool Update()
+    {
+        if (!(latest.load(std::memory_order_relaxed) & dirty_flag))
+        {
+            return false;
+        }
+        front = latest.exchange(front, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+
+    const T &Front() const { return buffers[front].value; }
+
+    const T &Read()
+    {
+        Update();
+        return Front();
+    }
+
+private:
+    static constexpr int dirty_flag = 0x4;
+    static constexpr int index_mask = 0x3;
+
+    struct alignas(64) Slot
+    {
+        T value{};
+    };
+
+    Slot buffers[3];
+    alignas(64) int back;
+    alignas(64) std::atomic<int> latest;
+    alignas(64) int front;
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "velocity_estimator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const double gravity = 9.81;
+    // chi-square of 3 degrees of freedom at 0.999, a standing foot passes it almost always
+    const double gate = 16.27;
+    // after this many ticks without an accepted leg the filter trusts the legs again, e.g. after
+    // the simulation was reset under it
+    const int max_rejected_ticks = 50;
+
+    void Rotation(const double quaternion[4], double R[3][3])
+    {
+        double w = quaternion[0], x = quaternion[1], y = quaternion[2], z = quaternion[3];
+        const double norm = std::sqrt(w * w + x * x + y * y + z * z);
+        if (norm > 0.0)
+        {
+            w /= norm;
+            x /= norm;
+            y /= norm;
+            z /= norm;
+        }
+        else
+        {
+            w = 1.0;
+        }
+        R[0][0] = 1.0 - 2.0 * (y * y + z * z);
+        R[0][1] = 2.0 * (x * y - w * z);
+        R[0][2] = 2.0 * (x * z + w * y);
+        R[1][0] = 2.0 * (x * y + w * z);
+        R[1][1] = 1.0 - 2.0 * (x * x + z * z);
+        R[1][2] = 2.0 * (y * z - w * x);
+        R[2][0] = 2.0 * (x * z - w * y);
+        R[2][1] = 2.0 * (y * z + w * x);
+        R[2][2] = 1.0 - 2.0 * (x * x + y * y);
+    }
+
+    void Rotate(const double R[3][3], const double v[3], double out[3])
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            out[i] = R[i][0] * v[0] + R[i][1] * v[1] + R[i][2] * v[2];
+        }
+    }
+
+    void RotateInverse(const double R[3][3], const double v[3], double out[3])
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            out[i] = R[0][i] * v[0] + R[1][i] * v[1] + R[2][i] * v[2];
+        }
+    }
+}
+
+std::string VelocityEstimator::Configure(const VelocityEstimatorConfig &config, const std::vector<std::string> &joint_names,
+                                        const RobotKinematics *kinematics)
+{
+    this->num_legs = 0;
+    this->config = config;
+    this->kinematics = nullptr;
+    if (!kinematics)
+    {
+        return "base.yaml has a kinematics section, but the kinematics were not generated for this build";
+    }
+    const int n = kinematics->num_joints;
+    if (n > CONFIG_MAX_DOFS || kinematics->num_end_effectors > KINEMATICS_MAX_END_EFFECTORS)
+    {
+        return std::string("the kinematics of ") + kinematics->robot_name + " are too large";
+    }
+    for (int j = 0; j < n; ++j)
+    {
+        std::vector<std::string>::const_iterator it = std::find(joint_names.begin(), joint_names.end(), kinematics->joint_names[j]);
+        if (it == joint_names.end())
+        {
+            return std::string("the running config has no joint ") + kinematics->joint_names[j];
+        }
+        this->kinematics_joints[j] = it - joint_names.begin();
+    }
+    // a leg's foot is the end effector its calf moves
+    for (int i = 0; i < config.num_legs; ++i)
+    {
+        const int calf = std::find_if(kinematics->joint_names, kinematics->joint_names + n,
+                                      [&](const char *name) { return std::string(name) == config.joints[i][2]; }) - kinematics->joint_names;
+        this->feet[i] = -1;
+        for (int e = 0; e < kinematics->num_end_effectors && calf < n; ++e)
+        {
+            if (kinematics->chains[e * n + calf])
+            {
+                this->feet[i] = e;
+                break;
+            }
+        }
+        if (this->feet[i] < 0)
+        {
+            return std::string("no end effector of the generated kinematics is moved by ") + config.joints[i][2];
+        }
+    }
+    this->kinematics = kinematics;
+    this->num_legs = config.num_legs;
+    return "";
+}
+
+void VelocityEstimator::Reset()
+{
+    memset(this->state, 0, sizeof(this->state));
+    memset(this->covariance, 0, sizeof(this->covariance));
+    for (int i = 0; i < 3; ++i)
+    {
+        this->covariance[i][i] = 1.0;      // (1 m/s)^2, the robot may already be moving
+        this->covariance[i + 3][i + 3] = 0.01; // (0.1 m/s^2)^2
+    }
+    memset(this->velocity, 0, sizeof(this->velocity));
+    this->contacts = 0;
+    this->rejected_ticks = 0;
+}
+
+void VelocityEstimator::Feet(const double *q, const double *dq, double positions[][3], double velocities[][3])
+{
+    for (int j = 0; j < this->kinematics->num_joints; ++j)
+    {
+        this->kinematics_q[j] = q[this->kinematics_joints[j]];
+        this->kinematics_dq[j] = dq[this->kinematics_joints[j]];
+    }
+    this->kinematics->positions(this->kinematics_q, this->end_effector_positions);
+    this->kinematics->velocities(this->kinematics_q, this->kinematics_dq, this->end_effector_velocities);
+    for (int leg = 0; leg < this->num_legs; ++leg)
+    {
+        memcpy(positions[leg], this->end_effector_positions + 3 * this->feet[leg], 3 * sizeof(double));
+        memcpy(velocities[leg], this->end_effector_velocities + 3 * this->feet[leg], 3 * sizeof(double));
+    }
+}
+
+void VelocityEstimator::Correct(int axis, double measurement, double variance)
+{
+    // scalar update with H selecting one velocity axis
+    const double innovation = measurement - this->state[axis];
+    const double s = this->covariance[axis][axis] + variance;
+    double gain[6];
+    for (int i = 0; i < 6; ++i)
+    {
+        gain[i] = this->covariance[i][axis] / s;
+        this->state[i] += gain[i] * innovation;
+    }
+    double row[6];
+    memcpy(row, this->covariance[axis], sizeof(row));
+    for (int i = 0; i < 6; ++i)
+    {
+        for (int j = 0; j < 6; ++j)
+        {
+            this->covariance[i][j] -= gain[i] * row[j];
+        }
+    }
+}
+
+void VelocityEstimator::Update(const double quaternion[4], const double gyroscope[3], const double accelerometer[3], const double *q, const double *dq, double dt)
+{
+    if (this->num_legs == 0 || !(dt > 0.0))
+    {
+        return;
+    }
+    double R[3][3];
+    Rotation(quaternion, R);
+    double omega[3];
+    if (this->world_gyroscope)
+    {
+        RotateInverse(R, gyroscope, omega);
+    }
+    else
+    {
+        memcpy(omega, gyroscope, sizeof(omega));
+    }
+
+    // predict: v += (R (f - b) + g) dt, the bias is a random walk
+    double force[3] = {accelerometer[0] - this->state[3], accelerometer[1] - this->state[4], accelerometer[2] - this->state[5]};
+    double acceleration[3];
+    Rotate(R, force, acceleration);
+    acceleration[2] -= gravity;
+    for (int i = 0; i < 3; ++i)
+    {
+        this->state[i] += acceleration[i] * dt;
+    }
+    // P = F P F^T + Q with F = [I, M; 0, I], M = -R dt, in blocks A (velocity), B (cross), C (bias)
+    double M[3][3], MC[3][3], B[3][3];
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            M[i][j] = -R[i][j] * dt;
+            B[i][j] = this->covariance[i][j + 3];
+        }
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            MC[i][j] = M[i][0] * this->covariance[3][j + 3] + M[i][1] * this->covariance[4][j + 3] + M[i][2] * this->covariance[5][j + 3];
+        }
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            double a = 0.0;
+            for (int k = 0; k < 3; ++k)
+            {
+                a += M[i][k] * B[j][k] + B[i][k] * M[j][k] + MC[i][k] * M[j][k];
+            }
+            this->covariance[i][j] += a;
+            this->covariance[i][j + 3] = B[i][j] + MC[i][j];
+            this->covariance[j + 3][i] = this->covariance[i][j + 3];
+        }
+    }
+    const double velocity_noise = this->config.accelerometer_noise * dt;
+    for (int i = 0; i < 3; ++i)
+    {
+        this->covariance[i][i] += velocity_noise * velocity_noise;
+        this->covariance[i + 3][i + 3] += this->config.bias_noise * this->config.bias_noise * dt;
+    }
+
+    // measure: a standing foot does not move, so v = -R (w x p + dp) for each of them
+    double measurements[CONFIG_MAX_LEGS][3];
+    double heights[CONFIG_MAX_LEGS];
+    double lowest = 0.0;
+    double positions[CONFIG_MAX_LEGS][3], foot_velocities[CONFIG_MAX_LEGS][3];
+    this->Feet(q, dq, positions, foot_velocities);
+    for (int leg = 0; leg < this->num_legs; ++leg)
+    {
+        const double *position = positions[leg], *foot_velocity = foot_velocities[leg];
+        double relative[3];
+        relative[0] = omega[1] * position[2] - omega[2] * position[1] + foot_velocity[0];
+        relative[1] = omega[2] * position[0] - omega[0] * position[2] + foot_velocity[1];
+        relative[2] = omega[0] * position[1] - omega[1] * position[0] + foot_velocity[2];
+        Rotate(R, relative, measurements[leg]);
+        for (int i = 0; i < 3; ++i)
+        {
+            measurements[leg][i] = -measurements[leg][i];
+        }
+        heights[leg] = R[2][0] * position[0] + R[2][1] * position[1] + R[2][2] * position[2];
+        lowest = leg == 0 ? heights[leg] : std::min(lowest, heights[leg]);
+    }
+    const double variance = this->config.foot_velocity_noise * this->config.foot_velocity_noise;
+    const bool gated = this->rejected_ticks < max_rejected_ticks;
+    this->contacts = 0;
+    for (int leg = 0; leg < this->num_legs; ++leg)
+    {
+        if (heights[leg] > lowest + this->config.contact_height)
+        {
+            continue;
+        }
+        double distance = 0.0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const double innovation = measurements[leg][i] - this->state[i];
+            distance += innovation * innovation / (this->covariance[i][i] + variance);
+        }
+        if (gated && distance > gate)
+        {
+            continue;
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            this->Correct(i, measurements[leg][i], variance);
+        }
+        this->contacts++;
+    }
+    this->rejected_ticks = this->contacts > 0 ? 0 : this->rejected_ticks + 1;
+
+    RotateInverse(R, this->state, this->velocity);
+}
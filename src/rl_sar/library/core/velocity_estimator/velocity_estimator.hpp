@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VELOCITY_ESTIMATOR_HPP
+#define VELOCITY_ESTIMATOR_HPP
+
+#include <string>
+#include <vector>
+#include "config_bundle.hpp"
+#include "robot_kinematics.hpp"
+
+/**
+ * @brief Base linear velocity from the IMU and the leg kinematics, for the lin_vel observation.
+ *
+ * A Kalman filter over the world-frame velocity and the accelerometer bias. Every control tick
+ * the accelerometer, rotated by the IMU orientation, predicts the velocity; every leg that
+ * stands then measures it as the negated velocity of its foot relative to the base. A leg
+ * counts as standing when its foot is within contact_height of the lowest foot and its
+ * measurement passes a chi-square gate, so swing legs and slipping feet are left out. The
+ * measurements are applied one axis at a time, which needs no matrix inverse, and all state
+ * is fixed size: Update() neither allocates nor depends on anything but the number of legs.
+ * The feet come from the kinematics generated from the URDF.
+ */
+class VelocityEstimator
+{
+public:
+    VelocityEstimator() { this->Reset(); }
+
+    // resolves the leg joints against the order RobotState uses, empty string on success
+    std::string Configure(const VelocityEstimatorConfig &config, const std::vector<std::string> &joint_names,
+                          const RobotKinematics *kinematics);
+    bool Configured() const { return this->num_legs > 0; }
+    void Reset();
+    // Gazebo reports the angular velocity in the world frame, real IMUs in the body frame
+    void SetWorldFrameGyroscope(bool world) { this->world_gyroscope = world; }
+
+    // quaternion w, x, y, z; accelerometer specific force in the body frame
+    void Update(const double quaternion[4], const double gyroscope[3], const double accelerometer[3], const double *q, const double *dq, double dt);
+
+    const double *Velocity() const { return this->velocity; } // body frame, m/s
+    int Contacts() const { return this->contacts; }           // legs the last update used
+
+    // foot positions and velocities of every leg relative to the base, in the base frame
+    void Feet(const double *q, const double *dq, double positions[][3], double velocities[][3]);
+
+private:
+    void Correct(int axis, double measurement, double variance);
+
+    VelocityEstimatorConfig config;
+    int num_legs = 0;
+    bool world_gyroscope = false;
+    // generated kinematics, which take the joints in base.yaml order
+    const RobotKinematics *kinematics = nullptr;
+    int kinematics_joints[CONFIG_MAX_DOFS]; // RobotState index of each base.yaml joint
+    int feet[CONFIG_MAX_LEGS];              // end effector of each leg
+    double kinematics_q[CONFIG_MAX_DOFS];
+    double kinematics_dq[CONFIG_MAX_DOFS];
+    double end_effector_positions[3 * KINEMATICS_MAX_END_EFFECTORS];
+    double end_effector_velocities[3 * KINEMATICS_MAX_END_EFFECTORS];
+    double state[6];      // world-frame velocity, accelerometer bias
+    double covariance[6][6];
+    double velocity[3] = {0.0, 0.0, 0.0};
+    int contacts = 0;
+    int rejected_ticks = 0; // consecutive ticks every standing leg failed the gate
+};
+
+#endif // VELOCITY_ESTIMATOR_HPP
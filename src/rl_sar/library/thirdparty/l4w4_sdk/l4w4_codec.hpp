@@ -0,0 +1,269 @@
+/*
+* Copyright (c) 2024-2025 Ziqi Fan
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+#ifndef L4W4_CODEC_HPP
+#define L4W4_CODEC_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "comm.h"
+
+// Wire layout of the L4W4 MCU protocol, described once as tables.
+//
+// Command packet: 2-byte big-endian words, value = (x - v_min) / (v_max - v_min) * 65535.
+//   per leg (FR, RR, RL, FL): hip q, thigh -q, calf -q, wheel -dq, each followed by Kp and Kd,
+//   then three reserved words holding 0 in [-10, 10].
+// State packet: fixed header (mcu time, battery, imu, remote), then 2-byte little-endian
+//   words per motor, value = w / 65535 * (v_max - v_min) + v_min.
+namespace l4w4_codec
+{
+    struct CommandWord
+    {
+        uint8_t motor;
+        float MotorCmd::*field;
+        float sign;
+        float v_min;
+        float v_max;
+    };
+
+    struct StateWord
+    {
+        uint8_t motor;
+        float MotorState::*field;
+        float MotorState::*raw;
+        float sign;
+        float v_min;
+        float v_max;
+    };
+
+    constexpr float PI = 3.14159265358979323846f;
+    constexpr float THIGH_MIN = static_cast<float>(-1.3 * 3.14159265358979323846);
+    constexpr float THIGH_MAX = static_cast<float>(0.7 * 3.14159265358979323846);
+
+#define L4W4_CMD_JOINT(m, sign, field, lo, hi) \
+    {m, &MotorCmd::field, sign, lo, hi}, {m, &MotorCmd::Kp, 1.0f, 0.0f, 1000.0f}, {m, &MotorCmd::Kd, 1.0f, 0.0f, 1000.0f}
+#define L4W4_CMD_LEG(hip, thigh, calf, wheel)                 \
+    L4W4_CMD_JOINT(hip, 1.0f, q, -3.2f, 3.2f),                \
+    L4W4_CMD_JOINT(thigh, -1.0f, q, -3.2f, 3.2f),             \
+    L4W4_CMD_JOINT(calf, -1.0f, q, -3.2f, 3.2f),              \
+    L4W4_CMD_JOINT(wheel, -1.0f, dq, -200.0f, 200.0f)
+
+    constexpr CommandWord COMMAND_LAYOUT[] = {
+        L4W4_CMD_LEG(4, 5, 6, 7),     // front right
+        L4W4_CMD_LEG(12, 13, 14, 15), // rear right
+        L4W4_CMD_LEG(8, 9, 10, 11),   // rear left
+        L4W4_CMD_LEG(0, 1, 2, 3),     // front left
+    };
+
+#undef L4W4_CMD_LEG
+#undef L4W4_CMD_JOINT
+
+    constexpr size_t COMMAND_WORDS = sizeof(COMMAND_LAYOUT) / sizeof(COMMAND_LAYOUT[0]);
+    constexpr size_t COMMAND_RESERVED_WORDS = 3;
+    constexpr uint16_t COMMAND_RESERVED_VALUE = 32767; // 0 in [-10, 10]
+    constexpr size_t COMMAND_SIZE = 2 * (COMMAND_WORDS + COMMAND_RESERVED_WORDS);
+
+#define L4W4_STATE_Q(m, sign, lo, hi) {m, &MotorState::q, &MotorState::q_raw, sign, lo, hi}
+#define L4W4_STATE_DQ(m, sign, lo, hi) {m, &MotorState::dq, &MotorState::dq_raw, sign, lo, hi}
+#define L4W4_STATE_LEG(hip, thigh, calf)                                                  \
+    L4W4_STATE_Q(hip, 1.0f, -PI, PI), L4W4_STATE_DQ(hip, 1.0f, -33.0f, 33.0f),            \
+    L4W4_STATE_Q(thigh, -1.0f, THIGH_MIN, THIGH_MAX), L4W4_STATE_DQ(thigh, -1.0f, -33.0f, 33.0f), \
+    L4W4_STATE_Q(calf, -1.0f, -PI, PI), L4W4_STATE_DQ(calf, -1.0f, -33.0f, 33.0f)
+#define L4W4_STATE_WHEEL(wheel) \
+    L4W4_STATE_Q(wheel, -1.0f, -PI, PI), L4W4_STATE_DQ(wheel, -1.0f, -200.0f, 200.0f)
+
+    // MCU legs 1..4 are motors 4.., 12.., 8.., 0.. on the host side
+    constexpr StateWord STATE_LAYOUT[] = {
+        L4W4_STATE_LEG(4, 5, 6),
+        L4W4_STATE_LEG(12, 13, 14),
+        L4W4_STATE_LEG(8, 9, 10),
+        L4W4_STATE_LEG(0, 1, 2),
+        L4W4_STATE_WHEEL(7),
+        L4W4_STATE_WHEEL(15),
+        L4W4_STATE_WHEEL(11),
+        L4W4_STATE_WHEEL(3),
+    };
+
+#undef L4W4_STATE_WHEEL
+#undef L4W4_STATE_LEG
+#undef L4W4_STATE_DQ
+#undef L4W4_STATE_Q
+
+    constexpr size_t STATE_WORDS = sizeof(STATE_LAYOUT) / sizeof(STATE_LAYOUT[0]);
+    constexpr size_t STATE_TIME_OFFSET = 2;
+    constexpr size_t STATE_IMU_OFFSET = 8;
+    constexpr size_t STATE_KEY_OFFSET = 50;
+    constexpr size_t STATE_ROCKER_OFFSET = 52;
+    constexpr size_t STATE_MOTOR_OFFSET = 88;
+    constexpr size_t STATE_SIZE = STATE_MOTOR_OFFSET + 2 * STATE_WORDS;
+
+    static_assert(COMMAND_SIZE == 102, "L4W4 command packet layout changed");
+    static_assert(STATE_SIZE == 152, "L4W4 state packet layout changed");
+
+    struct StateHeader
+    {
+        float mcu_time;
+        uint8_t key1;
+        uint8_t key2;
+        float rocker[5]; // lx, rx, ly, L2, ry as sent by the MCU
+    };
+
+    inline float ReadFloat(const uint8_t *buff)
+    {
+        float v;
+        memcpy(&v, buff, sizeof(v));
+        return v;
+    }
+
+    inline uint16_t Quantize(float value, float v_min, float v_max)
+    {
+        // same operation order as the original hand-written encoder so packets stay bit-exact,
+        // but saturated instead of the undefined float->ushort conversion; NaN maps to v_min
+        float scaled = (value - v_min) / (v_max - v_min) * 65535.0f;
+        scaled = scaled > 0.0f ? scaled : 0.0f;
+        scaled = scaled < 65535.0f ? scaled : 65535.0f;
+        return static_cast<uint16_t>(scaled);
+    }
+
+    inline float Dequantize(uint16_t word, float v_min, float v_max)
+    {
+        return static_cast<float>(word / 65535.0 * (v_max - v_min) + v_min);
+    }
+
+    inline void WriteFloat(uint8_t *buff, float v)
+    {
+        memcpy(buff, &v, sizeof(v));
+    }
+
+    inline size_t EncodeCommand(const LowCmd &cmd, uint8_t *buff)
+    {
+        for (size_t i = 0; i < COMMAND_WORDS; ++i)
+        {
+            const CommandWord &w = COMMAND_LAYOUT[i];
+            uint16_t v16 = Quantize(w.sign * (cmd.motorCmd[w.motor].*w.field), w.v_min, w.v_max);
+            buff[2 * i] = v16 >> 8;
+            buff[2 * i + 1] = v16 & 0xff;
+        }
+        for (size_t i = COMMAND_WORDS; i < COMMAND_WORDS + COMMAND_RESERVED_WORDS; ++i)
+        {
+            buff[2 * i] = COMMAND_RESERVED_VALUE >> 8;
+            buff[2 * i + 1] = COMMAND_RESERVED_VALUE & 0xff;
+        }
+        return COMMAND_SIZE;
+    }
+
+    // returns false without touching state when the packet is shorter than the layout
+    inline bool DecodeState(const uint8_t *buff, size_t len, StateHeader &header, LowState &state)
+    {
+        if (buff == nullptr || len < STATE_SIZE)
+        {
+            return false;
+        }
+
+        header.mcu_time = ReadFloat(buff + STATE_TIME_OFFSET);
+        header.key1 = buff[STATE_KEY_OFFSET];
+        header.key2 = buff[STATE_KEY_OFFSET + 1];
+        for (int i = 0; i < 5; ++i)
+        {
+            header.rocker[i] = ReadFloat(buff + STATE_ROCKER_OFFSET + 4 * i);
+        }
+
+        // imu frame is y-up, the host frame is z-up
+        const uint8_t *imu = buff + STATE_IMU_OFFSET;
+        float acc[3], omega[3], quat[4];
+        for (int i = 0; i < 3; ++i)
+        {
+            acc[i] = ReadFloat(imu + 4 * i);
+            omega[i] = ReadFloat(imu + 12 + 4 * i);
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            quat[i] = ReadFloat(imu + 24 + 4 * i); // x, y, z, w
+        }
+        state.imu.quaternion[0] = quat[3];
+        state.imu.quaternion[1] = quat[0];
+        state.imu.quaternion[2] = -quat[2];
+        state.imu.quaternion[3] = quat[1];
+        state.imu.gyroscope[0] = omega[0];
+        state.imu.gyroscope[1] = -omega[2];
+        state.imu.gyroscope[2] = omega[1];
+        state.imu.accelerometer[0] = acc[0];
+        state.imu.accelerometer[1] = -acc[2];
+        state.imu.accelerometer[2] = acc[1];
+
+        const uint8_t *words = buff + STATE_MOTOR_OFFSET;
+        for (size_t i = 0; i < STATE_WORDS; ++i)
+        {
+            const StateWord &w = STATE_LAYOUT[i];
+            uint16_t v16 = static_cast<uint16_t>(words[2 * i] | (words[2 * i + 1] << 8));
+            float value = w.sign * Dequantize(v16, w.v_min, w.v_max);
+            MotorState &motor = state.motorState[w.motor];
+            motor.*w.field = value;
+            motor.*w.raw = value;
+            motor.ddq = motor.ddq_raw = 0;
+        }
+        return true;
+    }
+
+    // MCU side of the protocol, used by the loopback emulator
+    inline bool DecodeCommand(const uint8_t *buff, size_t len, LowCmd &cmd)
+    {
+        if (buff == nullptr || len < COMMAND_SIZE)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < COMMAND_WORDS; ++i)
+        {
+            const CommandWord &w = COMMAND_LAYOUT[i];
+            uint16_t v16 = static_cast<uint16_t>((buff[2 * i] << 8) | buff[2 * i + 1]);
+            cmd.motorCmd[w.motor].*w.field = w.sign * Dequantize(v16, w.v_min, w.v_max);
+        }
+        return true;
+    }
+
+    inline size_t EncodeState(const StateHeader &header, const LowState &state, uint8_t *buff)
+    {
+        memset(buff, 0, STATE_SIZE);
+        WriteFloat(buff + STATE_TIME_OFFSET, header.mcu_time);
+        buff[STATE_KEY_OFFSET] = header.key1;
+        buff[STATE_KEY_OFFSET + 1] = header.key2;
+        for (int i = 0; i < 5; ++i)
+        {
+            WriteFloat(buff + STATE_ROCKER_OFFSET + 4 * i, header.rocker[i]);
+        }
+
+        // inverse of the frame change in DecodeState
+        uint8_t *imu = buff + STATE_IMU_OFFSET;
+        const float acc[3] = {state.imu.accelerometer[0], state.imu.accelerometer[2], -state.imu.accelerometer[1]};
+        const float omega[3] = {state.imu.gyroscope[0], state.imu.gyroscope[2], -state.imu.gyroscope[1]};
+        const float quat[4] = {state.imu.quaternion[1], state.imu.quaternion[3], -state.imu.quaternion[2], state.imu.quaternion[0]};
+        for (int i = 0; i < 3; ++i)
+        {
+            WriteFloat(imu + 4 * i, acc[i]);
+            WriteFloat(imu + 12 + 4 * i, omega[i]);
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            WriteFloat(imu + 24 + 4 * i, quat[i]);
+        }
+
+        uint8_t *words = buff + STATE_MOTOR_OFFSET;
+        for (size_t i = 0; i < STATE_WORDS; ++i)
+        {
+            const StateWord &w = STATE_LAYOUT[i];
+            // round to nearest so a decode/encode round trip does not drift
+            float scaled = (w.sign * (state.motorState[w.motor].*w.field) - w.v_min) / (w.v_max - w.v_min) * 65535.0f + 0.5f;
+            scaled = scaled > 0.0f ? scaled : 0.0f;
+            scaled = scaled < 65535.0f ? scaled : 65535.0f;
+            uint16_t v16 = static_cast<uint16_t>(scaled);
+            words[2 * i] = v16 & 0xff;
+            words[2 * i + 1] = v16 >> 8;
+        }
+        return STATE_SIZE;
+    }
+}
+
+#endif // L4W4_CODEC_HPP
@@ -232,19 +232,42 @@ def train_actuator_network_and_plot_predictions(data_path, actuator_network_path
     fig.legend(["Calculated torque", "Real torque", "Predicted torque"], loc='upper right', bbox_to_anchor=(1, 1))
     plt.show()
 
+def export_actuator_network(actuator_network_path, config):
+    """Write the TorchScript actuator network as plain text for the C++ joint controller"""
+    model = torch.jit.load(actuator_network_path, map_location="cpu")
+    params = dict(model.named_parameters())
+    linear_ids = sorted({int(name.split(".")[0]) for name in params}, key=int)
+    export_path = os.path.splitext(actuator_network_path)[0] + ".txt"
+    with open(export_path, "w") as f:
+        f.write(f"actuator_net {config.act}\n")
+        for idx in linear_ids:
+            weight = params[f"{idx}.weight"].detach().cpu().numpy()
+            bias = params[f"{idx}.bias"].detach().cpu().numpy()
+            f.write(f"linear {weight.shape[0]} {weight.shape[1]}\n")
+            f.write(" ".join(repr(float(w)) for w in weight.flatten()) + "\n")
+            f.write(" ".join(repr(float(b)) for b in bias) + "\n")
+    print(f"Exported actuator network to: {export_path}")
+
 def main():
     parser = argparse.ArgumentParser()
-    parser.add_argument("--mode", type=str, required=True, choices=["train", "play"], help="Choose whether to train or evaluate the actuator network")
-    parser.add_argument("--data", type=str, required=True, help="Path of data files")
+    parser.add_argument("--mode", type=str, required=True, choices=["train", "play", "export"], help="Choose whether to train, evaluate or export the actuator network")
+    parser.add_argument("--data", type=str, required=False, help="Path of data files")
     parser.add_argument("--output", type=str, required=True, help="Path to save or load the actuator network model")
 
     args = parser.parse_args()
 
-    data_path = os.path.join(BASE_PATH, "models", args.data)
     output_path = os.path.join(BASE_PATH, "models", args.output)
 
     config = Config()
 
+    if args.mode == "export":
+        export_actuator_network(output_path, config)
+        return
+
+    if args.data is None:
+        parser.error("--data is required for train and play")
+    data_path = os.path.join(BASE_PATH, "models", args.data)
+
     if args.mode == "train":
         load_pretrained_model = False
     elif args.mode == "play":
@@ -0,0 +1,144 @@
+# Copyright (c) 2024-2025 Ziqi Fan
+# SPDX-License-Identifier: Apache-2.0
+
+# CPU usage and tick-to-tick timing of the rl_sim <-> Gazebo exchange, run next to a simulation
+# once with the per-joint topics and once with the group controller:
+#
+#   roslaunch rl_sar gazebo_go2.launch                        # then start rl_sim and the policy
+#   rosrun rl_sar benchmark_exchange.py --robot go2 --duration 30
+#   roslaunch rl_sar gazebo_go2.launch group_controller:=true
+#   rosrun rl_sar benchmark_exchange.py --robot go2 --duration 30
+#
+# The mode is taken from the topics that are published. Intervals are measured where a third node
+# receives the messages, so both modes pay the same subscriber overhead; with per-joint topics a
+# tick is complete when every joint's command has arrived, and the spread between the first and
+# the last joint of a tick is how far the joint set is torn. CPU is the user+system time of the
+# rl_sim and gzserver processes over the run, in percent of one core.
+
+import os
+import time
+import argparse
+import threading
+import yaml
+import rospy
+from robot_msgs.msg import MotorCommand, MotorState, RobotCommand, RobotState
+
+MODELS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "models")
+PROCESSES = ["rl_sim", "gzserver"]
+
+def joint_controller_names(robot):
+    with open(os.path.join(MODELS_DIR, robot, "base.yaml")) as f:
+        return yaml.safe_load(f)[robot]["joint_controller_names"]
+
+def process_ticks():
+    # pid -> (name, utime + stime) for the processes worth watching
+    ticks = {}
+    for pid in os.listdir("/proc"):
+        if not pid.isdigit():
+            continue
+        try:
+            with open("/proc/%s/stat" % pid) as f:
+                stat = f.read()
+        except OSError:
+            continue
+        name = stat[stat.index("(") + 1:stat.rindex(")")]
+        if name in PROCESSES:
+            fields = stat[stat.rindex(")") + 2:].split()
+            ticks[pid] = (name, int(fields[11]) + int(fields[12]))
+    return ticks
+
+def percentiles(values):
+    if not values:
+        return "no samples"
+    values = sorted(values)
+    pick = lambda p: values[min(len(values) - 1, int(p * len(values)))] * 1e3
+    mean = sum(values) / len(values) * 1e3
+    return "n %6d  mean %7.3f  p50 %7.3f  p99 %7.3f  max %7.3f ms" % (len(values), mean, pick(0.5), pick(0.99), values[-1] * 1e3)
+
+class Intervals:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.last = None
+        self.values = []
+
+    def tick(self, now):
+        with self.lock:
+            if self.last is not None:
+                self.values.append(now - self.last)
+            self.last = now
+
+class JointTicks:
+    # per-joint topics: a tick is complete once every joint has been heard from since the last one
+    def __init__(self, num_joints):
+        self.lock = threading.Lock()
+        self.num_joints = num_joints
+        self.seen = set()
+        self.first = None
+        self.intervals = Intervals()
+        self.spreads = []
+
+    def joint(self, index, now):
+        with self.lock:
+            if index in self.seen:
+                # a joint repeats before the tick completed, the tick was torn beyond recovery
+                self.seen.clear()
+                self.first = None
+            if not self.seen:
+                self.first = now
+            self.seen.add(index)
+            if len(self.seen) == self.num_joints:
+                self.spreads.append(now - self.first)
+                self.intervals.tick(self.first)
+                self.seen.clear()
+
+def main():
+    parser = argparse.ArgumentParser(description="rl_sim exchange CPU usage and tick-to-tick timing")
+    parser.add_argument("--robot", default="go2", help="models/<robot>/base.yaml and the /<robot>_gazebo/ namespace")
+    parser.add_argument("--duration", type=float, default=30.0, help="seconds to measure")
+    args = parser.parse_args()
+
+    rospy.init_node("benchmark_exchange", anonymous=True, disable_signals=True)
+    namespace = "/%s_gazebo/" % args.robot
+    topics = dict(rospy.get_published_topics())
+    group = namespace + "robot_joint_group_controller/command" in topics
+    joints = joint_controller_names(args.robot)
+
+    commands = Intervals()
+    states = Intervals()
+    joint_ticks = JointTicks(len(joints))
+    subscribers = []
+    if group:
+        subscribers.append(rospy.Subscriber(namespace + "robot_joint_group_controller/command", RobotCommand,
+                                            lambda msg: commands.tick(time.perf_counter()), queue_size=100, tcp_nodelay=True))
+        subscribers.append(rospy.Subscriber(namespace + "robot_joint_group_controller/state", RobotState,
+                                            lambda msg: states.tick(time.perf_counter()), queue_size=100, tcp_nodelay=True))
+    else:
+        for index, joint in enumerate(joints):
+            subscribers.append(rospy.Subscriber(namespace + joint + "/command", MotorCommand,
+                                                lambda msg, i=index: joint_ticks.joint(i, time.perf_counter()), queue_size=100, tcp_nodelay=True))
+        subscribers.append(rospy.Subscriber(namespace + joints[0] + "/state", MotorState,
+                                            lambda msg: states.tick(time.perf_counter()), queue_size=100, tcp_nodelay=True))
+
+    time.sleep(1.0) # connect before measuring
+    start_ticks = process_ticks()
+    start = time.perf_counter()
+    time.sleep(args.duration)
+    elapsed = time.perf_counter() - start
+    end_ticks = process_ticks()
+    for subscriber in subscribers:
+        subscriber.unregister()
+
+    hz = os.sysconf("SC_CLK_TCK")
+    print("%s, %s, %.1f s" % (args.robot, "group controller" if group else "per-joint topics (%d joints)" % len(joints), elapsed))
+    if group:
+        print("command interval  " + percentiles(commands.values))
+    else:
+        print("command interval  " + percentiles(joint_ticks.intervals.values))
+        print("command spread    " + percentiles(joint_ticks.spreads))
+    print("state interval    " + percentiles(states.values))
+    for pid, (name, ticks) in sorted(end_ticks.items()):
+        if pid in start_ticks:
+            print("cpu %-12s %6.1f %%" % (name, (ticks - start_ticks[pid][1]) / hz / elapsed * 100.0))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+# Copyright (c) 2024-2025 Ziqi Fan
+# SPDX-License-Identifier: Apache-2.0
+
+# Per-tick cost of a recurrent policy carrying its hidden state against the history-stacked
+# MLP it replaces, both as TorchScript at batch size 1 the way the runtime runs them. The
+# stacked side includes the ObservationBuffer shift and gather done every tick, the recurrent
+# side the in-place copy of the returned state into the persistent buffers (RL::PolicyForward).
+#
+#   python scripts/benchmark_recurrent.py --num-obs 45 --history 6 --rnn lstm --save-dir /tmp/policies
+#
+# With --save-dir the scripted recurrent policy is written in the layout rl_sdk expects, together
+# with the hidden_states line for its config.yaml.
+
+import os
+import time
+import argparse
+import torch
+import torch.nn as nn
+from observation_buffer import ObservationBuffer
+
+def mlp(in_dim, hidden_dims, out_dim):
+    layers = []
+    for dim in hidden_dims:
+        layers += [nn.Linear(in_dim, dim), nn.ELU()]
+        in_dim = dim
+    layers.append(nn.Linear(in_dim, out_dim))
+    return nn.Sequential(*layers)
+
+class StackedPolicy(nn.Module):
+    def __init__(self, num_obs, history, hidden_dims, num_actions):
+        super().__init__()
+        self.actor = mlp(num_obs * history, hidden_dims, num_actions)
+
+    def forward(self, obs_history):
+        return self.actor(obs_history)
+
+class LSTMPolicy(nn.Module):
+    # forward(obs, h, c) -> (actions, h, c), hidden_states: [[layers, 1, size], [layers, 1, size]]
+    def __init__(self, num_obs, rnn_size, rnn_layers, hidden_dims, num_actions):
+        super().__init__()
+        self.memory = nn.LSTM(num_obs, rnn_size, rnn_layers)
+        self.actor = mlp(rnn_size, hidden_dims, num_actions)
+
+    def forward(self, obs, h, c):
+        out, (h, c) = self.memory(obs.unsqueeze(0), (h, c))
+        return self.actor(out.squeeze(0)), h, c
+
+class GRUPolicy(nn.Module):
+    # forward(obs, h) -> (actions, h), hidden_states: [[layers, 1, size]]
+    def __init__(self, num_obs, rnn_size, rnn_layers, hidden_dims, num_actions):
+        super().__init__()
+        self.memory = nn.GRU(num_obs, rnn_size, rnn_layers)
+        self.actor = mlp(rnn_size, hidden_dims, num_actions)
+
+    def forward(self, obs, h):
+        out, h = self.memory(obs.unsqueeze(0), h)
+        return self.actor(out.squeeze(0)), h
+
+def parameters(model):
+    return sum(p.numel() for p in model.parameters())
+
+def summarize(name, latencies, model):
+    latencies = torch.tensor(latencies)
+    print(f"{name:>8}: mean {latencies.mean().item():7.1f}us  p50 {latencies.median().item():7.1f}us  "
+          f"p99 {torch.quantile(latencies, 0.99).item():7.1f}us  max {latencies.max().item():7.1f}us  "
+          f"{parameters(model) / 1e3:.0f}k parameters")
+
+def run_stacked(model, args, observations):
+    buffer = ObservationBuffer(1, args.num_obs, args.history)
+    history_ids = list(range(args.history))
+    latencies = []
+    with torch.no_grad():
+        for i, obs in enumerate(observations):
+            start = time.perf_counter()
+            buffer.insert(obs)
+            model(buffer.get_obs_vec(history_ids))
+            if i >= args.warmup:
+                latencies.append((time.perf_counter() - start) * 1e6)
+    return latencies
+
+def run_recurrent(model, args, observations, shapes):
+    hidden_states = [torch.zeros(shape) for shape in shapes]
+    latencies = []
+    with torch.no_grad():
+        for i, obs in enumerate(observations):
+            start = time.perf_counter()
+            output = model(obs, *hidden_states)
+            for hidden_state, new_state in zip(hidden_states, output[1:]):
+                hidden_state.copy_(new_state)
+            if i >= args.warmup:
+                latencies.append((time.perf_counter() - start) * 1e6)
+    return latencies
+
+def main():
+    parser = argparse.ArgumentParser(description="Recurrent policy vs history-stacked MLP, per-tick latency")
+    parser.add_argument("--num-obs", type=int, default=45, help="observation size of one tick")
+    parser.add_argument("--history", type=int, default=6, help="ticks the MLP stacks, himloco uses 6")
+    parser.add_argument("--num-actions", type=int, default=12)
+    parser.add_argument("--hidden-dims", type=int, nargs="+", default=[512, 256, 128], help="actor MLP, shared by both")
+    parser.add_argument("--rnn", choices=["lstm", "gru"], default="lstm")
+    parser.add_argument("--rnn-size", type=int, default=256)
+    parser.add_argument("--rnn-layers", type=int, default=1)
+    parser.add_argument("--ticks", type=int, default=5000)
+    parser.add_argument("--warmup", type=int, default=200)
+    parser.add_argument("--threads", type=int, default=4, help="intra-op threads, as set by rl_real")
+    parser.add_argument("--save-dir", default="", help="write the scripted recurrent policy here")
+    args = parser.parse_args()
+
+    torch.set_num_threads(args.threads)
+    torch.manual_seed(0)
+    shapes = [[args.rnn_layers, 1, args.rnn_size]] * (2 if args.rnn == "lstm" else 1)
+    recurrent_class = LSTMPolicy if args.rnn == "lstm" else GRUPolicy
+    stacked = torch.jit.script(StackedPolicy(args.num_obs, args.history, args.hidden_dims, args.num_actions).eval())
+    recurrent = torch.jit.script(recurrent_class(args.num_obs, args.rnn_size, args.rnn_layers, args.hidden_dims, args.num_actions).eval())
+    observations = [torch.randn(1, args.num_obs) for _ in range(args.ticks + args.warmup)]
+
+    print(f"{args.ticks} ticks, {args.num_obs} observations, {args.threads} threads, actor {args.hidden_dims}")
+    summarize("stacked", run_stacked(stacked, args, observations), stacked)
+    summarize(args.rnn, run_recurrent(recurrent, args, observations, shapes), recurrent)
+
+    if args.save_dir:
+        os.makedirs(args.save_dir, exist_ok=True)
+        path = os.path.join(args.save_dir, f"policy_{args.rnn}.pt")
+        recurrent.save(path)
+        print(f"wrote {path}, config.yaml: hidden_states: {shapes}, observations_history: null")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,437 @@
+# Copyright (c) 2024-2025 Ziqi Fan
+# SPDX-License-Identifier: Apache-2.0
+
+# Build step: turns the URDF of every robot whose base.yaml has a kinematics section into
+# straight-line C++ for the positions, velocities and Jacobians of its end effectors, with the
+# joints in joint_controller_names order. The transforms are multiplied out here with the URDF
+# constants folded in, so the generated functions only evaluate sin and cos of each joint and the
+# products that are not known to be zero or one. The URDF tree is also written as a table for
+# the generic evaluator in library/core/robot_kinematics, which the generated code is checked
+# against by kinematics_benchmark, and the URDF limits of every joint for the safety supervisor.
+#
+#   python scripts/generate_kinematics.py models ../robots <output_dir>
+#
+# base.yaml:
+#   kinematics:
+#     urdf: "go2_description/urdf/go2_description.urdf"  # relative to the robots directory
+#     base_link: "base"                                   # optional, the URDF root by default
+#     end_effectors: ["FR_foot", "FL_foot", "RR_foot", "RL_foot"]
+#
+# The URDF joint of each controller comes from <description>/config/robot_control.yaml.
+
+import os
+import re
+import sys
+import math
+import glob
+import yaml
+import xml.etree.ElementTree as ET
+
+FIXED, REVOLUTE, PRISMATIC = 0, 1, 2
+EPSILON = 1e-12
+MAX_END_EFFECTORS = 8  # KINEMATICS_MAX_END_EFFECTORS
+
+
+class GeneratorError(Exception):
+    pass
+
+
+class Poly:
+    # polynomial over the generated variables, {sorted tuple of variable names: coefficient}
+    def __init__(self, terms=None):
+        self.terms = {}
+        for monomial, coefficient in (terms or {}).items():
+            if abs(coefficient) > EPSILON:
+                self.terms[monomial] = coefficient
+
+    @staticmethod
+    def const(value):
+        return Poly({(): value})
+
+    @staticmethod
+    def var(name):
+        return Poly({(name,): 1.0})
+
+    def __add__(self, other):
+        terms = dict(self.terms)
+        for monomial, coefficient in other.terms.items():
+            terms[monomial] = terms.get(monomial, 0.0) + coefficient
+        return Poly(terms)
+
+    def __neg__(self):
+        return Poly({monomial: -coefficient for monomial, coefficient in self.terms.items()})
+
+    def __sub__(self, other):
+        return self + (-other)
+
+    def __mul__(self, other):
+        terms = {}
+        for m1, c1 in self.terms.items():
+            for m2, c2 in other.terms.items():
+                monomial = tuple(sorted(m1 + m2))
+                terms[monomial] = terms.get(monomial, 0.0) + c1 * c2
+        return Poly(terms)
+
+    def is_const(self):
+        return all(not monomial for monomial in self.terms)
+
+    def is_var(self):
+        # a variable or its negation, cheaper to write inline than to bind
+        return len(self.terms) == 1 and all(len(m) == 1 and abs(c) == 1.0 for m, c in self.terms.items())
+
+    def code(self):
+        if not self.terms:
+            return "0.0"
+        parts = []
+        for monomial, coefficient in sorted(self.terms.items(), key=lambda item: (len(item[0]), item[0])):
+            sign = "-" if coefficient < 0 else "+"
+            magnitude = abs(coefficient)
+            factors = list(monomial)
+            if magnitude != 1.0 or not factors:
+                factors.insert(0, number(magnitude))
+            parts.append((sign, " * ".join(factors)))
+        text = ("-" if parts[0][0] == "-" else "") + parts[0][1]
+        for sign, factor in parts[1:]:
+            text += " " + sign + " " + factor
+        return text
+
+
+def number(value):
+    text = repr(float(value))
+    return text if ("." in text or "e" in text) else text + ".0"
+
+
+def rpy_matrix(rpy):
+    r, p, y = rpy
+    cr, sr, cp, sp, cy, sy = math.cos(r), math.sin(r), math.cos(p), math.sin(p), math.cos(y), math.sin(y)
+    return [[cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr],
+            [sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr],
+            [-sp, cp * sr, cp * cr]]
+
+
+def axis_rotation(axis, c, s):
+    # Rodrigues, R = c I + s [k]x + (1 - c) k k^T, with c and s as polynomials
+    x, y, z = axis
+    cross = [[0.0, -z, y], [z, 0.0, -x], [-y, x, 0.0]]
+    return [[c * Poly.const((1.0 if i == j else 0.0) - axis[i] * axis[j]) + s * Poly.const(cross[i][j]) + Poly.const(axis[i] * axis[j])
+             for j in range(3)] for i in range(3)]
+
+
+def mat_mul(a, b):
+    return [[a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] for j in range(3)] for i in range(3)]
+
+
+def mat_vec(a, v):
+    return [a[i][0] * v[0] + a[i][1] * v[1] + a[i][2] * v[2] for i in range(3)]
+
+
+def cross(a, b):
+    return [a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]]
+
+
+def const_matrix(m):
+    return [[Poly.const(m[i][j]) for j in range(3)] for i in range(3)]
+
+
+def const_vector(v):
+    return [Poly.const(x) for x in v]
+
+
+def floats(text, default):
+    return [float(x) for x in text.split()] if text else list(default)
+
+
+class Emitter:
+    # straight-line statements "const double name = expression;", only the ones an output needs are written
+    def __init__(self):
+        self.statements = []
+        self.count = 0
+
+    def bind(self, poly, prefix):
+        if poly.is_const() or poly.is_var():
+            return poly
+        name = "%s%d" % (prefix, self.count)
+        self.count += 1
+        self.statements.append((name, poly.code()))
+        return Poly.var(name)
+
+    def raw(self, name, expression):
+        self.statements.append((name, expression))
+        return Poly.var(name)
+
+    def needed(self, outputs):
+        names = set(re.findall(r"[A-Za-z_]\w*", " ".join(outputs)))
+        body = []
+        for name, expression in reversed(self.statements):
+            if name in names:
+                body.append((name, expression))
+                names.update(re.findall(r"[A-Za-z_]\w*", expression))
+        return list(reversed(body))
+
+
+def load_robot(models_dir, robots_dir, robot):
+    with open(os.path.join(models_dir, robot, "base.yaml")) as f:
+        base = yaml.safe_load(f)[robot]
+    section = base.get("kinematics")
+    if not section:
+        return None
+    where = "%s/%s/base.yaml: kinematics" % (models_dir, robot)
+    for key in ("urdf", "end_effectors"):
+        if key not in section:
+            raise GeneratorError("%s: missing %s" % (where, key))
+    if not 0 < len(section["end_effectors"]) <= MAX_END_EFFECTORS:
+        raise GeneratorError("%s: end_effectors: expected 1 to %d links" % (where, MAX_END_EFFECTORS))
+    urdf_path = os.path.join(robots_dir, section["urdf"])
+    description = section["urdf"].split("/")[0]
+    control_path = os.path.join(robots_dir, description, "config", "robot_control.yaml")
+    if not os.path.exists(urdf_path):
+        raise GeneratorError("%s: urdf: %s not found" % (where, urdf_path))
+    if not os.path.exists(control_path):
+        raise GeneratorError("%s: %s not found, it maps the controllers to URDF joints" % (where, control_path))
+    with open(control_path) as f:
+        control = yaml.safe_load(f)
+    controller_joints = {}
+    for controllers in control.values():
+        for name, controller in controllers.items():
+            if isinstance(controller, dict) and "joint" in controller:
+                controller_joints[name] = controller["joint"]
+
+    root = ET.parse(urdf_path).getroot()
+    joints = {}
+    for joint in root.findall("joint"):
+        origin = joint.find("origin")
+        axis = joint.find("axis")
+        kind = joint.get("type")
+        limit = joint.find("limit")
+        joints[joint.find("child").get("link")] = {
+            "name": joint.get("name"),
+            "parent": joint.find("parent").get("link"),
+            "type": {"revolute": REVOLUTE, "continuous": REVOLUTE, "prismatic": PRISMATIC}.get(kind, FIXED),
+            "xyz": floats(origin.get("xyz") if origin is not None else None, [0.0, 0.0, 0.0]),
+            "rpy": floats(origin.get("rpy") if origin is not None else None, [0.0, 0.0, 0.0]),
+            "axis": floats(axis.get("xyz") if axis is not None else None, [1.0, 0.0, 0.0]),
+            # continuous joints have no position limits, a missing velocity or effort is 0
+            "limits": [1 if kind in ("revolute", "prismatic") and limit is not None else 0] +
+                      [float(limit.get(key, 0.0)) if limit is not None else 0.0 for key in ("lower", "upper", "velocity", "effort")],
+        }
+    links = [link.get("name") for link in root.findall("link")]
+    roots = [link for link in links if link not in joints]
+    base_link = section.get("base_link", roots[0] if roots else "")
+    if base_link not in links:
+        raise GeneratorError("%s: base_link: '%s' is not a link of %s" % (where, base_link, urdf_path))
+
+    joint_names = base["joint_controller_names"]
+    q_index = {}
+    urdf_joints = dict((joint["name"], joint) for joint in joints.values())
+    limits = []
+    for i, controller in enumerate(joint_names):
+        if controller not in controller_joints:
+            raise GeneratorError("%s: %s has no joint in %s" % (where, controller, control_path))
+        if controller_joints[controller] not in urdf_joints:
+            raise GeneratorError("%s: %s drives %s, which is not a joint of %s" % (where, controller, controller_joints[controller], urdf_path))
+        q_index[controller_joints[controller]] = i
+        limits.append(urdf_joints[controller_joints[controller]]["limits"])
+
+    # the links on the way from the base to every end effector, parents first
+    order = []
+    for end_effector in section["end_effectors"]:
+        path = []
+        link = end_effector
+        while link != base_link:
+            if link not in joints:
+                raise GeneratorError("%s: end_effectors: '%s' is not below %s in %s" % (where, end_effector, base_link, urdf_path))
+            path.append(link)
+            link = joints[link]["parent"]
+        for link in reversed(path):
+            if link not in order:
+                order.append(link)
+
+    tree = []
+    for link in order:
+        joint = joints[link]
+        kind = joint["type"]
+        index = q_index.get(joint["name"], -1)
+        if kind != FIXED and index < 0:
+            print("generate_kinematics: %s: %s has no controller, it is held at zero" % (robot, joint["name"]))
+            kind = FIXED
+        norm = math.sqrt(sum(x * x for x in joint["axis"])) or 1.0
+        tree.append({
+            "link": link,
+            "parent": order.index(joint["parent"]) if joint["parent"] != base_link else -1,
+            "type": kind,
+            "q": index if kind != FIXED else -1,
+            "xyz": joint["xyz"],
+            "rpy": joint["rpy"],
+            "axis": [x / norm for x in joint["axis"]],
+        })
+    used = set(entry["q"] for entry in tree if entry["q"] >= 0)
+    for i, controller in enumerate(joint_names):
+        if i not in used:
+            print("generate_kinematics: %s: %s moves none of the end effectors" % (robot, controller))
+    return {
+        "robot": robot,
+        "identifier": re.sub(r"\W", "_", robot),
+        "joint_names": joint_names,
+        "end_effectors": section["end_effectors"],
+        "end_effector_entries": [order.index(e) for e in section["end_effectors"]],
+        "tree": tree,
+        "limits": limits,
+    }
+
+
+def generate_robot(model):
+    n = len(model["joint_names"])
+    emitter = Emitter()
+    sines, cosines = {}, {}
+    rotations, positions, axes, joint_points = [], [], [], []
+    identity = const_matrix([[1.0, 0.0, 0.0], [0.0, 1.0, 0.0], [0.0, 0.0, 1.0]])
+    for entry in model["tree"]:
+        R = rotations[entry["parent"]] if entry["parent"] >= 0 else identity
+        p = positions[entry["parent"]] if entry["parent"] >= 0 else const_vector([0.0, 0.0, 0.0])
+        p = [a + b for a, b in zip(p, mat_vec(R, const_vector(entry["xyz"])))]
+        R = mat_mul(R, const_matrix(rpy_matrix(entry["rpy"])))
+        axis, joint_point = None, None
+        if entry["type"] != FIXED:
+            # the joint axis in the base frame and the point it passes through
+            j = entry["q"]
+            axis = [emitter.bind(x, "a") for x in mat_vec(R, const_vector(entry["axis"]))]
+            joint_point = p = [emitter.bind(x, "p") for x in p]
+            if entry["type"] == REVOLUTE:
+                if j not in sines:
+                    sines[j] = emitter.raw("s%d" % j, "std::sin(q[%d])" % j)
+                    cosines[j] = emitter.raw("c%d" % j, "std::cos(q[%d])" % j)
+                R = mat_mul(R, axis_rotation(entry["axis"], cosines[j], sines[j]))
+            else:
+                p = [a + b * Poly.var("q[%d]" % j) for a, b in zip(p, axis)]
+        rotations.append([[emitter.bind(x, "r") for x in row] for row in R])
+        positions.append([emitter.bind(x, "p") for x in p])
+        axes.append(axis)
+        joint_points.append(joint_point)
+
+    def chain(entry_index):
+        entries = []
+        while entry_index >= 0:
+            if model["tree"][entry_index]["type"] != FIXED:
+                entries.append(entry_index)
+            entry_index = model["tree"][entry_index]["parent"]
+        return list(reversed(entries))
+
+    position_out, jacobian_out, velocity_out = [], [], []
+    chains = []
+    for e, entry_index in enumerate(model["end_effector_entries"]):
+        end = positions[entry_index]
+        position_out += ["p[%d] = %s;" % (3 * e + k, end[k].code()) for k in range(3)]
+        velocity = [Poly() for _ in range(3)]
+        columns = set()
+        for i in chain(entry_index):
+            entry = model["tree"][i]
+            axis = axes[i]
+            if entry["type"] == REVOLUTE:
+                column = cross(axis, [end[k] - joint_points[i][k] for k in range(3)])
+            else:
+                column = axis
+            column = [emitter.bind(x, "j") for x in column]
+            columns.add(entry["q"])
+            for k in range(3):
+                jacobian_out.append("J[%d] = %s;" % ((3 * e + k) * n + entry["q"], column[k].code()))
+                velocity[k] = velocity[k] + column[k] * Poly.var("dq[%d]" % entry["q"])
+        velocity_out += ["v[%d] = %s;" % (3 * e + k, velocity[k].code()) for k in range(3)]
+        chains.append([1 if j in columns else 0 for j in range(n)])
+    return emitter, position_out, velocity_out, jacobian_out, chains
+
+
+def function(name, signature, emitter, outputs, prologue=""):
+    lines = ["void %s(%s)" % (name, signature), "{"]
+    if prologue:
+        lines.append("    " + prologue)
+    for variable, expression in emitter.needed(outputs):
+        lines.append("    const double %s = %s;" % (variable, expression))
+    lines += ["    " + output for output in outputs]
+    lines.append("}")
+    return "\n".join(lines)
+
+
+HEADER = """// Generated by scripts/generate_kinematics.py from the URDF and base.yaml of each robot, do not edit.
+"""
+
+
+def main():
+    if len(sys.argv) != 4:
+        print("Usage: %s <models_dir> <robots_dir> <output_dir>" % sys.argv[0])
+        return 1
+    models_dir, robots_dir, output_dir = sys.argv[1:]
+    models = []
+    try:
+        for path in sorted(glob.glob(os.path.join(models_dir, "*", "base.yaml"))):
+            model = load_robot(models_dir, robots_dir, os.path.basename(os.path.dirname(path)))
+            if model:
+                models.append(model)
+    except (GeneratorError, yaml.YAMLError, ET.ParseError) as e:
+        print("generate_kinematics: %s" % e)
+        return 1
+
+    header = [HEADER, "#ifndef ROBOT_KINEMATICS_GENERATED_HPP", "#define ROBOT_KINEMATICS_GENERATED_HPP", "",
+              "// fixed-size entry points, also reachable by robot name through FindRobotKinematics()",
+              "namespace kinematics", "{"]
+    source = [HEADER, '#include "robot_kinematics.hpp"', '#include "robot_kinematics_generated.hpp"', "#include <cmath>",
+              "#include <cstring>", ""]
+    table = []
+    for model in models:
+        name = model["identifier"]
+        n = len(model["joint_names"])
+        m = len(model["end_effectors"])
+        emitter, position_out, velocity_out, jacobian_out, chains = generate_robot(model)
+        header += ["    namespace %s" % name, "    {",
+                   "        constexpr int num_joints = %d;" % n,
+                   "        constexpr int num_end_effectors = %d;" % m,
+                   "        void Positions(const double q[num_joints], double p[3 * num_end_effectors]);",
+                   "        void Velocities(const double q[num_joints], const double dq[num_joints], double v[3 * num_end_effectors]);",
+                   "        void Jacobians(const double q[num_joints], double J[3 * num_end_effectors * num_joints]);",
+                   "    }"]
+        source.append(function("kinematics::%s::Positions" % name, "const double q[%d], double p[%d]" % (n, 3 * m), emitter, position_out))
+        source.append("")
+        source.append(function("kinematics::%s::Velocities" % name, "const double q[%d], const double dq[%d], double v[%d]" % (n, n, 3 * m),
+                               emitter, velocity_out))
+        source.append("")
+        source.append(function("kinematics::%s::Jacobians" % name, "const double q[%d], double J[%d]" % (n, 3 * m * n), emitter, jacobian_out,
+                               "memset(J, 0, sizeof(double) * %d);" % (3 * m * n)))
+        source.append("")
+
+        source.append("static const char *const %s_joint_names[] = {%s};" % (name, ", ".join('"%s"' % x for x in model["joint_names"])))
+        source.append("static const char *const %s_end_effectors[] = {%s};" % (name, ", ".join('"%s"' % x for x in model["end_effectors"])))
+        source.append("static const int %s_chains[] = {%s};" % (name, ", ".join(str(x) for row in chains for x in row)))
+        source.append("static const KinematicsLink %s_tree[] = {" % name)
+        for entry in model["tree"]:
+            source.append("    {%d, %d, %d, {%s}, {%s}, {%s}}, // %s" % (
+                entry["parent"], entry["type"], entry["q"], ", ".join(number(x) for x in entry["xyz"]),
+                ", ".join(number(x) for x in entry["rpy"]), ", ".join(number(x) for x in entry["axis"]), entry["link"]))
+        source.append("};")
+        source.append("static const int %s_end_effector_links[] = {%s};" % (name, ", ".join(str(x) for x in model["end_effector_entries"])))
+        source.append("static const KinematicsJointLimits %s_joint_limits[] = {" % name)
+        for controller, limits in zip(model["joint_names"], model["limits"]):
+            source.append("    {%d, %s}, // %s" % (limits[0], ", ".join(number(x) for x in limits[1:]), controller))
+        source.append("};")
+        source.append("")
+        table.append("    {\"%s\", %d, %d, %s_joint_names, %s_end_effectors, %s_chains,\n"
+                     "     kinematics::%s::Positions, kinematics::%s::Velocities, kinematics::%s::Jacobians,\n"
+                     "     %d, %s_tree, %s_end_effector_links, %s_joint_limits}," % (
+                         model["robot"], n, m, name, name, name, name, name, name, len(model["tree"]), name, name, name))
+    header += ["}", "", "#endif // ROBOT_KINEMATICS_GENERATED_HPP", ""]
+    source.append("const RobotKinematics robot_kinematics[] = {")
+    source += table
+    source.append("    {nullptr, 0, 0, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, nullptr, nullptr, nullptr},")
+    source.append("};")
+    source.append("const int num_robot_kinematics = %d;" % len(models))
+    source.append("")
+
+    os.makedirs(output_dir, exist_ok=True)
+    for name, lines in (("robot_kinematics_generated.hpp", header), ("robot_kinematics_generated.cpp", source)):
+        with open(os.path.join(output_dir, name), "w") as f:
+            f.write("\n".join(lines))
+    print("generate_kinematics: %s" % ", ".join("%s (%d joints, %d end effectors)" % (
+        m["robot"], len(m["joint_names"]), len(m["end_effectors"])) for m in models))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
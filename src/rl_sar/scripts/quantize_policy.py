@@ -0,0 +1,203 @@
+# Copyright (c) 2024-2025 Ziqi Fan
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Dynamic int8 quantization of a policy's Linear layers, behind an accuracy gate.
+
+The policy inputs recorded with the O key ($ROS_HOME/rl_sar/recordings/<robot>/<config>/inputs_*.pt,
+~/.ros when ROS_HOME is unset) are replayed through the fp32 and the int8 policy one tick at a
+time. The int8 model is only written, next to the original as <model>_int8.pt, when no action
+deviates by more than --threshold. Latency and memory of both models are reported either way,
+and with --report also written to models/<robot>/<config>/int8_report.txt to be committed
+with the model. Set precision: "int8" in the config.yaml to run the quantized model.
+
+    python scripts/quantize_policy.py go2/himloco gr1t1/legged_gym --threshold 0.05 --report
+"""
+
+import os
+import sys
+import glob
+import time
+import argparse
+import platform
+import shutil
+import tempfile
+import yaml
+import torch
+
+BASE_PATH = os.path.join(os.path.dirname(__file__), "../")
+
+def default_engine():
+    # qnnpack is the int8 backend for ARM, fbgemm for x86; rl_sdk makes the same choice
+    return "qnnpack" if platform.machine() in ("aarch64", "arm64", "armv7l") else "fbgemm"
+
+def rss_bytes():
+    with open("/proc/self/statm") as f:
+        return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+
+def load_config(robot_path):
+    config_path = os.path.join(BASE_PATH, "models", robot_path, "config.yaml")
+    with open(config_path, "r") as f:
+        return yaml.safe_load(f)[robot_path]
+
+def recordings_dir(robot_path):
+    # InputRecorder::DefaultDirectory
+    ros_home = os.environ.get("ROS_HOME") or os.path.join(os.path.expanduser("~"), ".ros")
+    return os.path.join(ros_home, "rl_sar", "recordings", robot_path)
+
+def recorded_inputs(directory):
+    # each recording is a tuple with one tensor per policy input, stacked along a new first dimension
+    recordings = []
+    for path in sorted(glob.glob(os.path.join(directory, "inputs_*.pt"))):
+        recording = torch.load(path)
+        if recordings and [t.shape[1:] for t in recording] != [t.shape[1:] for t in recordings[0]]:
+            print(f"{path}: recorded for another policy signature, skipped")
+            continue
+        recordings.append(recording)
+    if not recordings:
+        return None
+    return tuple(torch.cat(columns, 0) for columns in zip(*recordings))
+
+def synthetic_inputs(config, count):
+    # bound like PolicyInputs does from policy_inputs, values spread over the clipped range
+    num_observations = config["num_observations"]
+    history_length = len(config.get("observations_history") or [])
+    hidden_shapes = config.get("hidden_states") or []
+    clip = config["clip_obs"]
+    declared = config.get("policy_inputs") or [{"source": "history" if history_length else "obs"}]
+    if not any(entry["source"] == "hidden_state" for entry in declared):
+        declared = declared + [{"source": "hidden_state", "index": i} for i in range(len(hidden_shapes))]
+    inputs = []
+    for entry in declared:
+        if entry["source"] == "hidden_state":
+            inputs.append(torch.zeros(count, *hidden_shapes[entry["index"]]))
+            continue
+        if entry["source"] == "history":
+            shape = (1, history_length, num_observations) if entry.get("layout") == "stacked" else (1, history_length * num_observations)
+        elif entry["source"] == "commands":
+            shape = (1, 3)
+        else:
+            shape = (1, num_observations)
+        inputs.append(torch.clamp(torch.randn(count, *shape), -clip, clip))
+    return tuple(inputs)
+
+def replay(model, inputs, warmup=10):
+    # one tick at a time like the runtime; recurrent policies return (actions, hidden states...)
+    count = inputs[0].shape[0]
+    actions = []
+    latencies = []
+    with torch.no_grad():
+        for i in range(min(warmup, count)):
+            model(*(t[i] for t in inputs))
+        for i in range(count):
+            tick = tuple(t[i] for t in inputs)
+            start = time.perf_counter()
+            output = model(*tick)
+            latencies.append((time.perf_counter() - start) * 1e3)
+            actions.append(output[0] if isinstance(output, tuple) else output)
+    latencies = torch.tensor(latencies)
+    return torch.cat(actions, 0), latencies.mean().item(), torch.quantile(latencies, 0.99).item()
+
+def load_measured(path, inputs):
+    # resident memory the loaded and warmed up model adds, next to its size on disk
+    before = rss_bytes()
+    model = torch.jit.load(path, map_location="cpu").eval()
+    with torch.no_grad():
+        model(*(t[0] for t in inputs))
+    return model, rss_bytes() - before, os.path.getsize(path)
+
+def quantize(model):
+    quantized = torch.ao.quantization.quantize_dynamic_jit(model, {"": torch.ao.quantization.default_dynamic_qconfig})
+    if "quantized::linear_dynamic" not in str(quantized.inlined_graph):
+        raise RuntimeError("no Linear layer was quantized")
+    return quantized
+
+def report(lines, line):
+    print(f"  {line}")
+    lines.append(line)
+
+def measured(name, latency_mean, latency_p99, rss, size):
+    return (f"{name}: latency mean {latency_mean:.3f}ms p99 {latency_p99:.3f}ms, "
+            f"file {size / 1024:.0f}KiB, resident +{rss / 1024:.0f}KiB")
+
+def write_report(model_dir, robot_path, args, lines):
+    path = os.path.join(model_dir, "int8_report.txt")
+    with open(path, "w") as f:
+        f.write(f"{robot_path}, {platform.machine()}, torch {torch.__version__}, engine {args.engine}, {args.threads} threads\n")
+        f.write("\n".join(lines) + "\n")
+    print(f"  report written to {path}")
+
+def process(robot_path, args):
+    config = load_config(robot_path)
+    model_dir = os.path.join(BASE_PATH, "models", robot_path)
+    model_path = os.path.join(model_dir, config["model_name"])
+    output_path = os.path.splitext(model_path)[0] + "_int8.pt"
+    print(f"{robot_path}: {config['model_name']}")
+    lines = []
+
+    directory = os.path.join(args.recordings, robot_path) if args.recordings else recordings_dir(robot_path)
+    inputs = recorded_inputs(directory)
+    if inputs is None:
+        if not args.synthetic:
+            print(f"  no recordings in {directory}, press O while the policy runs or pass --synthetic N")
+            return False
+        report(lines, f"no recordings, gating on {args.synthetic} synthetic ticks")
+        inputs = synthetic_inputs(config, args.synthetic)
+    if args.ticks and inputs[0].shape[0] > args.ticks:
+        inputs = tuple(t[:args.ticks] for t in inputs)
+
+    fp32_model, fp32_rss, fp32_size = load_measured(model_path, inputs)
+    fp32_actions, fp32_mean, fp32_p99 = replay(fp32_model, inputs)
+    report(lines, measured("fp32", fp32_mean, fp32_p99, fp32_rss, fp32_size))
+
+    try:
+        quantized = quantize(fp32_model)
+    except Exception as e:
+        report(lines, f"rejected: quantization failed: {e}")
+        if args.report:
+            write_report(model_dir, robot_path, args, lines)
+        return False
+    # measure the saved model as the runtime loads it, not the one quantization left behind
+    with tempfile.TemporaryDirectory() as directory:
+        temporary_path = os.path.join(directory, "int8.pt")
+        torch.jit.save(quantized, temporary_path)
+        del quantized
+        int8_model, int8_rss, int8_size = load_measured(temporary_path, inputs)
+        int8_actions, int8_mean, int8_p99 = replay(int8_model, inputs)
+        report(lines, measured("int8", int8_mean, int8_p99, int8_rss, int8_size))
+
+        error = (int8_actions - fp32_actions).abs()
+        report(lines, f"action error over {inputs[0].shape[0]} ticks: mean {error.mean().item():.5f} "
+                      f"max {error.max().item():.5f}, threshold {args.threshold}")
+        passed = error.max().item() <= args.threshold
+        if passed:
+            shutil.copyfile(temporary_path, output_path)
+        report(lines, f"passed, wrote {os.path.basename(output_path)}" if passed else
+                      f"rejected, {os.path.basename(output_path)} not written")
+    if args.report:
+        write_report(model_dir, robot_path, args, lines)
+    return passed
+
+def main():
+    parser = argparse.ArgumentParser(description="Quantize policies to dynamic int8 and gate them on recorded inputs")
+    parser.add_argument("robot_paths", nargs="+", help="<robot>/<config>, e.g. go2/himloco")
+    parser.add_argument("--threshold", type=float, default=0.05, help="largest accepted action deviation")
+    parser.add_argument("--engine", default=default_engine(), help="quantized engine, qnnpack on ARM, fbgemm on x86")
+    parser.add_argument("--threads", type=int, default=4, help="intra-op threads, as set by rl_real")
+    parser.add_argument("--ticks", type=int, default=0, help="replay at most this many recorded ticks")
+    parser.add_argument("--synthetic", type=int, default=0, help="gate on this many random ticks when nothing was recorded")
+    parser.add_argument("--recordings", default="", help="directory holding <robot>/<config>/inputs_*.pt, $ROS_HOME/rl_sar/recordings by default")
+    parser.add_argument("--report", action="store_true", help="write the results to models/<robot>/<config>/int8_report.txt")
+    args = parser.parse_args()
+
+    if args.engine not in torch.backends.quantized.supported_engines:
+        print(f"engine {args.engine} is not supported by this torch build: {torch.backends.quantized.supported_engines}")
+        sys.exit(1)
+    torch.backends.quantized.engine = args.engine
+    torch.set_num_threads(args.threads)
+
+    passed = [process(robot_path, args) for robot_path in args.robot_paths]
+    sys.exit(0 if all(passed) else 1)
+
+if __name__ == "__main__":
+    main()
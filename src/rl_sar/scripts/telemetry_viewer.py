@@ -0,0 +1,191 @@
+# Copyright (c) 2024-2025 Ziqi Fan
+# SPDX-License-Identifier: Apache-2.0
+
+# Live joint plots from the shared-memory ring the controller fills when PLOT is defined
+# (library/core/telemetry_ring/telemetry_ring.hpp). Runs as its own process, so rendering
+# never touches the control loop; start and stop it at any time.
+
+import os
+import mmap
+import math
+import argparse
+import numpy as np
+from matplotlib import pyplot as plt
+from matplotlib.animation import FuncAnimation
+
+# layout of telemetry_ring.hpp
+MAGIC = 0x4c54524c
+VERSION = 1
+MAX_JOINTS = 32
+NAME_SIZE = 32
+HEADER_SIZE = 1088
+SAMPLE_SIZE = 800 # end of tau_target, slots may be padded beyond it
+HEADER_DTYPE = np.dtype({
+    "names": ["magic", "version", "num_joints", "capacity", "sample_size", "pid", "dt", "head"],
+    "formats": ["<u4", "<u4", "<u4", "<u4", "<u4", "<u4", "<f8", "<u8"],
+    "offsets": [0, 4, 8, 12, 16, 20, 24, 32],
+    "itemsize": 64,
+})
+JOINTS = (np.float32, MAX_JOINTS)
+
+FIELDS = {
+    "q": ("q", "q_target", "rad"),
+    "dq": ("dq", "dq_target", "rad/s"),
+    "tau": ("tau_est", "tau_target", "Nm"),
+}
+
+
+def sample_dtype(sample_size):
+    return np.dtype({
+        "names": ["seq", "tick", "time", "control_state", "q", "dq", "tau_est", "q_target", "dq_target", "tau_target"],
+        "formats": ["<u8", "<u8", "<f8", "<i4", JOINTS, JOINTS, JOINTS, JOINTS, JOINTS, JOINTS],
+        "offsets": [0, 8, 16, 24, 32, 160, 288, 416, 544, 672],
+        "itemsize": sample_size,
+    })
+
+
+class TelemetryReader:
+    def __init__(self, name):
+        self.path = os.path.join("/dev/shm", name.lstrip("/"))
+        self.mm = None
+        self.last_head = 0
+
+    def attach(self):
+        try:
+            with open(self.path, "rb") as f:
+                size = os.fstat(f.fileno()).st_size
+                if size < HEADER_SIZE:
+                    return False
+                mm = mmap.mmap(f.fileno(), size, access=mmap.ACCESS_READ)
+        except OSError:
+            return False
+        header = np.frombuffer(mm, dtype=HEADER_DTYPE, count=1)[0].copy()
+        capacity, sample_size = int(header["capacity"]), int(header["sample_size"])
+        # never index past the object, a header written by another build must not crash the viewer
+        if (header["magic"] != MAGIC or header["version"] != VERSION or header["num_joints"] > MAX_JOINTS or
+                capacity == 0 or sample_size < SAMPLE_SIZE or size < HEADER_SIZE + capacity * sample_size):
+            mm.close()
+            return False
+        self.mm = mm
+        self.header = np.frombuffer(mm, dtype=HEADER_DTYPE, count=1)
+        self.num_joints = int(header["num_joints"])
+        self.capacity = capacity
+        self.dt = float(header["dt"])
+        self.pid = int(header["pid"])
+        names = np.frombuffer(mm, dtype=np.uint8, count=MAX_JOINTS * NAME_SIZE, offset=64).reshape(MAX_JOINTS, NAME_SIZE)
+        self.joint_names = [bytes(row).split(b"\0")[0].decode() or f"joint {i}" for i, row in enumerate(names[:self.num_joints])]
+        self.slots = np.frombuffer(mm, dtype=sample_dtype(sample_size), count=self.capacity, offset=HEADER_SIZE)
+        self.last_head = 0
+        return True
+
+    def read(self, max_samples):
+        """Returns the complete samples published since the last call, oldest first, and
+        whether the controller exited or restarted, in which case attach() has to be called again."""
+        if self.header["magic"][0] != MAGIC:
+            return None, True
+        head = int(self.header["head"][0])
+        if int(self.header["pid"][0]) != self.pid or head < self.last_head:
+            return None, True
+        # the slot of sample `head` is being overwritten, so at most capacity - 1 are readable
+        start = max(self.last_head, head - self.capacity + 1, head - max_samples)
+        if start >= head:
+            return None, False
+        index = np.arange(start, head, dtype=np.uint64)
+        slot = (index % self.capacity).astype(np.int64)
+        expected = 2 * index + 2
+        seq_before = self.slots["seq"][slot].copy()
+        samples = self.slots[slot].copy()
+        seq_after = self.slots["seq"][slot]
+        valid = (seq_before == expected) & (seq_after == expected)
+        self.last_head = head
+        return samples[valid], False
+
+    def detach(self):
+        if self.mm is not None:
+            self.header = self.slots = None
+            self.mm.close()
+            self.mm = None
+
+
+class Viewer:
+    def __init__(self, reader, field, window):
+        self.reader = reader
+        self.measured, self.target, self.unit = FIELDS[field]
+        self.window = window
+        self.figure = None
+
+    def setup(self):
+        n = self.reader.num_joints
+        self.length = max(2, int(self.window / self.reader.dt))
+        self.time = np.full(self.length, np.nan)
+        self.values = np.full((2, self.length, n), np.nan)
+        cols = 3 if n % 3 == 0 else 4
+        rows = math.ceil(n / cols)
+        if self.figure is None:
+            self.figure = plt.figure(figsize=(4 * cols, 2.2 * rows))
+        self.figure.clf()
+        self.lines = []
+        for i in range(n):
+            ax = self.figure.add_subplot(rows, cols, i + 1)
+            real, = ax.plot([], [], "r", linewidth=1, label=self.measured)
+            target, = ax.plot([], [], "b", linewidth=1, label=self.target)
+            ax.set_title(self.reader.joint_names[i], fontsize=8)
+            ax.tick_params(labelsize=7)
+            self.lines.append((ax, real, target))
+        self.lines[0][0].legend(fontsize=7, loc="upper left")
+        self.figure.suptitle(f"{self.measured} / {self.target} [{self.unit}]", fontsize=9)
+        self.figure.tight_layout()
+
+    def append(self, samples):
+        k = min(len(samples), self.length)
+        samples = samples[-k:]
+        self.time = np.roll(self.time, -k)
+        self.values = np.roll(self.values, -k, axis=1)
+        self.time[-k:] = samples["time"]
+        self.values[0, -k:] = samples[self.measured][:, :self.reader.num_joints]
+        self.values[1, -k:] = samples[self.target][:, :self.reader.num_joints]
+
+    def update(self, _):
+        if self.reader.mm is None:
+            if not self.reader.attach():
+                return []
+            self.setup()
+        samples, restarted = self.reader.read(self.length)
+        if restarted:
+            # the controller may have come back with another robot or ring size
+            self.reader.detach()
+            return []
+        if samples is None or len(samples) == 0:
+            return []
+        self.append(samples)
+        t0, t1 = np.nanmin(self.time), np.nanmax(self.time)
+        for i, (ax, real, target) in enumerate(self.lines):
+            real.set_data(self.time, self.values[0, :, i])
+            target.set_data(self.time, self.values[1, :, i])
+            if t1 > t0:
+                ax.set_xlim(t0, t1)
+            low = np.nanmin(self.values[:, :, i])
+            high = np.nanmax(self.values[:, :, i])
+            margin = max(0.05 * (high - low), 1e-3)
+            ax.set_ylim(low - margin, high + margin)
+        return []
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Live joint plots from the rl_sar telemetry ring")
+    parser.add_argument("--name", type=str, default="/rl_sar_telemetry", help="shared memory object")
+    parser.add_argument("--field", type=str, default="q", choices=FIELDS.keys(), help="quantity to plot against its target")
+    parser.add_argument("--window", type=float, default=2.0, help="seconds of history shown")
+    parser.add_argument("--fps", type=float, default=20.0, help="redraw rate")
+    args = parser.parse_args()
+
+    reader = TelemetryReader(args.name)
+    if not reader.attach():
+        print(f"Waiting for {reader.path}, enable PLOT in the controller")
+    viewer = Viewer(reader, args.field, args.window)
+    if reader.mm is not None:
+        viewer.setup()
+    else:
+        viewer.figure = plt.figure()
+    animation = FuncAnimation(viewer.figure, viewer.update, interval=1000.0 / args.fps, cache_frame_data=False)
+    plt.show()
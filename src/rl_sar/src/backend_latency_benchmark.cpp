@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// State-arrival to command latency through a real-robot backend plugin, the same
+// librl_backend_<name>.so rl_real loads, against mcu_emulator in its default answer mode (or a robot
+// on the bench):
+//
+//   rosrun rl_sar mcu_emulator l4w4 [--latency ms --jitter ms]
+//   backend_latency_benchmark l4w4 127.0.0.1 7777 [--chained] [--ticks n] [--period ms] [--dofs n]
+//
+// The loop is timed like rl_real's: without --chained it polls get_state every --period while the
+// backend's own send and receive loops run out of phase with it, like loop_control; with --chained
+// it blocks in wait_state for at most half a period, then sleeps to the next period, like
+// ChainedLoop. Every new state is answered with set_command right away, and "state->set" is the
+// time from the backend's receive stamp to that call; ticks that found no new state are counted as
+// stale. The backend's own "state->command" histogram, printed when it is destroyed, ends at the
+// socket send instead. Exits non-zero when the backend cannot be loaded or started, or no state
+// arrives.
+
+#include "robot_backend_loader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PrintPercentiles(const char *name, std::vector<double> values)
+{
+    if (values.empty())
+    {
+        printf("%-10s no samples\n", name);
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0.0, sq_sum = 0.0;
+    for (double v : values)
+    {
+        sum += v;
+        sq_sum += v * v;
+    }
+    const double mean = sum / values.size();
+    const double jitter = std::sqrt(std::max(sq_sum / values.size() - mean * mean, 0.0));
+    auto pick = [&](double p) { return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))]; };
+    printf("%-10s us: mean %7.1f  jitter %6.1f  p50 %7.1f  p90 %7.1f  p99 %7.1f  p99.9 %7.1f  max %7.1f\n", name, mean, jitter,
+           pick(0.5), pick(0.9), pick(0.99), pick(0.999), values.back());
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <backend> [backend args] [--chained] [--ticks n] [--period ms] [--dofs n]\n", argv[0]);
+        return 1;
+    }
+    bool chained = false;
+    int ticks = 10000, dofs = 12;
+    double period_ms = 2.0;
+    std::vector<char *> backend_args;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--chained") chained = true;
+        else if (arg == "--ticks" && i + 1 < argc) ticks = atoi(argv[++i]);
+        else if (arg == "--period" && i + 1 < argc) period_ms = atof(argv[++i]);
+        else if (arg == "--dofs" && i + 1 < argc) dofs = atoi(argv[++i]);
+        else backend_args.push_back(argv[i]);
+    }
+
+    const rl_backend_api *api = LoadBackend(argv[1]);
+    if (!api)
+    {
+        return 1;
+    }
+    rl_backend_info info = {};
+    rl_backend *backend = api->create(backend_args.size(), backend_args.data(), &info);
+    if (!backend)
+    {
+        printf("Usage: %s %s %s\n", argv[0], argv[1], api->usage);
+        return 1;
+    }
+    chained = chained && api->wait_state;
+    rl_backend_config config = {};
+    config.num_of_dofs = std::min(std::max(dofs, 1), RL_BACKEND_MAX_MOTORS);
+    config.dt = period_ms * 1e-3;
+    config.flags = chained ? RL_BACKEND_FLAG_CHAINED : 0;
+    if (api->start(backend, &config) != 0)
+    {
+        printf("backend %s failed to start\n", api->name);
+        api->destroy(backend);
+        return 1;
+    }
+
+    // a passive hold, the emulator answers it like any other command
+    rl_backend_command command = {};
+    command.num_motors = config.num_of_dofs;
+    for (int i = 0; i < command.num_motors; ++i)
+    {
+        command.kp[i] = 20.0;
+        command.kd[i] = 0.5;
+    }
+    rl_backend_state state = {};
+    const int64_t period_ns = static_cast<int64_t>(period_ms * 1e6);
+    std::vector<double> state_to_set;
+    state_to_set.reserve(ticks);
+    uint64_t last_sequence = 0;
+    int stale = 0;
+    int64_t next = NowNs();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        if (chained)
+        {
+            api->wait_state(backend, period_ns / 2000);
+        }
+        api->get_state(backend, &state);
+        const bool fresh = state.sequence != last_sequence;
+        last_sequence = state.sequence;
+        command.q[0] = 0.1 * std::sin(tick * 0.01);
+        const int64_t set = NowNs();
+        api->set_command(backend, &command);
+
+        // skip the first ticks while the link comes up
+        if (tick >= 10)
+        {
+            if (fresh)
+            {
+                state_to_set.push_back((set - state.stamp) * 1e-3);
+            }
+            else
+            {
+                ++stale;
+            }
+        }
+
+        next += period_ns;
+        const int64_t wait = next - NowNs();
+        if (wait > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+        }
+        else
+        {
+            next = NowNs(); // do not burst after a stall
+        }
+    }
+    api->destroy(backend);
+
+    printf("%s, %s, %d ticks, period %.2f ms, %d dofs, stale %d\n", api->name, chained ? "chained" : "free-running", ticks, period_ms,
+           config.num_of_dofs, stale);
+    PrintPercentiles("state->set", state_to_set);
+    return state_to_set.empty() ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Unitree A1 over unitree_legged_sdk-3.2 low level UDP
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "robot_backend.hpp"
+#include "logger.hpp"
+#include "loop.hpp"
+#include "latency_histogram.hpp"
+#include "unitree_legged_sdk/comm.h"
+#include "unitree_legged_sdk/udp.h"
+#include "unitree_legged_sdk/safety.h"
+#include "unitree_legged_sdk/unitree_joystick.h"
+
+class A1Backend : public RobotBackend
+{
+public:
+    static RobotBackend *Create(int argc, char **argv, rl_backend_info &info)
+    {
+        if (argc > 0)
+        {
+            return nullptr;
+        }
+        strncpy(info.robot_name, "a1", sizeof(info.robot_name) - 1);
+        strncpy(info.default_rl_config, "legged_gym", sizeof(info.default_rl_config) - 1);
+        return new A1Backend();
+    }
+
+    A1Backend() : unitree_safe(UNITREE_LEGGED_SDK::LeggedType::A1), unitree_udp(UNITREE_LEGGED_SDK::LOWLEVEL)
+    {
+        this->unitree_udp.InitCmdData(this->unitree_low_command);
+    }
+
+    ~A1Backend()
+    {
+        if (this->loop_udpSend)
+        {
+            this->loop_udpSend->shutdown();
+            this->loop_udpRecv->shutdown();
+        }
+    }
+
+    int Start(const rl_backend_config &config) override
+    {
+        this->chained_mode = (config.flags & RL_BACKEND_FLAG_CHAINED) != 0;
+        if (!this->chained_mode)
+        {
+            this->loop_udpSend = std::make_shared<LoopFunc>("loop_udpSend", 0.002, std::bind(&A1Backend::UDPSend, this), 3);
+            this->loop_udpRecv = std::make_shared<LoopFunc>("loop_udpRecv", 0.002, std::bind(&A1Backend::UDPRecv, this), 3);
+            this->loop_udpSend->start();
+            this->loop_udpRecv->start();
+        }
+        return 0;
+    }
+
+    int GetState(rl_backend_state &state) override
+    {
+        // read before GetRecv so the state copied is at least as new as the stamp
+        this->control_state_stamp = this->state_arrival.load(std::memory_order_acquire);
+        state.stamp = this->control_state_stamp;
+        state.sequence = this->state_count.load(std::memory_order_acquire);
+        this->unitree_udp.GetRecv(this->unitree_low_state);
+        memcpy(&this->unitree_joy, this->unitree_low_state.wirelessRemote, 40);
+
+        state.has_remote = 1;
+        state.remote_x = this->unitree_joy.ly;
+        state.remote_y = -this->unitree_joy.lx;
+        state.remote_yaw = -this->unitree_joy.rx;
+        state.remote_request = RL_BACKEND_REQUEST_NONE;
+        if ((int)this->unitree_joy.btn.components.R2 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_GETUP;
+        }
+        else if ((int)this->unitree_joy.btn.components.R1 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_LOCOMOTION;
+        }
+        else if ((int)this->unitree_joy.btn.components.L2 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_GETDOWN;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            state.quaternion[i] = this->unitree_low_state.imu.quaternion[i];
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            state.gyroscope[i] = this->unitree_low_state.imu.gyroscope[i];
+            state.accelerometer[i] = this->unitree_low_state.imu.accelerometer[i];
+        }
+        for (int i = 0; i < 20; ++i)
+        {
+            state.q[i] = this->unitree_low_state.motorState[i].q;
+            state.dq[i] = this->unitree_low_state.motorState[i].dq;
+            state.tau_est[i] = this->unitree_low_state.motorState[i].tauEst;
+        }
+        return 0;
+    }
+
+    int SetCommand(const rl_backend_command &command) override
+    {
+        for (int i = 0; i < command.num_motors && i < 20; ++i)
+        {
+            this->unitree_low_command.motorCmd[i].mode = 0x0A;
+            this->unitree_low_command.motorCmd[i].q = command.q[i];
+            this->unitree_low_command.motorCmd[i].dq = command.dq[i];
+            this->unitree_low_command.motorCmd[i].Kp = command.kp[i];
+            this->unitree_low_command.motorCmd[i].Kd = command.kd[i];
+            this->unitree_low_command.motorCmd[i].tau = command.tau[i];
+        }
+
+        this->unitree_safe.PowerProtect(this->unitree_low_command, this->unitree_low_state, 8);
+        // this->unitree_safe.PositionProtect(this->unitree_low_command, this->unitree_low_state);
+        this->unitree_udp.SetSend(this->unitree_low_command);
+        // published after SetSend so a concurrent send never pairs it with the previous command
+        this->command_state_stamp.store(this->control_state_stamp, std::memory_order_release);
+        if (this->chained_mode)
+        {
+            this->UDPSend();
+            this->answer_pending = true;
+        }
+        return 0;
+    }
+
+    // the MCU answers every command with one state: take the answer to the command SetCommand
+    // sent, which may already be in, and only poll with the current command when none is
+    // pending, i.e. on the first step and after a timeout
+    int WaitState(int64_t timeout_us) override
+    {
+        if (!this->answer_pending)
+        {
+            this->unitree_udp.Recv();
+            this->unitree_udp.Send();
+        }
+        this->answer_pending = false;
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+        bool fresh = false;
+        while (!(fresh = this->unitree_udp.Recv() == 0) && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+        if (fresh)
+        {
+            this->OnState();
+        }
+        return fresh ? 1 : 0;
+    }
+
+private:
+    void OnState()
+    {
+        this->state_arrival.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_release);
+        this->state_count.fetch_add(1, std::memory_order_release);
+    }
+
+    void UDPRecv()
+    {
+        // Recv drains the socket and returns 0 only if a valid state arrived since the last call
+        if (this->unitree_udp.Recv() == 0)
+        {
+            this->OnState();
+        }
+    }
+
+    void UDPSend()
+    {
+        this->unitree_udp.Send();
+        int64_t stamp = this->command_state_stamp.load(std::memory_order_acquire);
+        if (stamp != 0 && stamp != this->sent_state_stamp)
+        {
+            this->sent_state_stamp = stamp;
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            this->latency_histogram.Record(now.time_since_epoch() - std::chrono::steady_clock::duration(stamp), now);
+        }
+    }
+
+    bool chained_mode = false;
+    bool answer_pending = false; // chained mode: a command went out and its state is not taken yet
+    std::shared_ptr<LoopFunc> loop_udpSend;
+    std::shared_ptr<LoopFunc> loop_udpRecv;
+
+    // state arrival to the send of the first command computed from it, measured at the socket
+    // since in the loop mode the command leaves up to one send period after SetCommand
+    std::atomic<int64_t> state_arrival{0};       // steady_clock ticks of the newest state
+    std::atomic<uint64_t> state_count{0};
+    std::atomic<int64_t> command_state_stamp{0}; // arrival of the state behind the current command
+    int64_t control_state_stamp = 0;             // control thread only
+    int64_t sent_state_stamp = 0;                // send thread only
+    LatencyHistogram latency_histogram{"a1 state->command"};
+
+    UNITREE_LEGGED_SDK::Safety unitree_safe;
+    UNITREE_LEGGED_SDK::UDP unitree_udp;
+    UNITREE_LEGGED_SDK::LowCmd unitree_low_command = {0};
+    UNITREE_LEGGED_SDK::LowState unitree_low_state = {0};
+    xRockerBtnDataStruct unitree_joy;
+};
+
+RL_BACKEND_EXPORT(A1Backend, "a1", "", true)
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Unitree Go2/Go2W over unitree_sdk2 DDS
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <string>
+#include <thread>
+#include "robot_backend.hpp"
+#include "logger.hpp"
+#include "crc32.hpp"
+#include "triple_buffer.hpp"
+#include "link_monitor.hpp"
+#include <unitree/robot/channel/channel_publisher.hpp>
+#include <unitree/robot/channel/channel_subscriber.hpp>
+#include <unitree/idl/go2/LowState_.hpp>
+#include <unitree/idl/go2/LowCmd_.hpp>
+#include <unitree/idl/go2/WirelessController_.hpp>
+#include <unitree/robot/b2/motion_switcher/motion_switcher_client.hpp>
+
+using namespace unitree::robot;
+using namespace unitree::robot::b2;
+#define TOPIC_LOWCMD "rt/lowcmd"
+#define TOPIC_LOWSTATE "rt/lowstate"
+#define TOPIC_JOYSTICK "rt/wirelesscontroller"
+constexpr double PosStopF = (2.146E+9f);
+constexpr double VelStopF = (16000.0f);
+
+// 遥控器键值联合体
+typedef union
+{
+    struct
+    {
+        uint8_t R1 : 1;
+        uint8_t L1 : 1;
+        uint8_t start : 1;
+        uint8_t select : 1;
+        uint8_t R2 : 1;
+        uint8_t L2 : 1;
+        uint8_t F1 : 1;
+        uint8_t F2 : 1;
+        uint8_t A : 1;
+        uint8_t B : 1;
+        uint8_t X : 1;
+        uint8_t Y : 1;
+        uint8_t up : 1;
+        uint8_t right : 1;
+        uint8_t down : 1;
+        uint8_t left : 1;
+    } components;
+    uint16_t value;
+} xKeySwitchUnion;
+
+// DDS messages as published by the subscriber threads, with their arrival time
+struct Go2LowStateSnapshot
+{
+    unitree_go::msg::dds_::LowState_ state{};
+    std::chrono::steady_clock::time_point stamp;
+    uint64_t count = 0;
+};
+
+struct Go2JoystickSnapshot
+{
+    unitree_go::msg::dds_::WirelessController_ joystick{};
+    std::chrono::steady_clock::time_point stamp;
+    uint64_t count = 0;
+};
+
+class Go2Backend : public RobotBackend
+{
+public:
+    static RobotBackend *Create(int argc, char **argv, rl_backend_info &info)
+    {
+        if (argc < 1 || argc > 2)
+        {
+            return nullptr;
+        }
+        bool wheel_mode = argc > 1 && std::string(argv[1]) == "wheel";
+        if (wheel_mode)
+        {
+            strncpy(info.robot_name, "go2w", sizeof(info.robot_name) - 1);
+            strncpy(info.default_rl_config, "robot_lab", sizeof(info.default_rl_config) - 1);
+        }
+        else
+        {
+            strncpy(info.robot_name, "go2", sizeof(info.robot_name) - 1);
+            strncpy(info.default_rl_config, "himloco", sizeof(info.default_rl_config) - 1);
+        }
+        return new Go2Backend(argv[0]);
+    }
+
+    Go2Backend(const std::string &network_interface) : network_interface(network_interface) {}
+
+    int Start(const rl_backend_config &config) override
+    {
+        {
+            robot_backend::StartupStep step(config, "go2 dds init");
+            ChannelFactory::Instance()->Init(0, this->network_interface);
+        }
+        // releasing the sport service takes RPC round trips to the robot and needs none of our
+        // channels, so it runs while they are created
+        std::future<void> released = std::async(std::launch::async, [this, &config]()
+        {
+            robot_backend::StartupStep step(config, "go2 motion service release");
+            this->ReleaseMotionService();
+        });
+        {
+            robot_backend::StartupStep step(config, "go2 channels");
+            this->InitLowCmd();
+            // create lowcmd publisher
+            this->lowcmd_publisher.reset(new ChannelPublisher<unitree_go::msg::dds_::LowCmd_>(TOPIC_LOWCMD));
+            this->lowcmd_publisher->InitChannel();
+            // create lowstate subscriber
+            this->lowstate_subscriber.reset(new ChannelSubscriber<unitree_go::msg::dds_::LowState_>(TOPIC_LOWSTATE));
+            this->lowstate_subscriber->InitChannel(std::bind(&Go2Backend::LowStateMessageHandler, this, std::placeholders::_1), 1);
+            // create joystick subscriber
+            this->joystick_subscriber.reset(new ChannelSubscriber<unitree_go::msg::dds_::WirelessController_>(TOPIC_JOYSTICK));
+            this->joystick_subscriber->InitChannel(std::bind(&Go2Backend::JoystickHandler, this, std::placeholders::_1), 1);
+        }
+        released.get();
+        return 0;
+    }
+
+    int GetState(rl_backend_state &state) override
+    {
+        const Go2LowStateSnapshot &low_state = this->low_state_buffer.Read();
+        if (low_state.count > 0)
+        {
+            this->low_state_monitor.OnConsume(low_state.stamp);
+        }
+        state.stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(low_state.stamp.time_since_epoch()).count();
+        state.sequence = low_state.count;
+        const unitree_go::msg::dds_::LowState_ &unitree_low_state = low_state.state;
+        const unitree_go::msg::dds_::WirelessController_ &joystick = this->joystick_buffer.Read().joystick;
+        this->unitree_joy.value = joystick.keys();
+
+        state.has_remote = 1;
+        state.remote_x = joystick.ly();
+        state.remote_y = -joystick.lx();
+        state.remote_yaw = -joystick.rx();
+        state.remote_request = RL_BACKEND_REQUEST_NONE;
+        if ((int)this->unitree_joy.components.R2 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_GETUP;
+        }
+        else if ((int)this->unitree_joy.components.R1 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_LOCOMOTION;
+        }
+        else if ((int)this->unitree_joy.components.L2 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_GETDOWN;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            state.quaternion[i] = unitree_low_state.imu_state().quaternion()[i];
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            state.gyroscope[i] = unitree_low_state.imu_state().gyroscope()[i];
+            state.accelerometer[i] = unitree_low_state.imu_state().accelerometer()[i];
+        }
+        for (int i = 0; i < 20; ++i)
+        {
+            state.q[i] = unitree_low_state.motor_state()[i].q();
+            state.dq[i] = unitree_low_state.motor_state()[i].dq();
+            state.tau_est[i] = unitree_low_state.motor_state()[i].tau_est();
+        }
+        return 0;
+    }
+
+    int SetCommand(const rl_backend_command &command) override
+    {
+        for (int i = 0; i < command.num_motors && i < 20; ++i)
+        {
+            this->unitree_low_command.motor_cmd()[i].mode() = 0x01;
+            this->unitree_low_command.motor_cmd()[i].q() = command.q[i];
+            this->unitree_low_command.motor_cmd()[i].dq() = command.dq[i];
+            this->unitree_low_command.motor_cmd()[i].kp() = command.kp[i];
+            this->unitree_low_command.motor_cmd()[i].kd() = command.kd[i];
+            this->unitree_low_command.motor_cmd()[i].tau() = command.tau[i];
+        }
+
+        this->unitree_low_command.crc() = crc32::Core((uint32_t *)&unitree_low_command, (sizeof(unitree_go::msg::dds_::LowCmd_) >> 2) - 1);
+        lowcmd_publisher->Write(unitree_low_command);
+        return 0;
+    }
+
+private:
+    void InitLowCmd()
+    {
+        this->unitree_low_command.head()[0] = 0xFE;
+        this->unitree_low_command.head()[1] = 0xEF;
+        this->unitree_low_command.level_flag() = 0xFF;
+        this->unitree_low_command.gpio() = 0;
+
+        for (int i = 0; i < 20; ++i)
+        {
+            this->unitree_low_command.motor_cmd()[i].mode() = (0x01); // motor switch to servo (PMSM) mode
+            this->unitree_low_command.motor_cmd()[i].q() = (PosStopF);
+            this->unitree_low_command.motor_cmd()[i].kp() = (0);
+            this->unitree_low_command.motor_cmd()[i].dq() = (VelStopF);
+            this->unitree_low_command.motor_cmd()[i].kd() = (0);
+            this->unitree_low_command.motor_cmd()[i].tau() = (0);
+        }
+    }
+
+    void ReleaseMotionService()
+    {
+        // init MotionSwitcherClient
+        this->msc.SetTimeout(10.0f);
+        this->msc.Init();
+        // Shut down motion control-related service
+        while(this->QueryMotionStatus(true))
+        {
+            std::cout << "Try to deactivate the motion control-related service." << std::endl;
+            int32_t ret = this->msc.ReleaseMode();
+            if (ret == 0)
+            {
+                std::cout << "ReleaseMode succeeded." << std::endl;
+            }
+            else
+            {
+                std::cout << "ReleaseMode failed. Error code: " << ret << std::endl;
+            }
+            // the service stops shortly after ReleaseMode returns, poll for it instead of
+            // sleeping a whole second before checking again
+            for (int i = 0; i < 20 && this->QueryMotionStatus(false); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+    }
+
+    int QueryMotionStatus(bool verbose)
+    {
+        std::string robotForm, motionName;
+        int motionStatus;
+        int32_t ret = this->msc.CheckMode(robotForm, motionName);
+        if (ret == 0)
+        {
+            if (verbose) std::cout << "CheckMode succeeded." << std::endl;
+        }
+        else
+        {
+            std::cout << "CheckMode failed. Error code: " << ret << std::endl;
+        }
+        if (motionName.empty())
+        {
+            std::cout << "The motion control-related service is deactivated." << std::endl;
+            motionStatus = 0;
+        }
+        else
+        {
+            if (verbose)
+            {
+                std::string serviceName = QueryServiceName(robotForm, motionName);
+                std::cout << "Service: " << serviceName << " is activate" << std::endl;
+            }
+            motionStatus = 1;
+        }
+        return motionStatus;
+    }
+
+    std::string QueryServiceName(std::string form, std::string name)
+    {
+        if (form == "0")
+        {
+            if (name == "normal" )   return "sport_mode";
+            if (name == "ai" )       return "ai_sport";
+            if (name == "advanced" ) return "advanced_sport";
+        }
+        else
+        {
+            if (name == "ai-w" )     return "wheeled_sport(go2W)";
+            if (name == "normal-w" ) return "wheeled_sport(b2W)";
+        }
+        return "";
+    }
+
+    // each subscriber delivers on its own thread, so every buffer has a single producer
+    void LowStateMessageHandler(const void *message)
+    {
+        auto stamp = std::chrono::steady_clock::now();
+        Go2LowStateSnapshot &snapshot = this->low_state_buffer.Back();
+        snapshot.state = *(const unitree_go::msg::dds_::LowState_ *)message;
+        snapshot.stamp = stamp;
+        snapshot.count = ++this->low_state_count;
+        this->low_state_buffer.Publish();
+        this->low_state_monitor.OnPacket(stamp);
+        this->low_state_monitor.OnSequence(snapshot.state.tick());
+    }
+
+    void JoystickHandler(const void *message)
+    {
+        Go2JoystickSnapshot &snapshot = this->joystick_buffer.Back();
+        snapshot.joystick = *(const unitree_go::msg::dds_::WirelessController_ *)message;
+        snapshot.stamp = std::chrono::steady_clock::now();
+        snapshot.count = ++this->joystick_count;
+        this->joystick_buffer.Publish();
+    }
+
+    std::string network_interface;
+    MotionSwitcherClient msc;
+    unitree_go::msg::dds_::LowCmd_ unitree_low_command{};
+    // written only by the subscriber threads, GetState() copies the latest snapshots out
+    TripleBuffer<Go2LowStateSnapshot> low_state_buffer;
+    TripleBuffer<Go2JoystickSnapshot> joystick_buffer;
+    uint64_t low_state_count = 0;
+    uint64_t joystick_count = 0;
+    LinkMonitor low_state_monitor{"go2 lowstate"};
+    ChannelPublisherPtr<unitree_go::msg::dds_::LowCmd_> lowcmd_publisher;
+    ChannelSubscriberPtr<unitree_go::msg::dds_::LowState_> lowstate_subscriber;
+    ChannelSubscriberPtr<unitree_go::msg::dds_::WirelessController_> joystick_subscriber;
+    xKeySwitchUnion unitree_joy;
+};
+
+RL_BACKEND_EXPORT(Go2Backend, "go2", "networkInterface [wheel]", false)
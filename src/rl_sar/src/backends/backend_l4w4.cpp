@@ -0,0 +1,247 @@
+/*
+* Copyright (c) 2024-2025 Ziqi Fan
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+// L4W4 wheel-legged robot over the MCU UDP protocol
+
+// #define UDP_BUSY_POLL
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <sys/epoll.h>
+#include "robot_backend.hpp"
+#include "logger.hpp"
+#include "triple_buffer.hpp"
+#include "link_monitor.hpp"
+#include "l4w4_sdk.hpp"
+
+// Latest decoded MCU packet, published by the udp receive thread
+struct L4W4Snapshot
+{
+    LowState state;
+    std::chrono::steady_clock::time_point stamp; // arrival time of the packet
+    uint64_t count = 0;                          // packets decoded so far
+};
+
+class L4W4Backend : public RobotBackend
+{
+public:
+    // optional MCU address, e.g. "127.0.0.1 7777" to run against mcu_emulator
+    static RobotBackend *Create(int argc, char **argv, rl_backend_info &info)
+    {
+        if (argc > 2)
+        {
+            return nullptr;
+        }
+        strncpy(info.robot_name, "l4w4", sizeof(info.robot_name) - 1);
+        strncpy(info.default_rl_config, "legged_gym", sizeof(info.default_rl_config) - 1);
+        return new L4W4Backend(argc > 0 ? argv[0] : L4W4_MCU_IP, argc > 1 ? atoi(argv[1]) : L4W4_MCU_PORT);
+    }
+
+    L4W4Backend(const std::string &mcu_ip, int mcu_port) : mcu_ip(mcu_ip), mcu_port(mcu_port) {}
+
+    ~L4W4Backend()
+    {
+        this->udp_running = false;
+        if (this->udp_thread.joinable())
+        {
+            this->udp_thread.join();
+        }
+    }
+
+    int Start(const rl_backend_config &config) override
+    {
+        this->l4w4_sdk.InitUDP(this->mcu_ip.c_str(), this->mcu_port);
+        this->l4w4_sdk.InitCmdData(this->l4w4_low_command);
+        this->udp_running = true;
+        this->udp_thread = std::thread(&L4W4Backend::UdpReceiveLoop, this);
+        return 0;
+    }
+
+    int GetState(rl_backend_state &state) override
+    {
+        const L4W4Snapshot &snapshot = this->state_buffer.Read();
+        if (snapshot.count > 0)
+        {
+            this->udp_monitor.OnConsume(snapshot.stamp);
+        }
+        state.stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(snapshot.stamp.time_since_epoch()).count();
+        state.sequence = snapshot.count;
+        if (snapshot.count == 0)
+        {
+            return 0;
+        }
+        const LowState &l4w4_low_state = snapshot.state;
+
+        memcpy(&this->l4w4_joy, l4w4_low_state.wirelessRemote, 40);
+
+        state.has_remote = 1;
+        state.remote_x = this->l4w4_joy.ly * 1.5f;
+        state.remote_y = -this->l4w4_joy.lx * 1.5f;
+        state.remote_yaw = -this->l4w4_joy.rx * 2.0f;
+        state.remote_request = RL_BACKEND_REQUEST_NONE;
+        if ((int)this->l4w4_joy.btn.components.R2 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_GETUP;
+        }
+        else if ((int)this->l4w4_joy.btn.components.R1 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_LOCOMOTION;
+        }
+        else if ((int)this->l4w4_joy.btn.components.L2 == 1)
+        {
+            state.remote_request = RL_BACKEND_REQUEST_GETDOWN;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            state.quaternion[i] = l4w4_low_state.imu.quaternion[i];
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            state.gyroscope[i] = l4w4_low_state.imu.gyroscope[i];
+            state.accelerometer[i] = l4w4_low_state.imu.accelerometer[i];
+        }
+        for (int i = 0; i < 20; ++i)
+        {
+            state.q[i] = l4w4_low_state.motorState[i].q;
+            state.dq[i] = l4w4_low_state.motorState[i].dq;
+            state.tau_est[i] = l4w4_low_state.motorState[i].tauEst;
+        }
+        return 0;
+    }
+
+    int SetCommand(const rl_backend_command &command) override
+    {
+        for (int i = 0; i < command.num_motors && i < 20; ++i)
+        {
+            this->l4w4_low_command.motorCmd[i].mode = 0x0A;
+            this->l4w4_low_command.motorCmd[i].q = command.q[i];
+            this->l4w4_low_command.motorCmd[i].dq = command.dq[i];
+            this->l4w4_low_command.motorCmd[i].Kp = command.kp[i];
+            this->l4w4_low_command.motorCmd[i].Kd = command.kd[i];
+            this->l4w4_low_command.motorCmd[i].tau = command.tau[i];
+        }
+
+        this->l4w4_sdk.SendUDP(this->l4w4_low_command);
+        this->udp_monitor.OnRequest();
+        return 0;
+    }
+
+private:
+    void UdpReceiveLoop()
+    {
+        int epoll_fd = epoll_create1(0);
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = this->l4w4_sdk.client_socket;
+        if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, this->l4w4_sdk.client_socket, &event) < 0)
+        {
+            std::cout << LOGGER::ERROR << "udp receive thread: epoll setup failed: " << strerror(errno) << std::endl;
+            if (epoll_fd >= 0)
+            {
+                close(epoll_fd);
+            }
+            return;
+        }
+#ifdef UDP_BUSY_POLL
+        int busy_poll_us = 50;
+        if (setsockopt(this->l4w4_sdk.client_socket, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us)) < 0)
+        {
+            std::cout << LOGGER::WARNING << "SO_BUSY_POLL not enabled: " << strerror(errno) << std::endl;
+        }
+#endif
+
+        // own buffers so the sender side of l4w4_sdk is never touched from this thread
+        unsigned char buffers[udp_batch][sizeof(this->l4w4_sdk.recv_buff)];
+        struct sockaddr_in addrs[udp_batch];
+        struct iovec iovecs[udp_batch];
+        struct mmsghdr msgs[udp_batch];
+        uint64_t count = 0;
+
+        while (this->udp_running)
+        {
+            struct epoll_event ready;
+            int n = epoll_wait(epoll_fd, &ready, 1, 100);
+            if (n <= 0)
+            {
+                if (n < 0 && errno != EINTR)
+                {
+                    std::cout << LOGGER::ERROR << "udp receive thread: epoll_wait failed: " << strerror(errno) << std::endl;
+                    break;
+                }
+                continue;
+            }
+
+            // drain everything queued, only the newest valid packet is decoded
+            while (true)
+            {
+                for (int i = 0; i < udp_batch; ++i)
+                {
+                    iovecs[i].iov_base = buffers[i];
+                    iovecs[i].iov_len = sizeof(buffers[i]);
+                    memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+                    msgs[i].msg_hdr.msg_name = &addrs[i];
+                    msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+                    msgs[i].msg_hdr.msg_iov = &iovecs[i];
+                    msgs[i].msg_hdr.msg_iovlen = 1;
+                }
+                int received = recvmmsg(this->l4w4_sdk.client_socket, msgs, udp_batch, MSG_DONTWAIT, nullptr);
+                if (received <= 0)
+                {
+                    break;
+                }
+                auto arrival = std::chrono::steady_clock::now();
+
+                int newest = -1;
+                for (int i = 0; i < received; ++i)
+                {
+                    this->udp_monitor.OnPacket(arrival);
+                    if (msgs[i].msg_len < l4w4_codec::STATE_SIZE)
+                    {
+                        this->udp_monitor.OnMalformed();
+                        std::cout << " udp recv_len = " << msgs[i].msg_len << std::endl;
+                    }
+                    else
+                    {
+                        newest = i;
+                    }
+                }
+                if (newest >= 0 && this->l4w4_sdk.AnalyzeUDP(buffers[newest], msgs[newest].msg_len, this->udp_low_state))
+                {
+                    L4W4Snapshot &snapshot = this->state_buffer.Back();
+                    snapshot.state = this->udp_low_state;
+                    snapshot.stamp = arrival;
+                    snapshot.count = ++count;
+                    this->state_buffer.Publish();
+                }
+                if (received < udp_batch)
+                {
+                    break;
+                }
+            }
+        }
+        close(epoll_fd);
+    }
+
+    std::string mcu_ip;
+    int mcu_port;
+    L4W4SDK l4w4_sdk;
+    LowCmd l4w4_low_command = {0};
+    xRockerBtnDataStruct l4w4_joy;
+
+    // udp receive thread, the control thread only reads state_buffer
+    static constexpr int udp_batch = 8;
+    std::thread udp_thread;
+    std::atomic<bool> udp_running{false};
+    TripleBuffer<L4W4Snapshot> state_buffer;
+    LowState udp_low_state = {0};
+    LinkMonitor udp_monitor{"l4w4 udp"};
+};
+
+RL_BACKEND_EXPORT(L4W4Backend, "l4w4", "[mcuIp [mcuPort]]", false)
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Build step: validates models/<robot>/base.yaml and every models/<robot>/<config>/config.yaml
+// and writes them as one binary bundle (library/core/config_bundle/config_bundle.hpp). Any config
+// that the runtime would choke on fails the build with the file and key at fault.
+
+#include "config_bundle.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static std::vector<std::string> ConfigNames(const std::string &robot_dir)
+{
+    std::vector<std::string> names;
+    DIR *dir = opendir(robot_dir.c_str());
+    if (!dir)
+    {
+        return names;
+    }
+    while (struct dirent *entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        struct stat info;
+        if (name[0] != '.' && stat((robot_dir + "/" + name + "/config.yaml").c_str(), &info) == 0)
+        {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        std::cout << "Usage: " << argv[0] << " <models_dir> <robot> <output.bundle>" << std::endl;
+        return 1;
+    }
+    const std::string models_dir = argv[1];
+    const std::string robot_name = argv[2];
+    const std::string output = argv[3];
+    const std::string robot_dir = models_dir + "/" + robot_name;
+
+    try
+    {
+        BaseConfig base;
+        config_bundle::ParseBase(robot_dir + "/base.yaml", robot_name, base);
+
+        std::vector<RLConfig> configs;
+        for (const std::string &config_name : ConfigNames(robot_dir))
+        {
+            const std::string path = robot_dir + "/" + config_name + "/config.yaml";
+            RLConfig config;
+            config_bundle::ParseRL(path, robot_name, config_name, config);
+            config_bundle::CheckPair(path, base, config);
+            struct stat info;
+            if (stat((robot_dir + "/" + config_name + "/" + config.model_name).c_str(), &info) != 0)
+            {
+                // policies are often downloaded separately, only InitRL() needs them
+                std::cout << "config_bundler: warning: " << path << ": model_name: " << config.model_name << " not found" << std::endl;
+            }
+            else if (config_bundle::ModelFile(config) != config.model_name &&
+                     stat((robot_dir + "/" + config_name + "/" + config_bundle::ModelFile(config)).c_str(), &info) != 0)
+            {
+                std::cout << "config_bundler: warning: " << path << ": precision: " << config_bundle::ModelFile(config) << " not found, run scripts/quantize_policy.py" << std::endl;
+            }
+            configs.push_back(config);
+        }
+
+        std::vector<uint8_t> data = config_bundle::Serialize(robot_name, base, configs);
+        // write next to the target and rename, a reader never maps a half written bundle
+        const std::string temporary = output + ".tmp";
+        FILE *file = fopen(temporary.c_str(), "wb");
+        if (!file || fwrite(data.data(), 1, data.size(), file) != data.size() || fclose(file) != 0 || rename(temporary.c_str(), output.c_str()) != 0)
+        {
+            std::cout << "config_bundler: cannot write " << output << std::endl;
+            return 1;
+        }
+        std::cout << "config_bundler: " << robot_name << ": base + " << configs.size() << " configs, " << data.size() << " bytes" << std::endl;
+    }
+    catch (const ConfigError &e)
+    {
+        std::cout << "config_bundler: error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Cost of each crc32 implementation on the message sizes the backends checksum every tick:
+//
+//   crc32_benchmark [calls]
+//
+// The message changes every call and the results are folded into a checksum, so nothing is hoisted.
+
+#include "crc32.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template <typename F>
+static double Time(int calls, F f)
+{
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i)
+    {
+        f(i);
+    }
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / calls;
+}
+
+int main(int argc, char **argv)
+{
+    const int calls = argc > 1 ? atoi(argv[1]) : 200000;
+    struct Message
+    {
+        const char *name;
+        uint32_t words;
+    };
+    const Message messages[] = {
+        {"A1 command", 151},  // (610 >> 2) - 1, see mcu_emulator
+        {"A1 state", 191},    // (771 >> 2) - 1
+        {"Go2 LowCmd_", 202}, // (812 >> 2) - 1
+        {"16 KiB", 4096},
+    };
+    struct Implementation
+    {
+        const char *name;
+        uint32_t (*crc)(const uint32_t *, uint32_t);
+    };
+    const Implementation implementations[] = {
+        {"Bitwise", crc32::Bitwise},
+        {"SliceBy8", crc32::SliceBy8},
+        {"Folding", crc32::Folding},
+    };
+
+    std::mt19937 rng(0);
+    std::vector<uint32_t> buffer(4096 + 1);
+    for (uint32_t &word : buffer) word = static_cast<uint32_t>(rng());
+
+    printf("%d calls, Core uses %s\n", calls, crc32::Implementation());
+    printf("%-20s", "");
+    for (const Implementation &implementation : implementations)
+    {
+        printf("%22s", implementation.name);
+    }
+    printf("\n");
+    uint32_t checksum = 0;
+    for (const Message &message : messages)
+    {
+        printf("%-12s %5u B", message.name, 4 * message.words);
+        for (const Implementation &implementation : implementations)
+        {
+            // the bitwise loop is slow enough to need fewer calls
+            const int n = implementation.crc == crc32::Bitwise ? calls / 20 + 1 : calls;
+            const double ns = Time(n, [&](int i) {
+                buffer[0] = static_cast<uint32_t>(i);
+                checksum ^= implementation.crc(buffer.data(), message.words);
+            });
+            printf("%10.1f ns %5.2f GB/s", ns, 4.0 * message.words / ns);
+        }
+        printf("\n");
+    }
+    printf("checksum %08x\n", checksum);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Checks the generated kinematics of every robot (or the named ones) against the generic tree
+// evaluator and against finite differences of its own positions, then times both:
+//
+//   kinematics_benchmark [robot ...]
+//
+// Exits non-zero when a robot's generated code disagrees with its URDF.
+
+#include "robot_kinematics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static double MaxDifference(const std::vector<double> &a, const std::vector<double> &b)
+{
+    double difference = 0.0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        difference = std::max(difference, std::fabs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+// ns per call of f over a set of joint positions, so nothing is hoisted out of the loop
+template <typename F>
+static double Time(const std::vector<std::vector<double>> &samples, int calls, F f)
+{
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i)
+    {
+        f(samples[i % samples.size()].data());
+    }
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / calls;
+}
+
+static bool Check(const RobotKinematics &kinematics)
+{
+    const int n = kinematics.num_joints;
+    const int m = 3 * kinematics.num_end_effectors;
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> angle(-1.5, 1.5);
+    std::vector<std::vector<double>> samples(64, std::vector<double>(n));
+    for (std::vector<double> &q : samples)
+    {
+        std::generate(q.begin(), q.end(), [&]() { return angle(rng); });
+    }
+
+    double tree_error = 0.0, difference_error = 0.0, velocity_error = 0.0;
+    std::vector<double> p(m), p_tree(m), J(m * n), J_tree(m * n), v(m), dq(n);
+    for (const std::vector<double> &q : samples)
+    {
+        kinematics.positions(q.data(), p.data());
+        KinematicsTreePositions(kinematics, q.data(), p_tree.data());
+        kinematics.jacobians(q.data(), J.data());
+        KinematicsTreeJacobians(kinematics, q.data(), J_tree.data());
+        tree_error = std::max({tree_error, MaxDifference(p, p_tree), MaxDifference(J, J_tree)});
+
+        // central differences of the generated positions, one joint at a time
+        const double h = 1e-6;
+        for (int j = 0; j < n; ++j)
+        {
+            std::vector<double> q_plus = q, q_minus = q, p_plus(m), p_minus(m);
+            q_plus[j] += h;
+            q_minus[j] -= h;
+            kinematics.positions(q_plus.data(), p_plus.data());
+            kinematics.positions(q_minus.data(), p_minus.data());
+            for (int i = 0; i < m; ++i)
+            {
+                difference_error = std::max(difference_error, std::fabs((p_plus[i] - p_minus[i]) / (2.0 * h) - J[i * n + j]));
+            }
+        }
+
+        std::generate(dq.begin(), dq.end(), [&]() { return angle(rng); });
+        kinematics.velocities(q.data(), dq.data(), v.data());
+        for (int i = 0; i < m; ++i)
+        {
+            double expected = 0.0;
+            for (int j = 0; j < n; ++j)
+            {
+                expected += J[i * n + j] * dq[j];
+            }
+            velocity_error = std::max(velocity_error, std::fabs(v[i] - expected));
+        }
+    }
+
+    const double positions_ns = Time(samples, 200000, [&](const double *q) { kinematics.positions(q, p.data()); });
+    const double velocities_ns = Time(samples, 200000, [&](const double *q) { kinematics.velocities(q, q, v.data()); });
+    const double jacobians_ns = Time(samples, 200000, [&](const double *q) { kinematics.jacobians(q, J.data()); });
+    const double tree_positions_ns = Time(samples, 20000, [&](const double *q) { KinematicsTreePositions(kinematics, q, p_tree.data()); });
+    const double tree_jacobians_ns = Time(samples, 20000, [&](const double *q) { KinematicsTreeJacobians(kinematics, q, J_tree.data()); });
+
+    const bool passed = tree_error < 1e-9 && difference_error < 1e-6 && velocity_error < 1e-9;
+    printf("%-8s %2d joints %d end effectors | error tree %.1e, finite differences %.1e, J dq %.1e | "
+           "positions %.0fns (tree %.0fns), velocities %.0fns, jacobians %.0fns (tree %.0fns)%s\n",
+           kinematics.robot_name, n, kinematics.num_end_effectors, tree_error, difference_error, velocity_error,
+           positions_ns, tree_positions_ns, velocities_ns, jacobians_ns, tree_jacobians_ns, passed ? "" : "  FAIL");
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    bool passed = true;
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const RobotKinematics *kinematics = FindRobotKinematics(argv[i]);
+            if (!kinematics)
+            {
+                printf("%s has no kinematics section in its base.yaml\n", argv[i]);
+                passed = false;
+                continue;
+            }
+            passed = Check(*kinematics) && passed;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < num_robot_kinematics; ++i)
+        {
+            passed = Check(robot_kinematics[i]) && passed;
+        }
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Cost of the L4W4 packet codec per call, both directions of both packets:
+//
+//   l4w4_codec_benchmark [calls]
+//
+// The inputs change every call and the outputs are folded into a checksum, so nothing is hoisted.
+
+#include "l4w4_codec.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace l4w4_codec;
+
+// ns per call of f(i)
+template <typename F>
+static double Time(int calls, F f)
+{
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i)
+    {
+        f(i);
+    }
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / calls;
+}
+
+int main(int argc, char **argv)
+{
+    const int calls = argc > 1 ? atoi(argv[1]) : 2000000;
+    const int samples = 64;
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+    std::vector<LowCmd> commands(samples);
+    std::vector<LowState> states(samples);
+    std::vector<std::vector<uint8_t>> command_packets(samples, std::vector<uint8_t>(COMMAND_SIZE));
+    std::vector<std::vector<uint8_t>> state_packets(samples, std::vector<uint8_t>(STATE_SIZE));
+    StateHeader header = {};
+    for (int s = 0; s < samples; ++s)
+    {
+        commands[s] = LowCmd();
+        states[s] = LowState();
+        for (int m = 0; m < 20; ++m)
+        {
+            commands[s].motorCmd[m].q = value(rng);
+            commands[s].motorCmd[m].dq = 10.0f * value(rng);
+            commands[s].motorCmd[m].Kp = 50.0f + 20.0f * value(rng);
+            commands[s].motorCmd[m].Kd = 1.0f + value(rng);
+            states[s].motorState[m].q = value(rng);
+            states[s].motorState[m].dq = 10.0f * value(rng);
+        }
+        for (int i = 0; i < 4; ++i) states[s].imu.quaternion[i] = value(rng);
+        EncodeCommand(commands[s], command_packets[s].data());
+        EncodeState(header, states[s], state_packets[s].data());
+    }
+
+    uint8_t command_buff[COMMAND_SIZE], state_buff[STATE_SIZE];
+    LowCmd cmd = {};
+    LowState state = {};
+    double checksum = 0.0;
+    const double encode_command = Time(calls, [&](int i) {
+        EncodeCommand(commands[i % samples], command_buff);
+        checksum += command_buff[i % COMMAND_SIZE];
+    });
+    const double decode_state = Time(calls, [&](int i) {
+        DecodeState(state_packets[i % samples].data(), STATE_SIZE, header, state);
+        checksum += state.motorState[i % 16].q;
+    });
+    const double decode_command = Time(calls, [&](int i) {
+        DecodeCommand(command_packets[i % samples].data(), COMMAND_SIZE, cmd);
+        checksum += cmd.motorCmd[i % 16].q;
+    });
+    const double encode_state = Time(calls, [&](int i) {
+        EncodeState(header, states[i % samples], state_buff);
+        checksum += state_buff[STATE_MOTOR_OFFSET + i % (2 * STATE_WORDS)];
+    });
+
+    printf("%d calls, %zu command words, %zu state words\n", calls, COMMAND_WORDS, STATE_WORDS);
+    printf("rl_real:      EncodeCommand %6.1f ns   DecodeState  %6.1f ns\n", encode_command, decode_state);
+    printf("mcu_emulator: DecodeCommand %6.1f ns   EncodeState  %6.1f ns\n", decode_command, encode_state);
+    printf("checksum %.3f\n", checksum);
+    return 0;
+}
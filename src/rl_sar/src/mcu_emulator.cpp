@@ -0,0 +1,460 @@
+/*
+* Copyright (c) 2024-2025 Ziqi Fan
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+// Loopback stand-in for the robot side of the L4W4 and A1 (unitree_legged_sdk-3.2 low level)
+// UDP protocols. Commands are applied to a first-order joint model and the resulting state is
+// sent back with configurable rate, loss and latency, so the rl_real backend transport paths can be
+// exercised without hardware.
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "crc32.hpp"
+#include "link_monitor.hpp"
+#include "l4w4_codec.hpp"
+#include "unitree_legged_sdk/comm.h"
+#include "unitree_legged_sdk/udp.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const int MAX_MOTORS = 20;
+    const size_t MAX_PACKET = 1024;
+
+    volatile std::sig_atomic_t running = 1;
+
+    struct Options
+    {
+        std::string protocol;
+        std::string ip;
+        int port = 0;
+        double rate = 0.0;    // Hz, 0 answers every command like the real boards
+        double loss = 0.0;    // probability of dropping a state packet
+        double latency = 0.0; // ms added before a state packet is sent
+        double jitter = 0.0;  // ms, uniformly distributed on top of latency
+        double tau = 0.02;    // s, joint time constant
+    };
+
+    struct MotorTarget
+    {
+        double q = 0.0;
+        double dq = 0.0;
+        double tau = 0.0;
+        double kp = 0.0;
+        double kd = 0.0;
+    };
+
+    // first-order joint: the position (or, without stiffness, the velocity) approaches its target
+    // with time constant tau; the torque estimate is the PD law the motor driver would apply
+    struct MotorModel
+    {
+        double q = 0.0;
+        double dq = 0.0;
+        double tau_est = 0.0;
+
+        void Step(const MotorTarget &target, double dt, double tau)
+        {
+            double alpha = 1.0 - std::exp(-dt / tau);
+            if (target.kp > 0.0)
+            {
+                double q_next = this->q + (target.q - this->q) * alpha;
+                this->dq = (q_next - this->q) / dt;
+                this->q = q_next;
+            }
+            else
+            {
+                double dq_target = target.kd > 0.0 ? target.dq : 0.0;
+                this->dq += (dq_target - this->dq) * alpha;
+                this->q += this->dq * dt;
+            }
+            this->tau_est = target.kp * (target.q - this->q) + target.kd * (target.dq - this->dq) + target.tau;
+        }
+    };
+
+    struct Packet
+    {
+        Clock::time_point due;
+        size_t len;
+        std::array<uint32_t, MAX_PACKET / 4> data; // word aligned for the unitree crc
+    };
+
+    class Protocol
+    {
+    public:
+        virtual ~Protocol() {}
+        // returns false for packets that are not a valid command
+        virtual bool Decode(const uint8_t *buff, size_t len, MotorTarget *targets) = 0;
+        virtual size_t Encode(const MotorModel *motors, double time, uint8_t *buff) = 0;
+    };
+
+    class L4W4Protocol : public Protocol
+    {
+    public:
+        bool Decode(const uint8_t *buff, size_t len, MotorTarget *targets) override
+        {
+            LowCmd cmd = {0};
+            if (!l4w4_codec::DecodeCommand(buff, len, cmd))
+            {
+                return false;
+            }
+            for (int i = 0; i < MAX_MOTORS; ++i)
+            {
+                targets[i].q = cmd.motorCmd[i].q;
+                targets[i].dq = cmd.motorCmd[i].dq;
+                targets[i].tau = 0.0; // not carried by the protocol
+                targets[i].kp = cmd.motorCmd[i].Kp;
+                targets[i].kd = cmd.motorCmd[i].Kd;
+            }
+            return true;
+        }
+
+        size_t Encode(const MotorModel *motors, double time, uint8_t *buff) override
+        {
+            l4w4_codec::StateHeader header = {0};
+            header.mcu_time = static_cast<float>(time);
+            LowState state = {0};
+            state.imu.quaternion[0] = 1.0f;
+            state.imu.accelerometer[2] = 9.81f;
+            for (int i = 0; i < MAX_MOTORS; ++i)
+            {
+                state.motorState[i].q = static_cast<float>(motors[i].q);
+                state.motorState[i].dq = static_cast<float>(motors[i].dq);
+            }
+            return l4w4_codec::EncodeState(header, state, buff);
+        }
+    };
+
+    // legged_sdk-3.2 does not put the LowCmd/LowState structs on the wire: UDP::SetSend/GetRecv
+    // pack them into shorter frames with some fields as scaled integers. The crc covers
+    // (length >> 2) - 1 words and sits in the last four bytes.
+    namespace a1_wire
+    {
+        const size_t CMD_LENGTH = 610;
+        const size_t CMD_MOTOR_OFFSET = 10;
+        const size_t CMD_MOTOR_STRIDE = 27; // mode, q, dq, tau*256 (i16), Kp*32 (u16), Kd*16 (u16), reserve
+
+        const size_t STATE_LENGTH = 771;
+        const size_t STATE_IMU_OFFSET = 10; // quaternion, gyroscope, accelerometer, rpy, temperature
+        const size_t STATE_MOTOR_OFFSET = 63;
+        const size_t STATE_MOTOR_STRIDE = 32; // mode, q, dq, ddq (i16), tauEst*256 (i16), q_raw, dq_raw, ddq_raw (i16), temperature, reserve
+        const size_t STATE_TICK_OFFSET = 719;
+
+        template <typename T>
+        T Read(const uint8_t *buff, size_t offset)
+        {
+            T value;
+            memcpy(&value, buff + offset, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void Write(uint8_t *buff, size_t offset, T value)
+        {
+            memcpy(buff + offset, &value, sizeof(T));
+        }
+
+        void WriteCrc(uint8_t *buff, size_t len)
+        {
+            Write<uint32_t>(buff, len - 4, crc32::Core(reinterpret_cast<const uint32_t *>(buff), (len >> 2) - 1));
+        }
+
+        bool CheckCrc(const uint8_t *buff, size_t len)
+        {
+            return Read<uint32_t>(buff, len - 4) == crc32::Core(reinterpret_cast<const uint32_t *>(buff), (len >> 2) - 1);
+        }
+    }
+
+    class A1Protocol : public Protocol
+    {
+    public:
+        bool Decode(const uint8_t *buff, size_t len, MotorTarget *targets) override
+        {
+            if (len != a1_wire::CMD_LENGTH || buff[0] != UNITREE_LEGGED_SDK::LOWLEVEL || !a1_wire::CheckCrc(buff, len))
+            {
+                return false;
+            }
+            for (int i = 0; i < MAX_MOTORS; ++i)
+            {
+                const uint8_t *motor = buff + a1_wire::CMD_MOTOR_OFFSET + i * a1_wire::CMD_MOTOR_STRIDE;
+                float q = a1_wire::Read<float>(motor, 1);
+                float dq = a1_wire::Read<float>(motor, 5);
+                // PosStopF/VelStopF disable the position/velocity term on the real driver
+                bool pos_stop = q >= UNITREE_LEGGED_SDK::PosStopF;
+                bool vel_stop = dq >= UNITREE_LEGGED_SDK::VelStopF;
+                targets[i].q = pos_stop ? 0.0 : q;
+                targets[i].dq = vel_stop ? 0.0 : dq;
+                targets[i].tau = a1_wire::Read<int16_t>(motor, 9) / 256.0;
+                targets[i].kp = pos_stop ? 0.0 : a1_wire::Read<uint16_t>(motor, 11) / 32.0;
+                targets[i].kd = vel_stop ? 0.0 : a1_wire::Read<uint16_t>(motor, 13) / 16.0;
+            }
+            return true;
+        }
+
+        size_t Encode(const MotorModel *motors, double time, uint8_t *buff) override
+        {
+            memset(buff, 0, a1_wire::STATE_LENGTH);
+            buff[0] = UNITREE_LEGGED_SDK::LOWLEVEL;
+            a1_wire::Write<float>(buff, a1_wire::STATE_IMU_OFFSET, 1.0f);       // quaternion w
+            a1_wire::Write<float>(buff, a1_wire::STATE_IMU_OFFSET + 36, 9.81f); // accelerometer z
+            for (int i = 0; i < MAX_MOTORS; ++i)
+            {
+                uint8_t *motor = buff + a1_wire::STATE_MOTOR_OFFSET + i * a1_wire::STATE_MOTOR_STRIDE;
+                double tau_est = std::min(std::max(motors[i].tau_est * 256.0, -32768.0), 32767.0);
+                motor[0] = 0x0A;
+                a1_wire::Write<float>(motor, 1, static_cast<float>(motors[i].q));
+                a1_wire::Write<float>(motor, 5, static_cast<float>(motors[i].dq));
+                a1_wire::Write<int16_t>(motor, 11, static_cast<int16_t>(std::lround(tau_est)));
+                a1_wire::Write<float>(motor, 13, static_cast<float>(motors[i].q));
+                a1_wire::Write<float>(motor, 17, static_cast<float>(motors[i].dq));
+            }
+            a1_wire::Write<uint32_t>(buff, a1_wire::STATE_TICK_OFFSET, static_cast<uint32_t>(time * 1e6));
+            a1_wire::WriteCrc(buff, a1_wire::STATE_LENGTH);
+            return a1_wire::STATE_LENGTH;
+        }
+    };
+
+    void PrintUsage(const char *name)
+    {
+        std::cout << "Usage: " << name << " <l4w4|a1> [options]" << std::endl
+                  << "  --ip <addr>        listen address (l4w4: 127.0.0.1, a1: " << UNITREE_LEGGED_SDK::UDP_SERVER_IP_BASIC << ")" << std::endl
+                  << "  --port <port>      listen port (l4w4: 7777, a1: " << UNITREE_LEGGED_SDK::UDP_SERVER_PORT << ")" << std::endl
+                  << "  --rate <hz>        stream state at a fixed rate instead of answering each command" << std::endl
+                  << "  --loss <p>         probability of dropping a state packet" << std::endl
+                  << "  --latency <ms>     delay before a state packet is sent" << std::endl
+                  << "  --jitter <ms>      extra uniform delay on top of latency" << std::endl
+                  << "  --tau <s>          joint time constant (default 0.02)" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char **argv, Options &options)
+    {
+        if (argc < 2)
+        {
+            return false;
+        }
+        options.protocol = argv[1];
+        if (options.protocol == "l4w4")
+        {
+            options.ip = "127.0.0.1";
+            options.port = 7777; // the MCU uses 777, which needs root locally
+        }
+        else if (options.protocol == "a1")
+        {
+            options.ip = UNITREE_LEGGED_SDK::UDP_SERVER_IP_BASIC;
+            options.port = UNITREE_LEGGED_SDK::UDP_SERVER_PORT;
+        }
+        else
+        {
+            return false;
+        }
+        for (int i = 2; i + 1 < argc; i += 2)
+        {
+            std::string key = argv[i];
+            const char *value = argv[i + 1];
+            if (key == "--ip") options.ip = value;
+            else if (key == "--port") options.port = atoi(value);
+            else if (key == "--rate") options.rate = atof(value);
+            else if (key == "--loss") options.loss = atof(value);
+            else if (key == "--latency") options.latency = atof(value);
+            else if (key == "--jitter") options.jitter = atof(value);
+            else if (key == "--tau") options.tau = atof(value);
+            else return false;
+        }
+        return (argc % 2 == 0) && options.tau > 0.0;
+    }
+}
+
+void signalHandler(int signum)
+{
+    running = 0;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return -1;
+    }
+    signal(SIGINT, signalHandler);
+
+    std::unique_ptr<Protocol> protocol;
+    if (options.protocol == "l4w4")
+    {
+        protocol.reset(new L4W4Protocol());
+    }
+    else
+    {
+        protocol.reset(new A1Protocol());
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    addr.sin_addr.s_addr = inet_addr(options.ip.c_str());
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        std::cout << "[MCUEmulator] cannot bind " << options.ip << ":" << options.port << ": " << strerror(errno) << std::endl;
+        if (options.protocol == "a1")
+        {
+            std::cout << "[MCUEmulator] add the robot address to loopback first: sudo ip addr add "
+                      << options.ip << "/32 dev lo" << std::endl;
+        }
+        return -1;
+    }
+    std::cout << "[MCUEmulator] " << options.protocol << " on " << options.ip << ":" << options.port;
+    if (options.rate > 0.0)
+    {
+        std::cout << ", streaming at " << options.rate << "Hz";
+    }
+    else
+    {
+        std::cout << ", answering each command";
+    }
+    std::cout << ", loss " << options.loss << ", latency " << options.latency << "+" << options.jitter << "ms" << std::endl;
+
+    MotorTarget targets[MAX_MOTORS];
+    MotorModel motors[MAX_MOTORS];
+    std::deque<Packet> pending; // ordered by due time
+    std::mt19937 rng(std::random_device{}());
+    std::bernoulli_distribution drop(std::min(std::max(options.loss, 0.0), 1.0));
+    std::uniform_real_distribution<double> jitter(0.0, options.jitter);
+    // commands are the packets received here; in answer mode every state sent is a request
+    // the client should answer, so the response latency is state -> next command
+    LinkMonitor monitor("mcu_emulator " + options.protocol);
+
+    struct sockaddr_in client;
+    bool has_client = false;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point last_step = start;
+    const Clock::duration period = options.rate > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate))
+        : Clock::duration::zero();
+    Clock::time_point next_stream = start;
+    uint32_t recv_buff[MAX_PACKET / 4]; // word aligned for the unitree crc
+
+    auto emit = [&](Clock::time_point now)
+    {
+        double dt = std::min(std::chrono::duration<double>(now - last_step).count(), 0.1);
+        last_step = now;
+        if (dt > 0.0)
+        {
+            for (int i = 0; i < MAX_MOTORS; ++i)
+            {
+                motors[i].Step(targets[i], dt, options.tau);
+            }
+        }
+        if (drop(rng))
+        {
+            return;
+        }
+        Packet packet;
+        packet.len = protocol->Encode(motors, std::chrono::duration<double>(now - start).count(), reinterpret_cast<uint8_t *>(packet.data.data()));
+        packet.due = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(options.latency + jitter(rng)));
+        auto it = std::upper_bound(pending.begin(), pending.end(), packet, [](const Packet &a, const Packet &b) { return a.due < b.due; });
+        pending.insert(it, packet);
+    };
+
+    while (running)
+    {
+        Clock::time_point now = Clock::now();
+        Clock::time_point wake = now + std::chrono::milliseconds(100);
+        if (!pending.empty())
+        {
+            wake = std::min(wake, pending.front().due);
+        }
+        if (period > Clock::duration::zero() && has_client)
+        {
+            wake = std::min(wake, next_stream);
+        }
+        int timeout_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count());
+        struct pollfd pfd = {sock, POLLIN, 0};
+        int ret = poll(&pfd, 1, std::max(timeout_ms, 0));
+        if (ret < 0 && errno != EINTR)
+        {
+            std::cout << "[MCUEmulator] poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        if (ret > 0)
+        {
+            while (true)
+            {
+                struct sockaddr_in from;
+                socklen_t from_len = sizeof(from);
+                ssize_t len = recvfrom(sock, recv_buff, sizeof(recv_buff), MSG_DONTWAIT, (struct sockaddr *)&from, &from_len);
+                if (len < 0)
+                {
+                    break;
+                }
+                Clock::time_point arrival = Clock::now();
+                monitor.OnPacket(arrival);
+                if (!protocol->Decode(reinterpret_cast<const uint8_t *>(recv_buff), len, targets))
+                {
+                    monitor.OnMalformed();
+                    continue;
+                }
+                if (!has_client)
+                {
+                    std::cout << "[MCUEmulator] client " << inet_ntoa(from.sin_addr) << ":" << ntohs(from.sin_port) << std::endl;
+                    next_stream = arrival;
+                }
+                client = from;
+                has_client = true;
+                if (period == Clock::duration::zero())
+                {
+                    emit(arrival);
+                }
+            }
+        }
+
+        now = Clock::now();
+        if (period > Clock::duration::zero() && has_client)
+        {
+            if (next_stream <= now)
+            {
+                emit(now);
+                next_stream += period;
+                if (next_stream <= now)
+                {
+                    next_stream = now + period; // do not burst after a stall
+                }
+            }
+        }
+        while (!pending.empty() && pending.front().due <= now)
+        {
+            const Packet &packet = pending.front();
+            sendto(sock, packet.data.data(), packet.len, 0, (const struct sockaddr *)&client, sizeof(client));
+            if (period == Clock::duration::zero())
+            {
+                monitor.OnRequest();
+            }
+            pending.pop_front();
+        }
+    }
+
+    close(sock);
+    std::cout << std::endl << "[MCUEmulator] exit" << std::endl;
+    return 0;
+}
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rl_real.hpp"
+#include "robot_backend_loader.hpp"
+
+RL_Real::RL_Real(const rl_backend_api *api, rl_backend *backend, const rl_backend_info &info, bool chained_mode, int chained_cpu)
+    : chained_mode(chained_mode), chained_cpu(chained_cpu), backend_api(api), backend(backend)
+{
+#ifdef USE_ROS
+    // init ros
+    ros::NodeHandle nh;
+    this->cmd_vel_subscriber = nh.subscribe<geometry_msgs::Twist>("/cmd_vel", 10, &RL_Real::CmdvelCallback, this);
+#endif
+
+    this->robot_name = info.robot_name;
+    this->default_rl_config = info.default_rl_config;
+
+    // config, transport and policy do not depend on each other until the loops start, so they
+    // come up concurrently; see the breakdown printed at the end of the constructor
+    StartupTasks startup;
+    startup.Add("config", {}, [this]()
+    {
+        // read params from yaml
+        this->ReadYamlBase(this->robot_name);
+        if (this->params.num_of_dofs > RL_BACKEND_MAX_MOTORS)
+        {
+            throw std::runtime_error("num_of_dofs " + std::to_string(this->params.num_of_dofs) + " exceeds the backend limit of " + std::to_string(RL_BACKEND_MAX_MOTORS));
+        }
+    });
+    startup.Add("torch", {}, [this]()
+    {
+        torch::set_num_threads(4);
+    });
+    startup.Add("policy", {"torch"}, [this]()
+    {
+        try
+        {
+            this->PreloadModel(this->robot_name + "/" + this->default_rl_config);
+        }
+        catch (const std::exception &e)
+        {
+            // not fatal, InitRL() loads the policy again and reports why it failed
+            std::cout << LOGGER::WARNING << "Policy preload failed: " << e.what() << std::endl;
+        }
+    });
+    startup.Add("transport", {"config"}, [this]()
+    {
+        // init robot
+        rl_backend_config config = {};
+        config.num_of_dofs = this->params.num_of_dofs;
+        config.dt = this->params.dt;
+        config.flags = this->chained_mode ? RL_BACKEND_FLAG_CHAINED : 0;
+        config.startup_phase = &StartupProfiler::RecordNs;
+        if (this->backend_api->start(this->backend, &config) != 0)
+        {
+            throw std::runtime_error(std::string("backend ") + this->backend_api->name + " failed to start");
+        }
+    });
+    startup.Run();
+
+    // init torch
+    torch::autograd::GradMode::set_enabled(false);
+
+    this->backend_command.num_motors = this->params.num_of_dofs;
+    this->latency.reset(new PipelineLatency(this->backend_api->name));
+    this->InitOutputs();
+    this->InitControl();
+
+    // the loops publish and log from their first tick
+#ifdef PLOT
+    this->TelemetryInit();
+#endif
+#ifdef CSV_LOGGER
+    this->CSVInit(this->robot_name);
+#endif
+
+    // loop
+    if (this->chained_mode)
+    {
+        std::cout << LOGGER::INFO << "Chained mode: state arrival triggers control and send";
+        if (this->chained_cpu >= 0)
+        {
+            std::cout << " on cpu " << this->chained_cpu;
+        }
+        std::cout << std::endl;
+        this->chained_running = true;
+        this->chained_thread = std::thread(&RL_Real::ChainedLoop, this);
+        pthread_setname_np(this->chained_thread.native_handle(), "loop_chained");
+        if (this->chained_cpu >= 0)
+        {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(this->chained_cpu, &cpuset);
+            if (pthread_setaffinity_np(this->chained_thread.native_handle(), sizeof(cpu_set_t), &cpuset) != 0)
+            {
+                std::cout << LOGGER::WARNING << "Cannot pin the chained loop to cpu " << this->chained_cpu << std::endl;
+            }
+        }
+    }
+    else
+    {
+        this->loop_control = std::make_shared<LoopFunc>("loop_control", this->params.dt, std::bind(&RL_Real::RobotControl, this));
+        this->loop_control->start();
+    }
+    this->loop_keyboard = std::make_shared<LoopFunc>("loop_keyboard", 0.05, std::bind(&RL_Real::KeyboardInterface, this));
+    this->loop_rl = std::make_shared<LoopFunc>("loop_rl", this->params.dt * this->params.decimation, std::bind(&RL_Real::RunModel, this));
+    this->loop_keyboard->start();
+    this->loop_rl->start();
+
+#ifdef HOT_RELOAD
+    this->policy_reloader.Start();
+#endif
+
+    StartupProfiler::Instance().Report("control loops running");
+}
+
+RL_Real::~RL_Real()
+{
+    if (this->chained_mode)
+    {
+        this->chained_running = false;
+        if (this->chained_thread.joinable())
+        {
+            this->chained_thread.join();
+        }
+    }
+    else
+    {
+        this->loop_control->shutdown();
+    }
+    this->loop_keyboard->shutdown();
+    this->loop_rl->shutdown();
+#ifdef HOT_RELOAD
+    this->policy_reloader.Shutdown();
+#endif
+    this->backend_api->destroy(this->backend);
+    std::cout << LOGGER::INFO << "RL_Real exit" << std::endl;
+}
+
+void RL_Real::ChainedLoop()
+{
+    const std::chrono::steady_clock::duration period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(this->params.dt));
+    const int64_t timeout_us = static_cast<int64_t>(this->params.dt * 1e6) / 2;
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    bool answered = true;
+    while (this->chained_running)
+    {
+        bool fresh;
+        {
+            TRACE_SCOPE("WaitState");
+            fresh = this->backend_api->wait_state(this->backend, timeout_us) == 1;
+        }
+        if (!fresh && answered)
+        {
+            std::cout << LOGGER::WARNING << "Chained mode: no state within " << this->params.dt * 500.0 << "ms, controlling on the last one" << std::endl;
+        }
+        answered = fresh;
+
+        this->RobotControl();
+
+        next += period;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (next < now)
+        {
+            next = now; // overrun, do not try to catch up
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void RL_Real::GetState(RobotState<double> *state)
+{
+    TRACE_SCOPE("GetState");
+    if (this->backend_api->get_state(this->backend, &this->backend_state) != 0 ||
+        this->backend_state.sequence == this->last_state_sequence)
+    {
+        return;
+    }
+    this->last_state_sequence = this->backend_state.sequence;
+    const rl_backend_state &hw = this->backend_state;
+    state->stamp = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(hw.stamp)));
+
+    if (hw.has_remote)
+    {
+        this->control.x = hw.remote_x;
+        this->control.y = hw.remote_y;
+        this->control.yaw = hw.remote_yaw;
+
+        if (hw.remote_request == RL_BACKEND_REQUEST_GETUP)
+        {
+            this->control.SetControlState(STATE_POS_GETUP);
+        }
+        else if (hw.remote_request == RL_BACKEND_REQUEST_LOCOMOTION)
+        {
+            this->control.SetControlState(STATE_RL_LOCOMOTION);
+        }
+        else if (hw.remote_request == RL_BACKEND_REQUEST_GETDOWN)
+        {
+            this->control.SetControlState(STATE_POS_GETDOWN);
+        }
+    }
+
+    if (this->params.framework == "isaacgym")
+    {
+        state->imu.quaternion[3] = hw.quaternion[0]; // w
+        state->imu.quaternion[0] = hw.quaternion[1]; // x
+        state->imu.quaternion[1] = hw.quaternion[2]; // y
+        state->imu.quaternion[2] = hw.quaternion[3]; // z
+    }
+    else if (this->params.framework == "isaacsim")
+    {
+        state->imu.quaternion[0] = hw.quaternion[0]; // w
+        state->imu.quaternion[1] = hw.quaternion[1]; // x
+        state->imu.quaternion[2] = hw.quaternion[2]; // y
+        state->imu.quaternion[3] = hw.quaternion[3]; // z
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        state->imu.gyroscope[i] = hw.gyroscope[i];
+        state->imu.accelerometer[i] = hw.accelerometer[i];
+    }
+    for (int i = 0; i < this->params.num_of_dofs; ++i)
+    {
+        state->motor_state.q[i] = hw.q[this->params.state_mapping[i]];
+        state->motor_state.dq[i] = hw.dq[this->params.state_mapping[i]];
+        state->motor_state.tau_est[i] = hw.tau_est[this->params.state_mapping[i]];
+    }
+}
+
+void RL_Real::SetCommand(const RobotCommand<double> *command)
+{
+    TRACE_SCOPE("SetCommand");
+    for (int i = 0; i < this->params.num_of_dofs; ++i)
+    {
+        this->backend_command.q[i] = command->motor_command.q[this->params.command_mapping[i]];
+        this->backend_command.dq[i] = command->motor_command.dq[this->params.command_mapping[i]];
+        this->backend_command.kp[i] = command->motor_command.kp[this->params.command_mapping[i]];
+        this->backend_command.kd[i] = command->motor_command.kd[this->params.command_mapping[i]];
+        this->backend_command.tau[i] = command->motor_command.tau[this->params.command_mapping[i]];
+    }
+
+    this->backend_api->set_command(this->backend, &this->backend_command);
+    this->latency->OnActuation(command->stamp);
+}
+
+void RL_Real::RobotControl()
+{
+    TRACE_SCOPE("RobotControl");
+    this->motiontime++;
+
+    this->GetState(&this->robot_state);
+    this->EstimateBaseVelocity(&this->robot_state);
+    this->StateController(&this->robot_state, &this->robot_command);
+    this->Supervise(&this->robot_state, &this->robot_command);
+    this->SetCommand(&this->robot_command);
+#ifdef PLOT
+    this->TelemetryPublish(this->motiontime, &this->robot_state, &this->robot_command);
+#endif
+}
+
+void RL_Real::RunModel()
+{
+    TRACE_SCOPE("RunModel");
+    if (this->rl_init_done)
+    {
+        this->policy_reloader.TryPromote(this->model);
+        this->episode_length_buf += 1;
+        const std::chrono::steady_clock::time_point observation_stamp = this->robot_state.stamp;
+        this->latency->OnInference(observation_stamp);
+        this->UpdateObservations(&this->robot_state);
+        if (this->fsm._currentState->getStateName() == "RLFSMStateRL_Navigation")
+        {
+#ifdef USE_ROS
+            this->UpdateObservationCommands(this->cmd_vel.linear.x, this->cmd_vel.linear.y, this->cmd_vel.angular.z);
+#endif
+        }
+        else
+        {
+            this->UpdateObservationCommands(this->control.x, this->control.y, this->control.yaw);
+        }
+
+        this->obs.actions = this->Forward();
+        this->ComputeOutput(this->obs.actions, this->output_dof_pos, this->output_dof_vel, this->output_dof_tau);
+
+        if (this->output_dof_pos.defined() && this->output_dof_pos.numel() > 0)
+        {
+            output_dof_pos_queue.push(StampedOutput{this->output_dof_pos, ActionStamp{observation_stamp, std::chrono::steady_clock::now()}});
+        }
+        if (this->output_dof_vel.defined() && this->output_dof_vel.numel() > 0)
+        {
+            output_dof_vel_queue.push(this->output_dof_vel);
+        }
+        if (this->output_dof_tau.defined() && this->output_dof_tau.numel() > 0)
+        {
+            output_dof_tau_queue.push(this->output_dof_tau);
+        }
+
+#ifdef CSV_LOGGER
+        torch::Tensor tau_est = torch::tensor(std::vector<float>(this->robot_state.motor_state.tau_est.begin(), this->robot_state.motor_state.tau_est.end()), torch::kFloat).unsqueeze(0);
+        this->CSVLogger(this->output_dof_tau, tau_est, this->obs.dof_pos, this->output_dof_pos, this->obs.dof_vel);
+#endif
+    }
+}
+
+torch::Tensor RL_Real::Forward()
+{
+    TRACE_SCOPE("Forward");
+    torch::autograd::GradMode::set_enabled(false);
+
+    torch::Tensor clamped_obs = this->ComputeObservation();
+    torch::Tensor actions = this->PolicyForward(clamped_obs);
+
+    if (this->params.clip_actions_upper.numel() != 0 && this->params.clip_actions_lower.numel() != 0)
+    {
+        return torch::clamp(actions, this->params.clip_actions_lower, this->params.clip_actions_upper);
+    }
+    else
+    {
+        return actions;
+    }
+}
+
+#ifdef USE_ROS
+void RL_Real::CmdvelCallback(const geometry_msgs::Twist::ConstPtr &msg)
+{
+    this->cmd_vel = *msg;
+}
+#endif
+
+static volatile std::sig_atomic_t shutdown_requested = 0;
+
+// only raises the flag, main() prints the latency summary and shuts down outside the handler
+void signalHandler(int signum)
+{
+    (void)signum;
+    shutdown_requested = 1;
+}
+
+int main(int argc, char **argv)
+{
+    StartupProfiler::Instance(); // accounts everything before main() as the first phase
+    signal(SIGINT, signalHandler);
+    Tracer::Instance().InstallSignalHandler(SIGUSR1);
+#ifdef USE_ROS
+    ros::init(argc, argv, "rl_sar", ros::init_options::NoSigintHandler);
+#endif
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <a1|go2|l4w4|/path/to/plugin.so> [backend args] [--chained [--chained-cpu n]]" << std::endl;
+        exit(-1);
+    }
+
+    // everything after the backend name belongs to the backend, except --chained and --chained-cpu
+    bool chained_mode = false;
+    int chained_cpu = 3;
+    std::vector<char *> backend_args;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--chained")
+        {
+            chained_mode = true;
+        }
+        else if (std::string(argv[i]) == "--chained-cpu" && i + 1 < argc)
+        {
+            chained_cpu = atoi(argv[++i]);
+        }
+        else
+        {
+            backend_args.push_back(argv[i]);
+        }
+    }
+
+    const rl_backend_api *api = nullptr;
+    rl_backend_info info = {};
+    rl_backend *backend = nullptr;
+    {
+        StartupPhase phase("backend plugin");
+        api = LoadBackend(argv[1]);
+        if (!api)
+        {
+            exit(-1);
+        }
+        backend = api->create(backend_args.size(), backend_args.data(), &info);
+    }
+    if (!backend)
+    {
+        std::cout << "Usage: " << argv[0] << " " << argv[1] << " " << api->usage << (api->wait_state ? " [--chained [--chained-cpu n]]" : "") << std::endl;
+        exit(-1);
+    }
+    if (chained_mode && !api->wait_state)
+    {
+        std::cout << LOGGER::WARNING << "Backend " << api->name << " has no chained mode, using the free-running loops" << std::endl;
+        chained_mode = false;
+    }
+
+    RL_Real rl_sar(api, backend, info, chained_mode, chained_cpu);
+#ifdef USE_ROS
+    while (!shutdown_requested && ros::ok())
+    {
+        ros::getGlobalCallbackQueue()->callAvailable(ros::WallDuration(0.1));
+    }
+#else
+    while (!shutdown_requested)
+    {
+        usleep(100000);
+    }
+#endif
+    if (rl_sar.latency)
+    {
+        rl_sar.latency->Print();
+    }
+#ifdef USE_ROS
+    ros::shutdown();
+#endif
+    return 0;
+}
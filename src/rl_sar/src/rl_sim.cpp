@@ -7,6 +7,7 @@
 
 // #define PLOT
 // #define CSV_LOGGER
+// #define HOT_RELOAD
 
 RL_Sim::RL_Sim()
 {
@@ -14,128 +15,171 @@ RL_Sim::RL_Sim()
 
     ros::NodeHandle nh;
 
-    // read params from yaml
     nh.param<std::string>("robot_name", this->robot_name, "");
     nh.param<std::string>("config_name", this->default_rl_config, "");
-    this->ReadYamlBase(this->robot_name);
+
+    // as in rl_real, config, topics and policy come up concurrently; see the breakdown printed at
+    // the end of the constructor, RL_SAR_SERIAL_STARTUP=1 runs them one after another instead
+    StartupTasks startup;
+    startup.Add("config", {}, [this]()
+    {
+        // read params from yaml
+        this->ReadYamlBase(this->robot_name);
+    });
+    startup.Add("torch", {}, [this]()
+    {
+        torch::set_num_threads(4);
+    });
+    startup.Add("policy", {"torch"}, [this]()
+    {
+        try
+        {
+            this->PreloadModel(this->robot_name + "/" + this->default_rl_config);
+        }
+        catch (const std::exception &e)
+        {
+            // not fatal, InitRL() loads the policy again and reports why it failed
+            std::cout << LOGGER::WARNING << "Policy preload failed: " << e.what() << std::endl;
+        }
+    });
+    startup.Add("transport", {"config"}, [this]()
+    {
+        this->InitTransport();
+    });
+    startup.Run();
 
     // init torch
     torch::autograd::GradMode::set_enabled(false);
-    torch::set_num_threads(4);
 
     // init robot
     this->joint_publishers_commands.resize(this->params.num_of_dofs);
     this->InitOutputs();
     this->InitControl();
 
-    // publisher
-    nh.param<std::string>("ros_namespace", this->ros_namespace, "");
-    for (int i = 0; i < this->params.num_of_dofs; ++i)
-    {
-        // joint need to rename as xxx_joint
-        const std::string &joint_name = this->params.joint_controller_names[i];
-        const std::string topic_name = this->ros_namespace + joint_name + "/command";
-        this->joint_publishers[joint_name] =
-            nh.advertise<robot_msgs::MotorCommand>(topic_name, 10);
-    }
+    // one set of latency histograms per transport
+    const char *transport = !this->shared_memory_name.empty() ? "sim shm" : this->use_group_controller ? "sim group" : "sim topics";
+    this->latency.reset(new PipelineLatency(transport));
 
-    // subscriber
-    this->cmd_vel_subscriber = nh.subscribe<geometry_msgs::Twist>("/cmd_vel", 10, &RL_Sim::CmdvelCallback, this);
-    this->joy_subscriber = nh.subscribe<sensor_msgs::Joy>("/joy", 10, &RL_Sim::JoyCallback, this);
-    this->model_state_subscriber = nh.subscribe<gazebo_msgs::ModelStates>("/gazebo/model_states", 10, &RL_Sim::ModelStatesCallback, this);
-    for (int i = 0; i < this->params.num_of_dofs; ++i)
+    std::string velocity_log_path;
+    nh.param<std::string>("velocity_log", velocity_log_path, "");
+    if (!velocity_log_path.empty())
     {
-        // joint need to rename as xxx_joint
-        const std::string &joint_name = this->params.joint_controller_names[i];
-        const std::string topic_name = this->ros_namespace + joint_name + "/state";
-        this->joint_subscribers[joint_name] =
-            nh.subscribe<robot_msgs::MotorState>(topic_name, 10,
-                [this, joint_name](const robot_msgs::MotorState::ConstPtr &msg)
-                {
-                    this->JointStatesCallback(msg, joint_name);
-                }
-            );
-        this->joint_positions[joint_name] = 0.0;
-        this->joint_velocities[joint_name] = 0.0;
-        this->joint_efforts[joint_name] = 0.0;
+        this->VelocityLogInit(velocity_log_path);
     }
 
-    // service
-    nh.param<std::string>("gazebo_model_name", this->gazebo_model_name, "");
-    this->gazebo_set_model_state_client = nh.serviceClient<gazebo_msgs::SetModelState>("/gazebo/set_model_state");
-    this->gazebo_pause_physics_client = nh.serviceClient<std_srvs::Empty>("/gazebo/pause_physics");
-    this->gazebo_unpause_physics_client = nh.serviceClient<std_srvs::Empty>("/gazebo/unpause_physics");
+    // the loops publish and log from their first tick
+#ifdef PLOT
+    this->TelemetryInit();
+#endif
+#ifdef CSV_LOGGER
+    this->CSVInit(this->robot_name);
+#endif
 
     // loop
-    this->loop_control = std::make_shared<LoopFunc>("loop_control", this->params.dt, std::bind(&RL_Sim::RobotControl, this));
+    if (!this->shared_memory_name.empty())
+    {
+        // paced by the controller's state writes instead of a timer
+        this->shm_running = true;
+        this->shm_thread = std::thread(&RL_Sim::SharedMemoryLoop, this);
+        pthread_setname_np(this->shm_thread.native_handle(), "loop_shm");
+    }
+    else
+    {
+        this->loop_control = std::make_shared<LoopFunc>("loop_control", this->params.dt, std::bind(&RL_Sim::RobotControl, this));
+        this->loop_control->start();
+    }
     this->loop_rl = std::make_shared<LoopFunc>("loop_rl", this->params.dt * this->params.decimation, std::bind(&RL_Sim::RunModel, this));
-    this->loop_control->start();
     this->loop_rl->start();
 
     // keyboard
     this->loop_keyboard = std::make_shared<LoopFunc>("loop_keyboard", 0.05, std::bind(&RL_Sim::KeyboardInterface, this));
     this->loop_keyboard->start();
 
-#ifdef PLOT
-    this->plot_t = std::vector<int>(this->plot_size, 0);
-    this->plot_real_joint_pos.resize(this->params.num_of_dofs);
-    this->plot_target_joint_pos.resize(this->params.num_of_dofs);
-    for (auto &vector : this->plot_real_joint_pos) { vector = std::vector<double>(this->plot_size, 0); }
-    for (auto &vector : this->plot_target_joint_pos) { vector = std::vector<double>(this->plot_size, 0); }
-    this->loop_plot = std::make_shared<LoopFunc>("loop_plot", 0.001, std::bind(&RL_Sim::Plot, this));
-    this->loop_plot->start();
-#endif
-#ifdef CSV_LOGGER
-    this->CSVInit(this->robot_name);
+#ifdef HOT_RELOAD
+    this->policy_reloader.Start();
 #endif
 
     std::cout << LOGGER::INFO << "RL_Sim start" << std::endl;
+    StartupProfiler::Instance().Report("control loops running");
 }
 
 RL_Sim::~RL_Sim()
 {
     this->loop_keyboard->shutdown();
-    this->loop_control->shutdown();
+    if (this->loop_control)
+    {
+        this->loop_control->shutdown();
+    }
+    if (this->shm_thread.joinable())
+    {
+        this->shm_running = false;
+        this->shm_thread.join();
+        robot_joint_controller::shm::Detach(this->shm_region);
+    }
     this->loop_rl->shutdown();
-#ifdef PLOT
-    this->loop_plot->shutdown();
+#ifdef HOT_RELOAD
+    this->policy_reloader.Shutdown();
 #endif
     std::cout << LOGGER::INFO << "RL_Sim exit" << std::endl;
 }
 
 void RL_Sim::GetState(RobotState<double> *state)
 {
+    TRACE_SCOPE("GetState");
+    this->sim_state = this->state_buffer.Read();
+    if (this->shm_region)
+    {
+        for (size_t i = 0; i < this->slot_joint_names.size(); ++i)
+        {
+            this->sim_state.q[i] = this->shm_state.motor_state[i].q;
+            this->sim_state.dq[i] = this->shm_state.motor_state[i].dq;
+            this->sim_state.tau_est[i] = this->shm_state.motor_state[i].tau_est;
+        }
+        this->sim_state.stamp = this->shm_stamp;
+    }
+    const SimState &sim_state = this->sim_state;
+    state->stamp = sim_state.stamp;
+
     if (this->params.framework == "isaacgym")
     {
-        state->imu.quaternion[3] = this->pose.orientation.w;
-        state->imu.quaternion[0] = this->pose.orientation.x;
-        state->imu.quaternion[1] = this->pose.orientation.y;
-        state->imu.quaternion[2] = this->pose.orientation.z;
+        state->imu.quaternion[3] = sim_state.quaternion[0];
+        state->imu.quaternion[0] = sim_state.quaternion[1];
+        state->imu.quaternion[1] = sim_state.quaternion[2];
+        state->imu.quaternion[2] = sim_state.quaternion[3];
     }
     else if (this->params.framework == "isaacsim")
     {
-        state->imu.quaternion[0] = this->pose.orientation.w;
-        state->imu.quaternion[1] = this->pose.orientation.x;
-        state->imu.quaternion[2] = this->pose.orientation.y;
-        state->imu.quaternion[3] = this->pose.orientation.z;
+        state->imu.quaternion[0] = sim_state.quaternion[0];
+        state->imu.quaternion[1] = sim_state.quaternion[1];
+        state->imu.quaternion[2] = sim_state.quaternion[2];
+        state->imu.quaternion[3] = sim_state.quaternion[3];
     }
 
-    state->imu.gyroscope[0] = this->vel.angular.x;
-    state->imu.gyroscope[1] = this->vel.angular.y;
-    state->imu.gyroscope[2] = this->vel.angular.z;
+    state->imu.gyroscope[0] = sim_state.gyroscope[0];
+    state->imu.gyroscope[1] = sim_state.gyroscope[1];
+    state->imu.gyroscope[2] = sim_state.gyroscope[2];
 
-    // state->imu.accelerometer
+    state->imu.accelerometer[0] = sim_state.accelerometer[0];
+    state->imu.accelerometer[1] = sim_state.accelerometer[1];
+    state->imu.accelerometer[2] = sim_state.accelerometer[2];
 
+    this->MapJointSlots();
     for (int i = 0; i < this->params.num_of_dofs; ++i)
     {
-        state->motor_state.q[i] = this->joint_positions[this->params.joint_controller_names[i]];
-        state->motor_state.dq[i] = this->joint_velocities[this->params.joint_controller_names[i]];
-        state->motor_state.tau_est[i] = this->joint_efforts[this->params.joint_controller_names[i]];
+        const int slot = this->joint_slots[i];
+        if (slot < 0)
+        {
+            continue;
+        }
+        state->motor_state.q[i] = sim_state.q[slot];
+        state->motor_state.dq[i] = sim_state.dq[slot];
+        state->motor_state.tau_est[i] = sim_state.tau_est[slot];
     }
 }
 
 void RL_Sim::SetCommand(const RobotCommand<double> *command)
 {
+    TRACE_SCOPE("SetCommand");
     for (int i = 0; i < this->params.num_of_dofs; ++i)
     {
         this->joint_publishers_commands[i].q = command->motor_command.q[i];
@@ -145,14 +189,206 @@ void RL_Sim::SetCommand(const RobotCommand<double> *command)
         this->joint_publishers_commands[i].tau = command->motor_command.tau[i];
     }
 
+    if (!this->shared_memory_name.empty())
+    {
+        if (!this->shm_region)
+        {
+            return;
+        }
+        for (int i = 0; i < this->params.num_of_dofs; ++i)
+        {
+            const int slot = this->joint_slots[i];
+            if (slot >= 0)
+            {
+                this->shm_command.motor_command[slot].q = command->motor_command.q[i];
+                this->shm_command.motor_command[slot].dq = command->motor_command.dq[i];
+                this->shm_command.motor_command[slot].kp = command->motor_command.kp[i];
+                this->shm_command.motor_command[slot].kd = command->motor_command.kd[i];
+                this->shm_command.motor_command[slot].tau = command->motor_command.tau[i];
+            }
+        }
+        this->shm_command.ack_tick = this->shm_state.tick;
+        this->shm_command.wait_tick = this->shm_state.tick + this->shm_decimation;
+        robot_joint_controller::shm::Write(this->shm_region->command, this->shm_command);
+    }
+    else if (this->use_group_controller)
+    {
+        for (int i = 0; i < this->params.num_of_dofs; ++i)
+        {
+            if (this->joint_slots[i] >= 0)
+            {
+                this->robot_command_msg.motor_command[this->joint_slots[i]] = this->joint_publishers_commands[i];
+            }
+        }
+        this->robot_command_publisher.publish(this->robot_command_msg);
+    }
+    else
+    {
+        for (int i = 0; i < this->params.num_of_dofs; ++i)
+        {
+            this->joint_publishers[this->params.joint_controller_names[i]].publish(this->joint_publishers_commands[i]);
+        }
+    }
+    this->latency->OnActuation(command->stamp);
+}
+
+void RL_Sim::MapJointSlots()
+{
+    // config.yaml may order the joints differently from base.yaml, remap only when the order changes
+    if (this->joint_slot_names == this->params.joint_controller_names)
+    {
+        return;
+    }
+    this->joint_slot_names = this->params.joint_controller_names;
+    this->joint_slots.assign(this->joint_slot_names.size(), -1);
+    for (size_t i = 0; i < this->joint_slot_names.size(); ++i)
+    {
+        auto it = std::find(this->slot_joint_names.begin(), this->slot_joint_names.end(), this->joint_slot_names[i]);
+        if (it != this->slot_joint_names.end())
+        {
+            this->joint_slots[i] = it - this->slot_joint_names.begin();
+        }
+        else
+        {
+            std::cout << LOGGER::WARNING << "Joint " << this->joint_slot_names[i] << " is not in base.yaml, it will get no state and no command" << std::endl;
+        }
+    }
+}
+
+void RL_Sim::SharedMemoryLoop()
+{
+    int states_since_control = 0;
+    while (this->shm_running)
+    {
+        if (!this->shm_region)
+        {
+            this->shm_region = robot_joint_controller::shm::Attach(this->shared_memory_name);
+            if (!this->shm_region)
+            {
+                // the controller is not up yet, keep the state machine ticking on the control period
+                std::this_thread::sleep_for(std::chrono::duration<double>(this->params.dt));
+                this->RobotControl();
+                continue;
+            }
+            if (this->shm_region->num_joints != this->slot_joint_names.size())
+            {
+                std::cout << LOGGER::WARNING << "Shared memory " << this->shared_memory_name << " has " << this->shm_region->num_joints
+                          << " joints, base.yaml has " << this->slot_joint_names.size() << std::endl;
+            }
+            robot_joint_controller::shm::Read(this->shm_region->state, this->shm_state, this->shm_state_seq);
+            this->shm_stamp = std::chrono::steady_clock::now();
+            std::cout << LOGGER::INFO << "Attached to shared memory " << this->shared_memory_name << std::endl;
+        }
+
+        if (!robot_joint_controller::shm::Wait(this->shm_region->state.seq, this->shm_state_seq, 0.1))
+        {
+            if (!robot_joint_controller::shm::Alive(this->shm_region))
+            {
+                // the controller exited and removed the region, wait for the next one
+                std::cout << LOGGER::WARNING << "Shared memory " << this->shared_memory_name << " was removed by the controller" << std::endl;
+                robot_joint_controller::shm::Detach(this->shm_region);
+                this->shm_region = nullptr;
+                continue;
+            }
+            // physics is paused, still serve keyboard and joystick state changes
+            this->RobotControl();
+            continue;
+        }
+        if (!robot_joint_controller::shm::Read(this->shm_region->state, this->shm_state, this->shm_state_seq))
+        {
+            // overtaken by the writer every attempt, the next state is waited for as usual
+            continue;
+        }
+        this->shm_stamp = std::chrono::steady_clock::now();
+        if (this->shm_state.period > 0.0)
+        {
+            this->shm_decimation = std::max(1, static_cast<int>(std::lround(this->params.dt / this->shm_state.period)));
+        }
+        if (++states_since_control < this->shm_decimation)
+        {
+            continue;
+        }
+        states_since_control = 0;
+        this->RobotControl();
+    }
+}
+
+void RL_Sim::InitTransport()
+{
+    ros::NodeHandle nh;
+
+    // publisher
+    nh.param<std::string>("ros_namespace", this->ros_namespace, "");
+    nh.param<bool>("group_controller", this->use_group_controller, false);
+    nh.param<std::string>("shared_memory", this->shared_memory_name, "");
+    if (!this->shared_memory_name.empty() && !this->use_group_controller)
+    {
+        std::cout << LOGGER::WARNING << "shared_memory requires the group controller, enabling it" << std::endl;
+        this->use_group_controller = true;
+    }
+    this->slot_joint_names = this->params.joint_controller_names;
+    if ((int)this->slot_joint_names.size() > SimState::max_dofs)
+    {
+        std::cout << LOGGER::WARNING << "RL_Sim supports at most " << SimState::max_dofs << " joints, the rest are ignored" << std::endl;
+        this->slot_joint_names.resize(SimState::max_dofs);
+    }
+    if (!this->shared_memory_name.empty())
+    {
+        this->shm_command = robot_joint_controller::shm::Command();
+    }
+    else if (this->use_group_controller)
+    {
+        const std::string topic_name = this->ros_namespace + "robot_joint_group_controller/command";
+        this->robot_command_publisher = nh.advertise<robot_msgs::RobotCommand>(topic_name, 10);
+    }
+    else
+    {
+        for (int i = 0; i < this->params.num_of_dofs; ++i)
+        {
+            // joint need to rename as xxx_joint
+            const std::string &joint_name = this->params.joint_controller_names[i];
+            const std::string topic_name = this->ros_namespace + joint_name + "/command";
+            this->joint_publishers[joint_name] =
+                nh.advertise<robot_msgs::MotorCommand>(topic_name, 10);
+        }
+    }
+
+    // subscriber
+    this->cmd_vel_subscriber = nh.subscribe<geometry_msgs::Twist>("/cmd_vel", 10, &RL_Sim::CmdvelCallback, this);
+    this->joy_subscriber = nh.subscribe<sensor_msgs::Joy>("/joy", 10, &RL_Sim::JoyCallback, this);
+    this->model_state_subscriber = nh.subscribe<gazebo_msgs::ModelStates>("/gazebo/model_states", 10, &RL_Sim::ModelStatesCallback, this);
+    if (this->use_group_controller && this->shared_memory_name.empty())
+    {
+        const std::string topic_name = this->ros_namespace + "robot_joint_group_controller/state";
+        this->robot_state_subscriber = nh.subscribe<robot_msgs::RobotState>(topic_name, 10, &RL_Sim::RobotStateCallback, this);
+    }
     for (int i = 0; i < this->params.num_of_dofs; ++i)
     {
-        this->joint_publishers[this->params.joint_controller_names[i]].publish(this->joint_publishers_commands[i]);
+        // joint need to rename as xxx_joint
+        const std::string &joint_name = this->params.joint_controller_names[i];
+        if (!this->use_group_controller)
+        {
+            const std::string topic_name = this->ros_namespace + joint_name + "/state";
+            this->joint_subscribers[joint_name] =
+                nh.subscribe<robot_msgs::MotorState>(topic_name, 10,
+                    [this, i](const robot_msgs::MotorState::ConstPtr &msg)
+                    {
+                        this->JointStatesCallback(msg, i);
+                    }
+                );
+        }
     }
+
+    // service
+    nh.param<std::string>("gazebo_model_name", this->gazebo_model_name, "");
+    this->gazebo_set_model_state_client = nh.serviceClient<gazebo_msgs::SetModelState>("/gazebo/set_model_state");
+    this->gazebo_pause_physics_client = nh.serviceClient<std_srvs::Empty>("/gazebo/pause_physics");
+    this->gazebo_unpause_physics_client = nh.serviceClient<std_srvs::Empty>("/gazebo/unpause_physics");
 }
 
 void RL_Sim::RobotControl()
 {
+    TRACE_SCOPE("RobotControl");
     if (this->control.control_state == STATE_RESET_SIMULATION)
     {
         gazebo_msgs::SetModelState set_model_state;
@@ -160,6 +396,8 @@ void RL_Sim::RobotControl()
         set_model_state.request.model_state.pose.position.z = 1.0;
         set_model_state.request.model_state.reference_frame = "world";
         this->gazebo_set_model_state_client.call(set_model_state);
+        // the base was teleported, the integrated velocity no longer applies
+        this->velocity_estimator.Reset();
         this->control.control_state = this->control.last_control_state;
     }
     if (this->control.control_state == STATE_TOGGLE_SIMULATION)
@@ -182,15 +420,94 @@ void RL_Sim::RobotControl()
     {
         this->motiontime++;
         this->GetState(&this->robot_state);
+        this->EstimateBaseVelocity(&this->robot_state);
         this->StateController(&this->robot_state, &this->robot_command);
+        this->Supervise(&this->robot_state, &this->robot_command);
         this->SetCommand(&this->robot_command);
+#ifdef PLOT
+        this->TelemetryPublish(this->motiontime, &this->robot_state, &this->robot_command);
+#endif
+        if (this->velocity_log.is_open())
+        {
+            this->VelocityLog();
+        }
     }
 }
 
+void RL_Sim::VelocityLogInit(const std::string &path)
+{
+    this->velocity_log.open(path.c_str());
+    if (!this->velocity_log)
+    {
+        std::cout << LOGGER::WARNING << "Cannot open velocity log " << path << std::endl;
+        return;
+    }
+    // joints in slot order, which is the base.yaml order velocity_estimator_replay resolves the legs in
+    this->velocity_log << "time,qw,qx,qy,qz,gyroscope_world_x,gyroscope_world_y,gyroscope_world_z,accelerometer_x,accelerometer_y,accelerometer_z";
+    for (const std::string &name : this->slot_joint_names) { this->velocity_log << ",q_" << name; }
+    for (const std::string &name : this->slot_joint_names) { this->velocity_log << ",dq_" << name; }
+    this->velocity_log << ",lin_vel_x,lin_vel_y,lin_vel_z,estimate_x,estimate_y,estimate_z" << std::endl;
+    std::cout << LOGGER::INFO << "Logging the base velocity to " << path << std::endl;
+}
+
+void RL_Sim::VelocityLog()
+{
+    TRACE_SCOPE("VelocityLog");
+    const SimState &sim_state = this->sim_state;
+    std::ofstream &log = this->velocity_log;
+    log << ros::Time::now().toSec();
+    for (int i = 0; i < 4; ++i) { log << "," << sim_state.quaternion[i]; }
+    for (int i = 0; i < 3; ++i) { log << "," << sim_state.gyroscope[i]; }
+    for (int i = 0; i < 3; ++i) { log << "," << sim_state.accelerometer[i]; }
+    for (size_t i = 0; i < this->slot_joint_names.size(); ++i) { log << "," << sim_state.q[i]; }
+    for (size_t i = 0; i < this->slot_joint_names.size(); ++i) { log << "," << sim_state.dq[i]; }
+    for (int i = 0; i < 3; ++i) { log << "," << sim_state.lin_vel[i]; }
+    for (int i = 0; i < 3; ++i) { log << "," << this->velocity_estimator.Velocity()[i]; }
+    log << "\n";
+}
+
+// v rotated by the inverse of the unit quaternion w, x, y, z
+static void WorldToBody(const double quaternion[4], const double v[3], double out[3])
+{
+    const double w = quaternion[0], x = quaternion[1], y = quaternion[2], z = quaternion[3];
+    // out = v - 2w (u x v) + 2 u x (u x v), u = (x, y, z)
+    const double t[3] = {2.0 * (y * v[2] - z * v[1]), 2.0 * (z * v[0] - x * v[2]), 2.0 * (x * v[1] - y * v[0])};
+    out[0] = v[0] - w * t[0] + (y * t[2] - z * t[1]);
+    out[1] = v[1] - w * t[1] + (z * t[0] - x * t[2]);
+    out[2] = v[2] - w * t[2] + (x * t[1] - y * t[0]);
+}
+
 void RL_Sim::ModelStatesCallback(const gazebo_msgs::ModelStates::ConstPtr &msg)
 {
-    this->vel = msg->twist[2];
-    this->pose = msg->pose[2];
+    const geometry_msgs::Pose &pose = msg->pose[2];
+    const geometry_msgs::Twist &vel = msg->twist[2];
+    this->state_pending.stamp = std::chrono::steady_clock::now();
+    this->state_pending.quaternion[0] = pose.orientation.w;
+    this->state_pending.quaternion[1] = pose.orientation.x;
+    this->state_pending.quaternion[2] = pose.orientation.y;
+    this->state_pending.quaternion[3] = pose.orientation.z;
+    this->state_pending.gyroscope[0] = vel.angular.x;
+    this->state_pending.gyroscope[1] = vel.angular.y;
+    this->state_pending.gyroscope[2] = vel.angular.z;
+
+    // the base carries no IMU plugin, so the specific force comes from the change of the world twist
+    const double world_velocity[3] = {vel.linear.x, vel.linear.y, vel.linear.z};
+    const ros::Time now = ros::Time::now();
+    const double dt = (now - this->last_model_time).toSec();
+    if (!this->last_model_time.isZero() && dt > 0.0)
+    {
+        const double force[3] = {(world_velocity[0] - this->last_world_velocity[0]) / dt,
+                                 (world_velocity[1] - this->last_world_velocity[1]) / dt,
+                                 (world_velocity[2] - this->last_world_velocity[2]) / dt + 9.81};
+        WorldToBody(this->state_pending.quaternion, force, this->state_pending.accelerometer);
+    }
+    if (dt != 0.0)
+    {
+        this->last_model_time = now;
+        std::copy(world_velocity, world_velocity + 3, this->last_world_velocity);
+    }
+    WorldToBody(this->state_pending.quaternion, world_velocity, this->state_pending.lin_vel);
+    this->state_buffer.Write(this->state_pending);
 }
 
 void RL_Sim::CmdvelCallback(const geometry_msgs::Twist::ConstPtr &msg)
@@ -228,6 +545,10 @@ void RL_Sim::JoyCallback(const sensor_msgs::Joy::ConstPtr &msg)
         {
             this->control.SetControlState(STATE_RL_NAVIGATION);
         }
+        else if (this->joy_msg.buttons[7]) // RB+start
+        {
+            this->policy_reloader.RequestPromote();
+        }
     }
     if (this->joy_msg.buttons[4]) // LB
     {
@@ -239,38 +560,53 @@ void RL_Sim::JoyCallback(const sensor_msgs::Joy::ConstPtr &msg)
     this->control.yaw = this->joy_msg.axes[3] * 1.5; // Rx
 }
 
-void RL_Sim::JointStatesCallback(const robot_msgs::MotorState::ConstPtr &msg, const std::string &joint_name)
+void RL_Sim::JointStatesCallback(const robot_msgs::MotorState::ConstPtr &msg, int slot)
 {
-    this->joint_positions[joint_name] = msg->q;
-    this->joint_velocities[joint_name] = msg->dq;
-    this->joint_efforts[joint_name] = msg->tau_est;
+    // the per-joint controllers publish independently, so a snapshot may mix neighbouring physics steps
+    this->state_pending.stamp = std::chrono::steady_clock::now();
+    this->state_pending.q[slot] = msg->q;
+    this->state_pending.dq[slot] = msg->dq;
+    this->state_pending.tau_est[slot] = msg->tau_est;
+    this->state_buffer.Write(this->state_pending);
+}
+
+void RL_Sim::RobotStateCallback(const robot_msgs::RobotState::ConstPtr &msg)
+{
+    this->state_pending.stamp = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < this->slot_joint_names.size() && i < msg->motor_state.size(); ++i)
+    {
+        this->state_pending.q[i] = msg->motor_state[i].q;
+        this->state_pending.dq[i] = msg->motor_state[i].dq;
+        this->state_pending.tau_est[i] = msg->motor_state[i].tau_est;
+    }
+    this->state_buffer.Write(this->state_pending);
 }
 
 void RL_Sim::RunModel()
 {
+    TRACE_SCOPE("RunModel");
     if (this->rl_init_done && simulation_running)
     {
+        this->policy_reloader.TryPromote(this->model);
         this->episode_length_buf += 1;
-        // this->obs.lin_vel = torch::tensor({{this->vel.linear.x, this->vel.linear.y, this->vel.linear.z}});
-        this->obs.ang_vel = torch::tensor(this->robot_state.imu.gyroscope).unsqueeze(0);
+        const std::chrono::steady_clock::time_point observation_stamp = this->robot_state.stamp;
+        this->latency->OnInference(observation_stamp);
+        this->UpdateObservations(&this->robot_state);
         if (this->fsm._currentState->getStateName() == "RLFSMStateRL_Navigation")
         {
-            this->obs.commands = torch::tensor({{this->cmd_vel.linear.x, this->cmd_vel.linear.y, this->cmd_vel.angular.z}});
+            this->UpdateObservationCommands(this->cmd_vel.linear.x, this->cmd_vel.linear.y, this->cmd_vel.angular.z);
         }
         else
         {
-            this->obs.commands = torch::tensor({{this->control.x, this->control.y, this->control.yaw}});
+            this->UpdateObservationCommands(this->control.x, this->control.y, this->control.yaw);
         }
-        this->obs.base_quat = torch::tensor(this->robot_state.imu.quaternion).unsqueeze(0);
-        this->obs.dof_pos = torch::tensor(this->robot_state.motor_state.q).narrow(0, 0, this->params.num_of_dofs).unsqueeze(0);
-        this->obs.dof_vel = torch::tensor(this->robot_state.motor_state.dq).narrow(0, 0, this->params.num_of_dofs).unsqueeze(0);
 
         this->obs.actions = this->Forward();
         this->ComputeOutput(this->obs.actions, this->output_dof_pos, this->output_dof_vel, this->output_dof_tau);
 
         if (this->output_dof_pos.defined() && this->output_dof_pos.numel() > 0)
         {
-            output_dof_pos_queue.push(this->output_dof_pos);
+            output_dof_pos_queue.push(StampedOutput{this->output_dof_pos, ActionStamp{observation_stamp, std::chrono::steady_clock::now()}});
         }
         if (this->output_dof_vel.defined() && this->output_dof_vel.numel() > 0)
         {
@@ -281,13 +617,11 @@ void RL_Sim::RunModel()
             output_dof_tau_queue.push(this->output_dof_tau);
         }
 
-        // this->TorqueProtect(this->output_dof_tau);
-
 #ifdef CSV_LOGGER
         torch::Tensor tau_est = torch::zeros({1, this->params.num_of_dofs});
         for (int i = 0; i < this->params.num_of_dofs; ++i)
         {
-            tau_est[0][i] = this->joint_efforts[this->params.joint_controller_names[i]];
+            tau_est[0][i] = this->robot_state.motor_state.tau_est[i];
         }
         this->CSVLogger(this->output_dof_tau, tau_est, this->obs.dof_pos, this->output_dof_pos, this->obs.dof_vel);
 #endif
@@ -296,21 +630,11 @@ void RL_Sim::RunModel()
 
 torch::Tensor RL_Sim::Forward()
 {
+    TRACE_SCOPE("Forward");
     torch::autograd::GradMode::set_enabled(false);
 
     torch::Tensor clamped_obs = this->ComputeObservation();
-
-    torch::Tensor actions;
-    if (this->params.observations_history.size() != 0)
-    {
-        this->history_obs_buf.insert(clamped_obs);
-        this->history_obs = this->history_obs_buf.get_obs_vec(this->params.observations_history);
-        actions = this->model.forward({this->history_obs}).toTensor();
-    }
-    else
-    {
-        actions = this->model.forward({clamped_obs}).toTensor();
-    }
+    torch::Tensor actions = this->PolicyForward(clamped_obs);
 
     if (this->params.clip_actions_upper.numel() != 0 && this->params.clip_actions_lower.numel() != 0)
     {
@@ -322,38 +646,30 @@ torch::Tensor RL_Sim::Forward()
     }
 }
 
-void RL_Sim::Plot()
-{
-    this->plot_t.erase(this->plot_t.begin());
-    this->plot_t.push_back(this->motiontime);
-    plt::cla();
-    plt::clf();
-    for (int i = 0; i < this->params.num_of_dofs; ++i)
-    {
-        this->plot_real_joint_pos[i].erase(this->plot_real_joint_pos[i].begin());
-        this->plot_target_joint_pos[i].erase(this->plot_target_joint_pos[i].begin());
-        this->plot_real_joint_pos[i].push_back(this->joint_positions[this->params.joint_controller_names[i]]);
-        this->plot_target_joint_pos[i].push_back(this->joint_publishers_commands[i].q);
-        plt::subplot(4, 3, i + 1);
-        plt::named_plot("_real_joint_pos", this->plot_t, this->plot_real_joint_pos[i], "r");
-        plt::named_plot("_target_joint_pos", this->plot_t, this->plot_target_joint_pos[i], "b");
-        plt::xlim(this->plot_t.front(), this->plot_t.back());
-    }
-    // plt::legend();
-    plt::pause(0.01);
-}
+static volatile std::sig_atomic_t shutdown_requested = 0;
 
+// only raises the flag, main() prints the latency summary and shuts down outside the handler
 void signalHandler(int signum)
 {
-    ros::shutdown();
-    exit(0);
+    (void)signum;
+    shutdown_requested = 1;
 }
 
 int main(int argc, char **argv)
 {
+    StartupProfiler::Instance(); // accounts everything before main() as the first phase
     signal(SIGINT, signalHandler);
-    ros::init(argc, argv, "rl_sar");
+    Tracer::Instance().InstallSignalHandler(SIGUSR1);
+    ros::init(argc, argv, "rl_sar", ros::init_options::NoSigintHandler);
     RL_Sim rl_sar;
-    ros::spin();
+    while (!shutdown_requested && ros::ok())
+    {
+        ros::getGlobalCallbackQueue()->callAvailable(ros::WallDuration(0.1));
+    }
+    if (rl_sar.latency)
+    {
+        rl_sar.latency->Print();
+    }
+    ros::shutdown();
     return 0;
 }
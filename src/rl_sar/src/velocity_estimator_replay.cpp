@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Replays a velocity log (rl_sim with _velocity_log:=<file>) through VelocityEstimator with the
+// robot's base.yaml and compares the estimate against the Gazebo ground truth and the update time
+// against velocity_estimator.budget_us. Exits non-zero when either is out of bounds, so a change of
+// the filter or its tuning can be checked without a simulator:
+//
+//   velocity_estimator_replay models go2 /tmp/go2_velocity.csv --max-rmse 0.15
+
+#include "config_bundle.hpp"
+#include "velocity_estimator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static std::vector<std::string> SplitCSV(const std::string &line)
+{
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ','))
+    {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+static int Column(const std::vector<std::string> &header, const std::string &name)
+{
+    std::vector<std::string>::const_iterator it = std::find(header.begin(), header.end(), name);
+    return it == header.end() ? -1 : static_cast<int>(it - header.begin());
+}
+
+static double Percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 4 && !(argc == 6 && std::string(argv[4]) == "--max-rmse"))
+    {
+        std::cout << "Usage: " << argv[0] << " <models_dir> <robot> <log.csv> [--max-rmse <m/s>]" << std::endl;
+        return 1;
+    }
+    const std::string robot_dir = std::string(argv[1]) + "/" + argv[2];
+    const double max_rmse = argc == 6 ? std::atof(argv[5]) : -1.0;
+
+    BaseConfig base;
+    try
+    {
+        config_bundle::ParseBase(robot_dir + "/base.yaml", argv[2], base);
+    }
+    catch (const ConfigError &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (base.velocity_estimator.num_legs == 0)
+    {
+        std::cerr << robot_dir << "/base.yaml has no velocity_estimator section" << std::endl;
+        return 1;
+    }
+
+    std::ifstream log(argv[3]);
+    std::string line;
+    if (!std::getline(log, line))
+    {
+        std::cerr << "Cannot read " << argv[3] << std::endl;
+        return 1;
+    }
+    const std::vector<std::string> header = SplitCSV(line);
+    std::vector<std::string> joint_names;
+    for (int i = 0; i < base.num_of_dofs; ++i)
+    {
+        joint_names.push_back(base.joint_controller_names[i]);
+    }
+
+    VelocityEstimator estimator;
+    const std::string error = estimator.Configure(base.velocity_estimator, joint_names, FindRobotKinematics(argv[2]));
+    if (!error.empty())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    // real IMUs report the angular velocity in the body frame, Gazebo in the world frame
+    const bool world_gyroscope = Column(header, "gyroscope_world_x") >= 0;
+    estimator.SetWorldFrameGyroscope(world_gyroscope);
+    const std::string gyroscope = world_gyroscope ? "gyroscope_world_" : "gyroscope_";
+    const char *axes[3] = {"x", "y", "z"};
+    int quaternion_columns[4] = {Column(header, "qw"), Column(header, "qx"), Column(header, "qy"), Column(header, "qz")};
+    int gyroscope_columns[3], accelerometer_columns[3], truth_columns[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        gyroscope_columns[i] = Column(header, gyroscope + axes[i]);
+        accelerometer_columns[i] = Column(header, std::string("accelerometer_") + axes[i]);
+        truth_columns[i] = Column(header, std::string("lin_vel_") + axes[i]);
+    }
+    std::vector<int> q_columns, dq_columns;
+    for (const std::string &name : joint_names)
+    {
+        q_columns.push_back(Column(header, "q_" + name));
+        dq_columns.push_back(Column(header, "dq_" + name));
+    }
+    std::vector<int> required(quaternion_columns, quaternion_columns + 4);
+    required.insert(required.end(), gyroscope_columns, gyroscope_columns + 3);
+    required.insert(required.end(), accelerometer_columns, accelerometer_columns + 3);
+    required.insert(required.end(), q_columns.begin(), q_columns.end());
+    required.insert(required.end(), dq_columns.begin(), dq_columns.end());
+    if (std::find(required.begin(), required.end(), -1) != required.end())
+    {
+        std::cerr << argv[3] << " lacks a quaternion, gyroscope, accelerometer or joint column of " << argv[2] << std::endl;
+        return 1;
+    }
+    const bool has_truth = std::find(truth_columns, truth_columns + 3, -1) == truth_columns + 3;
+
+    // the first second is left out of the error, the filter starts from rest whatever the robot does
+    const size_t settle_rows = static_cast<size_t>(1.0 / base.dt);
+    std::vector<double> q(base.num_of_dofs), dq(base.num_of_dofs);
+    std::vector<double> update_us;
+    double squared_error[3] = {0.0, 0.0, 0.0};
+    double max_error = 0.0;
+    size_t rows = 0, scored = 0;
+    while (std::getline(log, line))
+    {
+        const std::vector<std::string> fields = SplitCSV(line);
+        if (fields.size() < header.size())
+        {
+            continue;
+        }
+        double quaternion[4], gyro[3], accelerometer[3];
+        for (int i = 0; i < 4; ++i) { quaternion[i] = std::atof(fields[quaternion_columns[i]].c_str()); }
+        for (int i = 0; i < 3; ++i) { gyro[i] = std::atof(fields[gyroscope_columns[i]].c_str()); }
+        for (int i = 0; i < 3; ++i) { accelerometer[i] = std::atof(fields[accelerometer_columns[i]].c_str()); }
+        for (int i = 0; i < base.num_of_dofs; ++i)
+        {
+            q[i] = std::atof(fields[q_columns[i]].c_str());
+            dq[i] = std::atof(fields[dq_columns[i]].c_str());
+        }
+
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        estimator.Update(quaternion, gyro, accelerometer, q.data(), dq.data(), base.dt);
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        update_us.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+
+        if (has_truth && ++rows > settle_rows)
+        {
+            double error = 0.0;
+            for (int i = 0; i < 3; ++i)
+            {
+                const double difference = estimator.Velocity()[i] - std::atof(fields[truth_columns[i]].c_str());
+                squared_error[i] += difference * difference;
+                error += difference * difference;
+            }
+            max_error = std::max(max_error, std::sqrt(error));
+            scored++;
+        }
+    }
+
+    bool passed = true;
+    std::cout << update_us.size() << " ticks of " << argv[3] << std::endl;
+    if (scored > 0)
+    {
+        const double rmse[3] = {std::sqrt(squared_error[0] / scored), std::sqrt(squared_error[1] / scored), std::sqrt(squared_error[2] / scored)};
+        const double total = std::sqrt((squared_error[0] + squared_error[1] + squared_error[2]) / scored);
+        std::cout << "rmse x " << rmse[0] << " y " << rmse[1] << " z " << rmse[2] << " total " << total << " m/s, max error " << max_error << " m/s" << std::endl;
+        if (max_rmse >= 0.0 && total > max_rmse)
+        {
+            std::cout << "FAIL: rmse above " << max_rmse << " m/s" << std::endl;
+            passed = false;
+        }
+    }
+    else if (max_rmse >= 0.0)
+    {
+        std::cout << "FAIL: no ground truth after the first second to compare against" << std::endl;
+        passed = false;
+    }
+    // the maximum of a replay is dominated by the scheduler of the machine it runs on, p99 is the gate
+    const double p99 = Percentile(update_us, 0.99);
+    std::cout << "update p50 " << Percentile(update_us, 0.5) << "us p99 " << p99 << "us max "
+              << (update_us.empty() ? 0.0 : *std::max_element(update_us.begin(), update_us.end()))
+              << "us, budget " << base.velocity_estimator.budget_us << "us" << std::endl;
+    if (p99 > base.velocity_estimator.budget_us)
+    {
+        std::cout << "FAIL: p99 above the budget" << std::endl;
+        passed = false;
+    }
+    return passed ? 0 : 1;
+}
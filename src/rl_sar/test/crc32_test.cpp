@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Every crc32 implementation against the bitwise loop of the Unitree SDKs, over random messages of
+// every length class each path handles differently (shorter than a fold, single 128-bit folds, the
+// four-way loop, and the leftover words after it) at each word offset from a 16-byte boundary.
+// Exits non-zero on the first mismatch; prints which folding instructions were exercised.
+
+#include "crc32.hpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// legged_sdk crc32_core, written out independently of the module
+static uint32_t Reference(const uint32_t *ptr, uint32_t len)
+{
+    uint32_t xbit = 0;
+    uint32_t data = 0;
+    uint32_t CRC32 = 0xFFFFFFFF;
+    const uint32_t dwPolynomial = 0x04c11db7;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        xbit = 1u << 31;
+        data = ptr[i];
+        for (uint32_t bits = 0; bits < 32; bits++)
+        {
+            if (CRC32 & 0x80000000)
+            {
+                CRC32 <<= 1;
+                CRC32 ^= dwPolynomial;
+            }
+            else
+            {
+                CRC32 <<= 1;
+            }
+            if (data & xbit)
+            {
+                CRC32 ^= dwPolynomial;
+            }
+            xbit >>= 1;
+        }
+    }
+    return CRC32;
+}
+
+int main()
+{
+    struct Implementation
+    {
+        const char *name;
+        uint32_t (*crc)(const uint32_t *, uint32_t);
+    };
+    const Implementation implementations[] = {
+        {"Bitwise", crc32::Bitwise},
+        {"SliceBy8", crc32::SliceBy8},
+        {"Folding", crc32::Folding},
+        {"Core", crc32::Core},
+    };
+
+    std::mt19937 rng(0);
+    std::vector<uint32_t> lengths;
+    for (uint32_t len = 0; len <= 160; ++len)
+    {
+        lengths.push_back(len); // every path boundary and remainder
+    }
+    for (uint32_t len : {152u, 177u, 260u, 261u, 262u, 263u, 1024u, 4093u})
+    {
+        lengths.push_back(len); // legged_sdk LowCmd/LowState, Go2 LowCmd_, long buffers
+    }
+    std::uniform_int_distribution<uint32_t> random_length(161, 2048);
+    for (int i = 0; i < 200; ++i)
+    {
+        lengths.push_back(random_length(rng));
+    }
+
+    // 16-byte aligned storage, messages start 0-3 words into it
+    std::vector<uint32_t> storage(4096 + 8);
+    uint32_t *aligned = storage.data();
+    while (reinterpret_cast<uintptr_t>(aligned) % 16 != 0)
+    {
+        ++aligned;
+    }
+
+    int checked = 0, failures = 0;
+    for (uint32_t len : lengths)
+    {
+        for (int offset = 0; offset < 4; ++offset)
+        {
+            uint32_t *message = aligned + offset;
+            for (int pattern = 0; pattern < 3; ++pattern)
+            {
+                for (uint32_t i = 0; i < len; ++i)
+                {
+                    // random words, then all ones and all zeros for the carries at the ends
+                    message[i] = pattern == 0 ? static_cast<uint32_t>(rng()) : pattern == 1 ? 0xffffffffu : 0u;
+                }
+                const uint32_t expected = Reference(message, len);
+                for (const Implementation &implementation : implementations)
+                {
+                    const uint32_t crc = implementation.crc(message, len);
+                    if (crc != expected)
+                    {
+                        if (++failures <= 10)
+                        {
+                            printf("FAILED %s: %u words at offset %d, pattern %d: %08x instead of %08x\n", implementation.name, len, offset,
+                                   pattern, crc, expected);
+                        }
+                    }
+                    ++checked;
+                }
+            }
+        }
+    }
+
+    printf("%d checks, folding %s, Core uses %s: %s\n", checked, crc32::FoldingSupported() ? "exercised" : "not supported by this CPU",
+           crc32::Implementation(), failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
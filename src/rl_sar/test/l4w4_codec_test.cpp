@@ -0,0 +1,578 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Round trips every word of the L4W4 command and state tables at the ends of its range, just
+// inside and outside them and at NaN/Inf, plus the state header, the IMU frame change and every
+// truncated packet length. The SDK's SendUDP/AnalyzeUDP are also compared against a frozen copy
+// of the hand-written versions they replaced: command packets byte for byte, decoded states value
+// for value. Exits non-zero on the first table entry that does not hold.
+
+#include "l4w4_codec.hpp"
+#include "l4w4_sdk.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+using namespace l4w4_codec;
+
+static int failures = 0;
+
+#define EXPECT(condition, ...)                 \
+    do                                         \
+    {                                          \
+        if (!(condition))                      \
+        {                                      \
+            ++failures;                        \
+            printf("FAILED %s: ", #condition); \
+            printf(__VA_ARGS__);               \
+            printf("\n");                      \
+        }                                      \
+    } while (0)
+
+// SendUDP and AnalyzeUDP as they were before the table codec, without the socket and with the
+// unused yaw/pitch/roll computation dropped; do not change, this is what the MCU was tested with
+namespace frozen
+{
+    static float read_float(const unsigned char *buff, int *idx)
+    {
+        float v = 0;
+        *((unsigned char *)&v + 0) = buff[*idx];
+        (*idx)++;
+        *((unsigned char *)&v + 1) = buff[*idx];
+        (*idx)++;
+        *((unsigned char *)&v + 2) = buff[*idx];
+        (*idx)++;
+        *((unsigned char *)&v + 3) = buff[*idx];
+        (*idx)++;
+        return v;
+    }
+
+    static float read_from1byte(const unsigned char *buff, int *idx, float v_min, float v_max)
+    {
+        float v = (float)buff[*idx] / 255.0 * (v_max - v_min) + v_min;
+        (*idx)++;
+        return v;
+    }
+
+    static float read_from2bytes(const unsigned char *buff, int *idx, float v_min, float v_max)
+    {
+        unsigned int v = 0;
+        *((unsigned char *)&v + 0) = buff[*idx];
+        (*idx)++;
+        *((unsigned char *)&v + 1) = buff[*idx];
+        (*idx)++;
+        return v / 65535.0 * (v_max - v_min) + v_min;
+    }
+
+    // only defined for values inside [v_min, v_max], the float->ushort conversion is not saturated
+    static void write_into2bytes(float value, unsigned char *buff, int *idx, float v_min, float v_max)
+    {
+        ushort v16 = (value - v_min) / (v_max - v_min) * 65535;
+        buff[*idx] = (v16 >> 8) & 0xff;
+        (*idx)++;
+        buff[*idx] = v16 & 0xff;
+        (*idx)++;
+    }
+
+    static float read_byte(const unsigned char *buff, int *idx)
+    {
+        float v = (float)buff[*idx];
+        (*idx)++;
+        return v;
+    }
+
+    static int SendUDP(LowCmd &lowCmd, unsigned char *sent_buff)
+    {
+        int idx = 0;
+
+        // front right
+        write_into2bytes(lowCmd.motorCmd[4].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[4].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[4].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[5].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[5].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[5].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[6].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[6].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[6].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[7].dq, sent_buff, &idx, -200, 200);
+        write_into2bytes(lowCmd.motorCmd[7].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[7].Kd, sent_buff, &idx, 0, 1000);
+
+        // rear right
+        write_into2bytes(lowCmd.motorCmd[12].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[12].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[12].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[13].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[13].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[13].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[14].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[14].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[14].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[15].dq, sent_buff, &idx, -200, 200);
+        write_into2bytes(lowCmd.motorCmd[15].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[15].Kd, sent_buff, &idx, 0, 1000);
+
+        // rear left
+        write_into2bytes(lowCmd.motorCmd[8].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[8].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[8].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[9].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[9].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[9].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[10].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[10].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[10].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[11].dq, sent_buff, &idx, -200, 200);
+        write_into2bytes(lowCmd.motorCmd[11].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[11].Kd, sent_buff, &idx, 0, 1000);
+
+        // front left
+        write_into2bytes(lowCmd.motorCmd[0].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[0].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[0].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[1].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[1].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[1].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[2].q, sent_buff, &idx, -3.2, 3.2);
+        write_into2bytes(lowCmd.motorCmd[2].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[2].Kd, sent_buff, &idx, 0, 1000);
+        write_into2bytes(-lowCmd.motorCmd[3].dq, sent_buff, &idx, -200, 200);
+        write_into2bytes(lowCmd.motorCmd[3].Kp, sent_buff, &idx, 0, 1000);
+        write_into2bytes(lowCmd.motorCmd[3].Kd, sent_buff, &idx, 0, 1000);
+
+        write_into2bytes(0.0f, sent_buff, &idx, -10, 10);
+        write_into2bytes(0.0f, sent_buff, &idx, -10, 10);
+        write_into2bytes(0.0f, sent_buff, &idx, -10, 10);
+        return idx;
+    }
+
+    static void AnalyzeUDP(const unsigned char *recv_buff, LowState &lowState)
+    {
+        int idx = 2;
+        read_float(recv_buff, &idx); // mcu time
+        read_from1byte(recv_buff, &idx, 20, 60); // battery voltage
+        read_byte(recv_buff, &idx); // mcu temperature
+
+        float acc_lx = read_float(recv_buff, &idx);
+        float acc_ly = read_float(recv_buff, &idx);
+        float acc_lz = read_float(recv_buff, &idx);
+        float omega_lx = read_float(recv_buff, &idx);
+        float omega_ly = read_float(recv_buff, &idx);
+        float omega_lz = read_float(recv_buff, &idx);
+        float orientation_x = read_float(recv_buff, &idx);
+        float orientation_y = read_float(recv_buff, &idx);
+        float orientation_z = read_float(recv_buff, &idx);
+        float orientation_w = read_float(recv_buff, &idx);
+
+        read_byte(recv_buff, &idx);
+        read_byte(recv_buff, &idx);
+
+        xRockerBtnDataStruct *rockerBtn = (xRockerBtnDataStruct *)(&(lowState.wirelessRemote));
+
+        unsigned char key1 = recv_buff[idx];
+        idx++;
+        rockerBtn->btn.components.R1 = (key1 & 0x80) >> 7;
+        rockerBtn->btn.components.L1 = (key1 & 0x40) >> 6;
+        rockerBtn->btn.components.start = (key1 & 0x20) >> 5;
+        rockerBtn->btn.components.select = (key1 & 0x10) >> 4;
+        rockerBtn->btn.components.R2 = (key1 & 0x08) >> 3;
+        rockerBtn->btn.components.L2 = (key1 & 0x04) >> 2;
+        rockerBtn->btn.components.F1 = (key1 & 0x02) >> 1;
+        rockerBtn->btn.components.F2 = (key1 & 0x01) >> 0;
+
+        unsigned char key2 = recv_buff[idx];
+        idx++;
+        rockerBtn->btn.components.A = (key2 & 0x80) >> 7;
+        rockerBtn->btn.components.B = (key2 & 0x40) >> 6;
+        rockerBtn->btn.components.X = (key2 & 0x20) >> 5;
+        rockerBtn->btn.components.Y = (key2 & 0x10) >> 4;
+        rockerBtn->btn.components.up = (key2 & 0x08) >> 3;
+        rockerBtn->btn.components.right = (key2 & 0x04) >> 2;
+        rockerBtn->btn.components.down = (key2 & 0x02) >> 1;
+        rockerBtn->btn.components.left = (key2 & 0x01) >> 0;
+
+        rockerBtn->lx = read_float(recv_buff, &idx);
+        rockerBtn->rx = read_float(recv_buff, &idx);
+        rockerBtn->ly = read_float(recv_buff, &idx);
+        rockerBtn->L2 = read_float(recv_buff, &idx);
+        rockerBtn->ry = read_float(recv_buff, &idx);
+
+        idx += 4 * 4;
+
+        float motor_leg1_j0 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg1_j0_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg1_j1 = read_from2bytes(recv_buff, &idx, -1.3 * M_PI, 0.7 * M_PI);
+        float motor_leg1_j1_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg1_j2 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg1_j2_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+
+        float motor_leg2_j0 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg2_j0_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg2_j1 = read_from2bytes(recv_buff, &idx, -1.3 * M_PI, 0.7 * M_PI);
+        float motor_leg2_j1_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg2_j2 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg2_j2_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+
+        float motor_leg3_j0 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg3_j0_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg3_j1 = read_from2bytes(recv_buff, &idx, -1.3 * M_PI, 0.7 * M_PI);
+        float motor_leg3_j1_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg3_j2 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg3_j2_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+
+        float motor_leg4_j0 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg4_j0_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg4_j1 = read_from2bytes(recv_buff, &idx, -1.3 * M_PI, 0.7 * M_PI);
+        float motor_leg4_j1_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+        float motor_leg4_j2 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg4_j2_dot = read_from2bytes(recv_buff, &idx, -33, 33);
+
+        float motor_leg1_j3 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg1_j3_dot = read_from2bytes(recv_buff, &idx, -200, 200);
+        float motor_leg2_j3 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg2_j3_dot = read_from2bytes(recv_buff, &idx, -200, 200);
+        float motor_leg3_j3 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg3_j3_dot = read_from2bytes(recv_buff, &idx, -200, 200);
+        float motor_leg4_j3 = read_from2bytes(recv_buff, &idx, -M_PI, M_PI);
+        float motor_leg4_j3_dot = read_from2bytes(recv_buff, &idx, -200, 200);
+
+        lowState.imu.quaternion[0] = orientation_w;
+        lowState.imu.quaternion[1] = orientation_x;
+        lowState.imu.quaternion[2] = -orientation_z;
+        lowState.imu.quaternion[3] = orientation_y;
+
+        lowState.imu.gyroscope[0] = omega_lx;
+        lowState.imu.gyroscope[1] = -omega_lz;
+        lowState.imu.gyroscope[2] = omega_ly;
+        lowState.imu.accelerometer[0] = acc_lx;
+        lowState.imu.accelerometer[1] = -acc_lz;
+        lowState.imu.accelerometer[2] = acc_ly;
+
+        //   leg4   leg1    leg3    leg2
+        //   hip thigh shank wheel
+
+        lowState.motorState[0].q = lowState.motorState[0].q_raw = motor_leg4_j0;
+        lowState.motorState[0].dq = lowState.motorState[0].dq_raw = motor_leg4_j0_dot;
+        lowState.motorState[0].ddq = lowState.motorState[0].ddq_raw = 0;
+        lowState.motorState[1].q = lowState.motorState[1].q_raw = -motor_leg4_j1;
+        lowState.motorState[1].dq = lowState.motorState[1].dq_raw = -motor_leg4_j1_dot;
+        lowState.motorState[1].ddq = lowState.motorState[1].ddq_raw = 0;
+        lowState.motorState[2].q = lowState.motorState[2].q_raw = -motor_leg4_j2;
+        lowState.motorState[2].dq = lowState.motorState[2].dq_raw = -motor_leg4_j2_dot;
+        lowState.motorState[2].ddq = lowState.motorState[2].ddq_raw = 0;
+        lowState.motorState[3].q = lowState.motorState[3].q_raw = -motor_leg4_j3;
+        lowState.motorState[3].dq = lowState.motorState[3].dq_raw = -motor_leg4_j3_dot;
+        lowState.motorState[3].ddq = lowState.motorState[3].ddq_raw = 0;
+
+        lowState.motorState[4].q = lowState.motorState[4].q_raw = motor_leg1_j0;
+        lowState.motorState[4].dq = lowState.motorState[4].dq_raw = motor_leg1_j0_dot;
+        lowState.motorState[4].ddq = lowState.motorState[4].ddq_raw = 0;
+        lowState.motorState[5].q = lowState.motorState[5].q_raw = -motor_leg1_j1;
+        lowState.motorState[5].dq = lowState.motorState[5].dq_raw = -motor_leg1_j1_dot;
+        lowState.motorState[5].ddq = lowState.motorState[5].ddq_raw = 0;
+        lowState.motorState[6].q = lowState.motorState[6].q_raw = -motor_leg1_j2;
+        lowState.motorState[6].dq = lowState.motorState[6].dq_raw = -motor_leg1_j2_dot;
+        lowState.motorState[6].ddq = lowState.motorState[6].ddq_raw = 0;
+        lowState.motorState[7].q = lowState.motorState[7].q_raw = -motor_leg1_j3;
+        lowState.motorState[7].dq = lowState.motorState[7].dq_raw = -motor_leg1_j3_dot;
+        lowState.motorState[7].ddq = lowState.motorState[7].ddq_raw = 0;
+
+        lowState.motorState[8].q = lowState.motorState[8].q_raw = motor_leg3_j0;
+        lowState.motorState[8].dq = lowState.motorState[8].dq_raw = motor_leg3_j0_dot;
+        lowState.motorState[8].ddq = lowState.motorState[8].ddq_raw = 0;
+        lowState.motorState[9].q = lowState.motorState[9].q_raw = -motor_leg3_j1;
+        lowState.motorState[9].dq = lowState.motorState[9].dq_raw = -motor_leg3_j1_dot;
+        lowState.motorState[9].ddq = lowState.motorState[9].ddq_raw = 0;
+        lowState.motorState[10].q = lowState.motorState[10].q_raw = -motor_leg3_j2;
+        lowState.motorState[10].dq = lowState.motorState[10].dq_raw = -motor_leg3_j2_dot;
+        lowState.motorState[10].ddq = lowState.motorState[10].ddq_raw = 0;
+        lowState.motorState[11].q = lowState.motorState[11].q_raw = -motor_leg3_j3;
+        lowState.motorState[11].dq = lowState.motorState[11].dq_raw = -motor_leg3_j3_dot;
+        lowState.motorState[11].ddq = lowState.motorState[11].ddq_raw = 0;
+
+        lowState.motorState[12].q = lowState.motorState[12].q_raw = motor_leg2_j0;
+        lowState.motorState[12].dq = lowState.motorState[12].dq_raw = motor_leg2_j0_dot;
+        lowState.motorState[12].ddq = lowState.motorState[12].ddq_raw = 0;
+        lowState.motorState[13].q = lowState.motorState[13].q_raw = -motor_leg2_j1;
+        lowState.motorState[13].dq = lowState.motorState[13].dq_raw = -motor_leg2_j1_dot;
+        lowState.motorState[13].ddq = lowState.motorState[13].ddq_raw = 0;
+        lowState.motorState[14].q = lowState.motorState[14].q_raw = -motor_leg2_j2;
+        lowState.motorState[14].dq = lowState.motorState[14].dq_raw = -motor_leg2_j2_dot;
+        lowState.motorState[14].ddq = lowState.motorState[14].ddq_raw = 0;
+        lowState.motorState[15].q = lowState.motorState[15].q_raw = -motor_leg2_j3;
+        lowState.motorState[15].dq = lowState.motorState[15].dq_raw = -motor_leg2_j3_dot;
+        lowState.motorState[15].ddq = lowState.motorState[15].ddq_raw = 0;
+    }
+}
+
+static uint16_t CommandWordAt(const uint8_t *buff, size_t i)
+{
+    return static_cast<uint16_t>((buff[2 * i] << 8) | buff[2 * i + 1]);
+}
+
+static uint16_t StateWordAt(const uint8_t *buff, size_t i)
+{
+    return static_cast<uint16_t>(buff[STATE_MOTOR_OFFSET + 2 * i] | (buff[STATE_MOTOR_OFFSET + 2 * i + 1] << 8));
+}
+
+static void TestCommandWords()
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < COMMAND_WORDS; ++i)
+    {
+        const CommandWord &w = COMMAND_LAYOUT[i];
+        const float step = (w.v_max - w.v_min) / 65535.0f;
+        // wire value, word expected on the wire (-1: anywhere strictly inside), decoded wire value
+        const struct
+        {
+            float wire;
+            int word;
+            float decoded;
+        } cases[] = {
+            {w.v_min, 0, w.v_min},
+            {w.v_max, 65535, w.v_max},
+            {w.v_min + 2.0f * step, -1, w.v_min + 2.0f * step},
+            {w.v_max - 2.0f * step, -1, w.v_max - 2.0f * step},
+            {0.5f * (w.v_min + w.v_max), -1, 0.5f * (w.v_min + w.v_max)},
+            {w.v_min - 1.0f, 0, w.v_min},
+            {w.v_max + 1.0f, 65535, w.v_max},
+            {-inf, 0, w.v_min},
+            {inf, 65535, w.v_max},
+            {nan, 0, w.v_min},
+        };
+        for (const auto &c : cases)
+        {
+            LowCmd cmd = {};
+            cmd.motorCmd[w.motor].*w.field = c.wire * w.sign;
+            uint8_t buff[COMMAND_SIZE];
+            EXPECT(EncodeCommand(cmd, buff) == COMMAND_SIZE, "word %zu", i);
+            const uint16_t word = CommandWordAt(buff, i);
+            if (c.word >= 0)
+            {
+                EXPECT(word == c.word, "word %zu motor %d wire %g: %u instead of %d", i, w.motor, c.wire, word, c.word);
+            }
+            else
+            {
+                EXPECT(word > 0 && word < 65535, "word %zu motor %d wire %g: saturated to %u", i, w.motor, c.wire, word);
+            }
+            for (size_t r = COMMAND_WORDS; r < COMMAND_WORDS + COMMAND_RESERVED_WORDS; ++r)
+            {
+                EXPECT(CommandWordAt(buff, r) == COMMAND_RESERVED_VALUE, "reserved word %zu", r);
+            }
+
+            LowCmd decoded = {};
+            EXPECT(DecodeCommand(buff, COMMAND_SIZE, decoded), "word %zu", i);
+            // the encoder truncates, so the decoded value is at most one step below
+            const float value = decoded.motorCmd[w.motor].*w.field * w.sign;
+            EXPECT(value <= c.decoded + 1e-5f * std::fabs(c.decoded) + 1e-6f && value >= c.decoded - step * 1.0001f,
+                   "word %zu motor %d wire %g: decoded %.9g, expected %.9g", i, w.motor, c.wire, value, c.decoded);
+        }
+    }
+}
+
+static void TestStateWords()
+{
+    for (size_t i = 0; i < STATE_WORDS; ++i)
+    {
+        const StateWord &w = STATE_LAYOUT[i];
+        const float step = (w.v_max - w.v_min) / 65535.0f;
+        const struct
+        {
+            float wire;
+            int word;
+            float decoded;
+        } cases[] = {
+            {w.v_min, 0, w.v_min},
+            {w.v_max, 65535, w.v_max},
+            {w.v_min + 2.0f * step, 2, w.v_min + 2.0f * step},
+            {w.v_max - 2.0f * step, 65533, w.v_max - 2.0f * step},
+            {0.5f * (w.v_min + w.v_max), -1, 0.5f * (w.v_min + w.v_max)},
+            {w.v_min - 1.0f, 0, w.v_min},
+            {w.v_max + 1.0f, 65535, w.v_max},
+        };
+        for (const auto &c : cases)
+        {
+            LowState state = {};
+            state.imu.quaternion[0] = 1.0f;
+            state.motorState[w.motor].*w.field = c.wire * w.sign;
+            StateHeader header = {};
+            uint8_t buff[STATE_SIZE];
+            EXPECT(EncodeState(header, state, buff) == STATE_SIZE, "word %zu", i);
+            const uint16_t word = StateWordAt(buff, i);
+            if (c.word >= 0)
+            {
+                EXPECT(word == c.word, "state word %zu motor %d wire %g: %u instead of %d", i, w.motor, c.wire, word, c.word);
+            }
+
+            LowState decoded = {};
+            decoded.motorState[w.motor].ddq = 1.0f;
+            StateHeader decoded_header;
+            EXPECT(DecodeState(buff, STATE_SIZE, decoded_header, decoded), "state word %zu", i);
+            const MotorState &motor = decoded.motorState[w.motor];
+            // the emulator side rounds to nearest, so half a step either way
+            const float value = motor.*w.field * w.sign;
+            EXPECT(std::fabs(value - c.decoded) <= 0.5001f * step + 1e-6f * std::fabs(c.decoded),
+                   "state word %zu motor %d wire %g: decoded %.9g, expected %.9g", i, w.motor, c.wire, value, c.decoded);
+            EXPECT(motor.*w.raw == motor.*w.field, "state word %zu: raw field differs", i);
+            EXPECT(motor.ddq == 0.0f && motor.ddq_raw == 0.0f, "state word %zu: ddq not cleared", i);
+        }
+    }
+}
+
+static void TestStateHeader()
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+    for (int sample = 0; sample < 1000; ++sample)
+    {
+        StateHeader header;
+        header.mcu_time = value(rng);
+        header.key1 = static_cast<uint8_t>(rng());
+        header.key2 = static_cast<uint8_t>(rng());
+        for (float &rocker : header.rocker) rocker = value(rng);
+        LowState state = {};
+        for (float &q : state.imu.quaternion) q = value(rng);
+        for (float &g : state.imu.gyroscope) g = value(rng);
+        for (float &a : state.imu.accelerometer) a = value(rng);
+
+        uint8_t buff[STATE_SIZE];
+        EncodeState(header, state, buff);
+        StateHeader decoded_header;
+        LowState decoded = {};
+        EXPECT(DecodeState(buff, STATE_SIZE, decoded_header, decoded), "sample %d", sample);
+        EXPECT(decoded_header.mcu_time == header.mcu_time && decoded_header.key1 == header.key1 && decoded_header.key2 == header.key2,
+               "sample %d: header", sample);
+        for (int i = 0; i < 5; ++i)
+        {
+            EXPECT(decoded_header.rocker[i] == header.rocker[i], "sample %d: rocker %d", sample, i);
+        }
+        // the frame change is a permutation with sign flips, exact both ways
+        for (int i = 0; i < 4; ++i)
+        {
+            EXPECT(decoded.imu.quaternion[i] == state.imu.quaternion[i], "sample %d: quaternion %d", sample, i);
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT(decoded.imu.gyroscope[i] == state.imu.gyroscope[i], "sample %d: gyroscope %d", sample, i);
+            EXPECT(decoded.imu.accelerometer[i] == state.imu.accelerometer[i], "sample %d: accelerometer %d", sample, i);
+        }
+    }
+
+    // a z-up quaternion of a yaw about the host z axis arrives as a rotation about the MCU y axis
+    uint8_t buff[STATE_SIZE] = {};
+    const float mcu_quaternion[4] = {0.0f, 0.6f, 0.0f, 0.8f}; // x, y, z, w
+    memcpy(buff + STATE_IMU_OFFSET + 24, mcu_quaternion, sizeof(mcu_quaternion));
+    StateHeader header;
+    LowState state = {};
+    DecodeState(buff, STATE_SIZE, header, state);
+    EXPECT(state.imu.quaternion[0] == 0.8f && state.imu.quaternion[1] == 0.0f && state.imu.quaternion[2] == 0.0f && state.imu.quaternion[3] == 0.6f,
+           "yaw decoded as %g %g %g %g", state.imu.quaternion[0], state.imu.quaternion[1], state.imu.quaternion[2], state.imu.quaternion[3]);
+}
+
+static void TestLengths()
+{
+    uint8_t buff[STATE_SIZE] = {};
+    StateHeader header;
+    LowState state = {};
+    state.motorState[0].q = 42.0f;
+    for (size_t len = 0; len < STATE_SIZE; ++len)
+    {
+        EXPECT(!DecodeState(buff, len, header, state), "state of %zu bytes accepted", len);
+    }
+    EXPECT(state.motorState[0].q == 42.0f, "rejected packet touched the state");
+    EXPECT(!DecodeState(nullptr, STATE_SIZE, header, state), "null state accepted");
+    EXPECT(DecodeState(buff, STATE_SIZE + 16, header, state), "longer state rejected");
+
+    LowCmd cmd = {};
+    for (size_t len = 0; len < COMMAND_SIZE; ++len)
+    {
+        EXPECT(!DecodeCommand(buff, len, cmd), "command of %zu bytes accepted", len);
+    }
+    EXPECT(!DecodeCommand(nullptr, COMMAND_SIZE, cmd), "null command accepted");
+
+    // motors without a table entry are never written
+    LowState untouched = {};
+    for (int m = 16; m < 20; ++m)
+    {
+        untouched.motorState[m].q = static_cast<float>(m);
+    }
+    DecodeState(buff, STATE_SIZE, header, untouched);
+    for (int m = 16; m < 20; ++m)
+    {
+        EXPECT(untouched.motorState[m].q == static_cast<float>(m), "motor %d written", m);
+    }
+}
+
+// bitwise, so NaN read from a random IMU field still compares equal to itself
+static bool SameFloat(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static void TestAgainstFrozen()
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    L4W4SDK sdk;
+    sdk.client_socket = -1; // SendUDP's sendto fails, only sent_buff is compared
+
+    for (int sample = 0; sample < 10000; ++sample)
+    {
+        // the frozen encoder is only defined inside the ranges; the first samples hit both ends
+        LowCmd cmd = {};
+        for (size_t i = 0; i < COMMAND_WORDS; ++i)
+        {
+            const CommandWord &w = COMMAND_LAYOUT[i];
+            const float t = sample == 0 ? 0.0f : sample == 1 ? 1.0f : unit(rng);
+            cmd.motorCmd[w.motor].*w.field = (w.v_min + t * (w.v_max - w.v_min)) * w.sign;
+        }
+        uint8_t expected[256];
+        const int expected_len = frozen::SendUDP(cmd, expected);
+        sdk.SendUDP(cmd);
+        EXPECT(sdk.sent_len == expected_len, "sample %d: %d bytes instead of %d", sample, sdk.sent_len, expected_len);
+        EXPECT(memcmp(sdk.sent_buff, expected, expected_len) == 0, "sample %d: command packet differs", sample);
+
+        // any packet of the right length, including NaN and Inf in the float fields
+        uint8_t packet[STATE_SIZE];
+        for (uint8_t &b : packet) b = static_cast<uint8_t>(rng());
+        LowState frozen_state, state;
+        memset(&frozen_state, 0x5a, sizeof(frozen_state));
+        memset(&state, 0x5a, sizeof(state));
+        frozen::AnalyzeUDP(packet, frozen_state);
+        EXPECT(sdk.AnalyzeUDP(packet, STATE_SIZE, state), "sample %d: state rejected", sample);
+        for (int i = 0; i < 4; ++i)
+        {
+            EXPECT(SameFloat(state.imu.quaternion[i], frozen_state.imu.quaternion[i]), "sample %d: quaternion %d", sample, i);
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT(SameFloat(state.imu.gyroscope[i], frozen_state.imu.gyroscope[i]), "sample %d: gyroscope %d", sample, i);
+            EXPECT(SameFloat(state.imu.accelerometer[i], frozen_state.imu.accelerometer[i]), "sample %d: accelerometer %d", sample, i);
+        }
+        for (int m = 0; m < 20; ++m)
+        {
+            const MotorState &a = state.motorState[m], &b = frozen_state.motorState[m];
+            EXPECT(SameFloat(a.q, b.q) && SameFloat(a.dq, b.dq) && SameFloat(a.ddq, b.ddq) && SameFloat(a.q_raw, b.q_raw) &&
+                       SameFloat(a.dq_raw, b.dq_raw) && SameFloat(a.ddq_raw, b.ddq_raw),
+                   "sample %d: motor %d q %.9g/%.9g dq %.9g/%.9g", sample, m, a.q, b.q, a.dq, b.dq);
+        }
+        EXPECT(memcmp(state.wirelessRemote, frozen_state.wirelessRemote, sizeof(state.wirelessRemote)) == 0, "sample %d: wireless remote", sample);
+    }
+}
+
+int main()
+{
+    TestCommandWords();
+    TestStateWords();
+    TestStateHeader();
+    TestLengths();
+    TestAgainstFrozen();
+    printf("%zu command words, %zu state words: %s\n", COMMAND_WORDS, STATE_WORDS, failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+#ifndef ACTUATOR_NET_H
+#define ACTUATOR_NET_H
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace robot_joint_controller
+{
+    // Inlined evaluator for the actuator MLP trained by rl_sar/scripts/actuator_net.py.
+    // Loads the text export written by "actuator_net.py --mode export":
+    //   actuator_net <activation>
+    //   linear <out> <in> followed by out*in row-major weights and out biases, repeated per layer
+    // The activation is applied after every layer except the last. All buffers are sized in
+    // Load(), Evaluate() never allocates so it can run inside the physics update.
+    class ActuatorNet
+    {
+    public:
+        bool Load(const std::string &path, std::string &error)
+        {
+            std::ifstream file(path);
+            if (!file.is_open())
+            {
+                error = "cannot open " + path;
+                return false;
+            }
+            std::string tag, activation;
+            if (!(file >> tag >> activation) || tag != "actuator_net")
+            {
+                error = path + " is not an actuator_net export";
+                return false;
+            }
+            if (!ParseActivation(activation))
+            {
+                error = "unsupported activation " + activation;
+                return false;
+            }
+
+            layers.clear();
+            size_t max_width = 0;
+            while (file >> tag)
+            {
+                Layer layer;
+                if (tag != "linear" || !(file >> layer.out_dim >> layer.in_dim) || layer.out_dim == 0 || layer.in_dim == 0)
+                {
+                    error = "malformed layer header in " + path;
+                    return false;
+                }
+                if (!layers.empty() && layers.back().out_dim != layer.in_dim)
+                {
+                    error = "layer sizes do not chain in " + path;
+                    return false;
+                }
+                layer.weight.resize(layer.out_dim * layer.in_dim);
+                layer.bias.resize(layer.out_dim);
+                for (double &w : layer.weight)
+                {
+                    file >> w;
+                }
+                for (double &b : layer.bias)
+                {
+                    file >> b;
+                }
+                if (!file)
+                {
+                    error = "truncated weights in " + path;
+                    return false;
+                }
+                max_width = std::max(max_width, std::max(layer.in_dim, layer.out_dim));
+                layers.push_back(std::move(layer));
+            }
+            if (layers.empty() || layers.back().out_dim != 1)
+            {
+                error = path + " must end with a single output";
+                return false;
+            }
+            buffer_a.assign(max_width, 0.0);
+            buffer_b.assign(max_width, 0.0);
+            return true;
+        }
+
+        bool Loaded() const { return !layers.empty(); }
+        size_t InputSize() const { return layers.empty() ? 0 : layers.front().in_dim; }
+
+        double Evaluate(const double *input)
+        {
+            const double *x = input;
+            double *y = buffer_a.data();
+            for (size_t l = 0; l < layers.size(); ++l)
+            {
+                const Layer &layer = layers[l];
+                for (size_t o = 0; o < layer.out_dim; ++o)
+                {
+                    y[o] = layer.bias[o] + Dot(&layer.weight[o * layer.in_dim], x, layer.in_dim);
+                }
+                if (l + 1 < layers.size())
+                {
+                    Activate(y, layer.out_dim);
+                }
+                x = y;
+                y = (y == buffer_a.data()) ? buffer_b.data() : buffer_a.data();
+            }
+            return x[0];
+        }
+
+    private:
+        enum class Activation
+        {
+            RELU, LEAKY_RELU, SP, LEAKY_SP, ELU, LEAKY_ELU, SSP, LEAKY_SSP, TANH, LEAKY_TANH, SWISH, SOFTSIGN
+        };
+
+        struct Layer
+        {
+            size_t out_dim = 0;
+            size_t in_dim = 0;
+            std::vector<double> weight;
+            std::vector<double> bias;
+        };
+
+        // same names and constants as Act in actuator_net.py
+        bool ParseActivation(const std::string &name)
+        {
+            static const std::pair<const char *, Activation> table[] = {
+                {"relu", Activation::RELU}, {"leaky_relu", Activation::LEAKY_RELU},
+                {"sp", Activation::SP}, {"leaky_sp", Activation::LEAKY_SP},
+                {"elu", Activation::ELU}, {"leaky_elu", Activation::LEAKY_ELU},
+                {"ssp", Activation::SSP}, {"leaky_ssp", Activation::LEAKY_SSP},
+                {"tanh", Activation::TANH}, {"leaky_tanh", Activation::LEAKY_TANH},
+                {"swish", Activation::SWISH}, {"softsign", Activation::SOFTSIGN},
+            };
+            for (const auto &entry : table)
+            {
+                if (name == entry.first)
+                {
+                    activation = entry.second;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // independent partial sums so the compiler can keep several multiply-adds in flight
+        static double Dot(const double *w, const double *x, size_t n)
+        {
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                s0 += w[i] * x[i];
+                s1 += w[i + 1] * x[i + 1];
+                s2 += w[i + 2] * x[i + 2];
+                s3 += w[i + 3] * x[i + 3];
+            }
+            for (; i < n; ++i)
+            {
+                s0 += w[i] * x[i];
+            }
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        void Activate(double *x, size_t n) const
+        {
+            const double slope = 0.05;
+            const double shift = std::log(2.0);
+            switch (activation)
+            {
+            case Activation::RELU: for (size_t i = 0; i < n; ++i) x[i] = std::max(x[i], 0.0); break;
+            case Activation::LEAKY_RELU: for (size_t i = 0; i < n; ++i) x[i] = x[i] > 0.0 ? x[i] : 0.01 * x[i]; break;
+            case Activation::SP: for (size_t i = 0; i < n; ++i) x[i] = Softplus(x[i]); break;
+            case Activation::LEAKY_SP: for (size_t i = 0; i < n; ++i) x[i] = Softplus(x[i]) - slope * std::max(-x[i], 0.0); break;
+            case Activation::ELU: for (size_t i = 0; i < n; ++i) x[i] = x[i] > 0.0 ? x[i] : std::expm1(x[i]); break;
+            case Activation::LEAKY_ELU: for (size_t i = 0; i < n; ++i) x[i] = (x[i] > 0.0 ? x[i] : std::expm1(x[i])) - slope * std::max(-x[i], 0.0); break;
+            case Activation::SSP: for (size_t i = 0; i < n; ++i) x[i] = Softplus(x[i]) - shift; break;
+            case Activation::LEAKY_SSP: for (size_t i = 0; i < n; ++i) x[i] = Softplus(x[i]) - slope * std::max(-x[i], 0.0) - shift; break;
+            case Activation::TANH: for (size_t i = 0; i < n; ++i) x[i] = std::tanh(x[i]); break;
+            case Activation::LEAKY_TANH: for (size_t i = 0; i < n; ++i) x[i] = std::tanh(x[i]) + slope * x[i]; break;
+            case Activation::SWISH: for (size_t i = 0; i < n; ++i) x[i] = x[i] / (1.0 + std::exp(-x[i])); break;
+            case Activation::SOFTSIGN: for (size_t i = 0; i < n; ++i) x[i] = x[i] / (1.0 + std::fabs(x[i])); break;
+            }
+        }
+
+        // matches torch softplus with beta=1 and threshold=20
+        static double Softplus(double x) { return x > 20.0 ? x : std::log1p(std::exp(x)); }
+
+        Activation activation = Activation::SOFTSIGN;
+        std::vector<Layer> layers;
+        std::vector<double> buffer_a, buffer_b;
+    };
+}
+
+#endif
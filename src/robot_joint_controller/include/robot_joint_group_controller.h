@@ -0,0 +1,66 @@
+#ifndef ROBOT_JOINT_GROUP_CONTROLLER_H
+#define ROBOT_JOINT_GROUP_CONTROLLER_H
+
+#include "robot_joint_controller.h"
+#include "robot_joint_shm.h"
+#include "actuator_net.h"
+#include "robot_msgs/RobotCommand.h"
+#include "robot_msgs/RobotState.h"
+
+#include <vector>
+#include <string>
+
+namespace robot_joint_controller
+{
+    // Claims all joints of a robot and exchanges one RobotCommand and one RobotState per update.
+    // Slot i of both messages is the i-th entry of the "joints" parameter. Joint limits are resolved
+    // from the URDF once in init(), update() then runs the PD law over flat per-joint arrays.
+    class RobotJointGroupController : public controller_interface::Controller<hardware_interface::EffortJointInterface>
+    {
+    private:
+        std::vector<hardware_interface::JointHandle> joints;
+        ros::Subscriber sub_command;
+        std::unique_ptr<realtime_tools::RealtimePublisher<robot_msgs::RobotState>> controller_state_publisher_;
+
+    public:
+        std::string name_space;
+        std::vector<std::string> joint_names;
+        realtime_tools::RealtimeBuffer<robot_msgs::RobotCommand> command;
+        robot_msgs::RobotCommand lastCommand;
+
+        // joint limits, +-inf where the URDF joint type has none
+        std::vector<double> pos_lower, pos_upper, vel_limit, effort_limit;
+        // command and state of slot i
+        std::vector<double> cmd_q, cmd_dq, cmd_kp, cmd_kd, cmd_tau;
+        std::vector<double> state_q, state_dq, state_tau, torque;
+
+        // optional shared memory transport, replaces the command/state topics when "shared_memory" is set
+        std::string shm_name;
+        shm::Region *shm_region;
+        shm::State shm_state;
+        shm::Command shm_command;
+        uint32_t shm_command_seq;
+        bool lockstep;
+        double lockstep_timeout;
+
+        // optional learned actuator model, replaces the ideal PD law for joints in position mode.
+        // Inputs are position error and velocity at t, t-1, t-2 with history_period between samples.
+        ActuatorNet actuator_net;
+        double history_period;
+        double history_elapsed;
+        std::vector<double> pos_err_hist1, pos_err_hist2, vel_hist1, vel_hist2;
+
+        RobotJointGroupController();
+        ~RobotJointGroupController();
+        virtual bool init(hardware_interface::EffortJointInterface *robot, ros::NodeHandle &n);
+        virtual void starting(const ros::Time &time);
+        virtual void update(const ros::Time &time, const ros::Duration &period);
+        virtual void stopping();
+        void setCommandCB(const robot_msgs::RobotCommandConstPtr &msg);
+        void readSharedMemoryCommand();
+        void readTopicCommand();
+        void applyActuatorNet(double dt);
+    };
+}
+
+#endif
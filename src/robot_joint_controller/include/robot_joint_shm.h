@@ -0,0 +1,250 @@
+#ifndef ROBOT_JOINT_SHM_H
+#define ROBOT_JOINT_SHM_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace robot_joint_controller
+{
+    // Fixed-layout region shared by RobotJointGroupController (creator) and rl_sim (attacher).
+    // Each direction is a seqlock: the sequence is odd while the writer copies, and the same
+    // word is the futex the reader sleeps on, so a state write wakes rl_sim directly.
+    namespace shm
+    {
+        const uint32_t MAGIC = 0x524a5348; // "RJSH"
+        const uint32_t VERSION = 1;
+        const int MAX_JOINTS = 32;
+        // a writer copies a few hundred bytes, far fewer attempts than this see it finish; an odd
+        // sequence that outlasts them belongs to a writer that died in the middle of a copy
+        const int READ_ATTEMPTS = 10000;
+
+        struct MotorCommand
+        {
+            double q;
+            double dq;
+            double tau;
+            double kp;
+            double kd;
+        };
+
+        struct MotorState
+        {
+            double q;
+            double dq;
+            double tau_est;
+        };
+
+        struct State
+        {
+            uint64_t tick;   // controller update counter
+            double sim_time; // seconds
+            double period;   // controller update period in seconds
+            MotorState motor_state[MAX_JOINTS];
+        };
+
+        struct Command
+        {
+            uint64_t ack_tick;  // state tick this command was computed from
+            uint64_t wait_tick; // state tick after which a lockstep controller waits for the next command
+            MotorCommand motor_command[MAX_JOINTS];
+        };
+
+        template <typename T>
+        struct alignas(64) Channel
+        {
+            std::atomic<uint32_t> seq;
+            T data;
+        };
+
+        struct Region
+        {
+            std::atomic<uint32_t> magic;
+            uint32_t version;
+            uint32_t num_joints;
+            Channel<State> state;
+            Channel<Command> command;
+        };
+
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bit");
+
+        inline void Wake(std::atomic<uint32_t> &seq)
+        {
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&seq), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+        }
+
+        // Blocks until the sequence moves past last_seq, returns false on timeout
+        inline bool Wait(std::atomic<uint32_t> &seq, uint32_t last_seq, double timeout)
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += static_cast<time_t>(timeout);
+            deadline.tv_nsec += static_cast<long>((timeout - static_cast<time_t>(timeout)) * 1e9);
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            while (true)
+            {
+                uint32_t current = seq.load(std::memory_order_acquire);
+                if (current != last_seq && !(current & 1))
+                {
+                    return true;
+                }
+                struct timespec now, remaining;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+                remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+                if (remaining.tv_nsec < 0)
+                {
+                    remaining.tv_sec -= 1;
+                    remaining.tv_nsec += 1000000000L;
+                }
+                if (remaining.tv_sec < 0)
+                {
+                    return false;
+                }
+                syscall(SYS_futex, reinterpret_cast<uint32_t *>(&seq), FUTEX_WAIT, current, &remaining, nullptr, 0);
+            }
+        }
+
+        template <typename T>
+        inline void Write(Channel<T> &channel, const T &value)
+        {
+            uint32_t seq = channel.seq.load(std::memory_order_relaxed);
+            channel.seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(&channel.data, &value, sizeof(T));
+            channel.seq.store(seq + 2, std::memory_order_release);
+            Wake(channel.seq);
+        }
+
+        // Copies a consistent snapshot into value and the sequence it belongs to into seq. Returns
+        // false, leaving both untouched, when no consistent copy was made within READ_ATTEMPTS.
+        template <typename T>
+        inline bool Read(const Channel<T> &channel, T &value, uint32_t &seq)
+        {
+            T snapshot;
+            for (int attempt = 0; attempt < READ_ATTEMPTS; ++attempt)
+            {
+                uint32_t current = channel.seq.load(std::memory_order_acquire);
+                if (current & 1)
+                {
+                    continue;
+                }
+                std::memcpy(&snapshot, &channel.data, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (channel.seq.load(std::memory_order_relaxed) == current)
+                {
+                    value = snapshot;
+                    seq = current;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Owner only readable and writable. A controller that exits calls Remove(), and rl_sim
+        // notices the cleared magic and attaches to whatever the next controller creates.
+        inline Region *Create(const std::string &name, uint32_t num_joints)
+        {
+            int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+            if (fd < 0)
+            {
+                return nullptr;
+            }
+            if (ftruncate(fd, sizeof(Region)) != 0)
+            {
+                close(fd);
+                return nullptr;
+            }
+            void *addr = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (addr == MAP_FAILED)
+            {
+                return nullptr;
+            }
+            // a region left by a controller that crashed is reused in place, so an rl_sim still
+            // attached to it keeps working; that controller may have died inside Write() with an
+            // odd sequence, which would invert the seqlock for every later write
+            Region *region = static_cast<Region *>(addr);
+            region->magic.store(0, std::memory_order_relaxed);
+            std::memset(&region->state.data, 0, sizeof(region->state.data));
+            std::memset(&region->command.data, 0, sizeof(region->command.data));
+            region->state.seq.store(0, std::memory_order_relaxed);
+            region->command.seq.store(0, std::memory_order_relaxed);
+            region->version = VERSION;
+            region->num_joints = num_joints;
+            region->magic.store(MAGIC, std::memory_order_release);
+            Wake(region->state.seq);
+            Wake(region->command.seq);
+            return region;
+        }
+
+        inline Region *Attach(const std::string &name)
+        {
+            int fd = shm_open(name.c_str(), O_RDWR, 0600);
+            if (fd < 0)
+            {
+                return nullptr;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Region)))
+            {
+                close(fd);
+                return nullptr;
+            }
+            void *addr = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (addr == MAP_FAILED)
+            {
+                return nullptr;
+            }
+            Region *region = static_cast<Region *>(addr);
+            if (region->magic.load(std::memory_order_acquire) != MAGIC || region->version != VERSION)
+            {
+                munmap(addr, sizeof(Region));
+                return nullptr;
+            }
+            return region;
+        }
+
+        // false once the creator has removed the region, the attacher should detach and attach again
+        inline bool Alive(const Region *region)
+        {
+            return region->magic.load(std::memory_order_acquire) == MAGIC;
+        }
+
+        inline void Detach(Region *region)
+        {
+            if (region)
+            {
+                munmap(region, sizeof(Region));
+            }
+        }
+
+        // creator only: marks the region dead for attachers still mapping it and unlinks the name
+        inline void Remove(Region *region, const std::string &name)
+        {
+            if (region)
+            {
+                region->magic.store(0, std::memory_order_release);
+                Wake(region->state.seq);
+                Detach(region);
+                shm_unlink(name.c_str());
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Physics-step cost of the group controller with and without the actuator network, without ROS
+// or Gazebo. A step is the per-joint work of RobotJointGroupController::update(): the clamped PD
+// law over all joints, then for the network the history shift and one evaluation per joint as in
+// applyActuatorNet().
+//
+//   actuator_net_benchmark [export.txt] [joints]
+//
+// Without an export a network of actuator_net.py's default shape (6-32-32-1, softsign) with random
+// weights is written and loaded, and Evaluate() is checked against a plain reference forward pass.
+// Exits non-zero when the export cannot be loaded or the evaluation disagrees with the reference.
+
+#include "actuator_net.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace robot_joint_controller;
+
+struct DenseLayer
+{
+    int out_dim, in_dim;
+    std::vector<double> weight, bias;
+};
+
+static std::vector<DenseLayer> RandomNetwork(std::mt19937 &rng)
+{
+    std::normal_distribution<double> weight(0.0, 0.3);
+    const int dims[] = {6, 32, 32, 1};
+    std::vector<DenseLayer> layers;
+    for (int l = 0; l + 1 < 4; ++l)
+    {
+        DenseLayer layer = {dims[l + 1], dims[l], std::vector<double>(dims[l + 1] * dims[l]), std::vector<double>(dims[l + 1])};
+        for (double &w : layer.weight) w = weight(rng);
+        for (double &b : layer.bias) b = weight(rng);
+        layers.push_back(layer);
+    }
+    return layers;
+}
+
+// the format of "actuator_net.py --mode export"
+static bool WriteExport(const std::string &path, const std::vector<DenseLayer> &layers)
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "actuator_net softsign\n");
+    for (const DenseLayer &layer : layers)
+    {
+        fprintf(file, "linear %d %d\n", layer.out_dim, layer.in_dim);
+        for (double w : layer.weight) fprintf(file, "%.17g ", w);
+        fprintf(file, "\n");
+        for (double b : layer.bias) fprintf(file, "%.17g ", b);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+static double Reference(const std::vector<DenseLayer> &layers, const double *input)
+{
+    std::vector<double> x(input, input + layers.front().in_dim);
+    for (size_t l = 0; l < layers.size(); ++l)
+    {
+        std::vector<double> y(layers[l].out_dim);
+        for (int o = 0; o < layers[l].out_dim; ++o)
+        {
+            y[o] = layers[l].bias[o];
+            for (int i = 0; i < layers[l].in_dim; ++i)
+            {
+                y[o] += layers[l].weight[o * layers[l].in_dim + i] * x[i];
+            }
+            if (l + 1 < layers.size())
+            {
+                y[o] = y[o] / (1.0 + std::fabs(y[o]));
+            }
+        }
+        x = y;
+    }
+    return x[0];
+}
+
+struct Joints
+{
+    std::vector<double> cmd_q, cmd_dq, cmd_kp, cmd_kd, cmd_tau, state_q, state_dq, torque;
+    std::vector<double> pos_lower, pos_upper, vel_limit, effort_limit;
+    std::vector<double> pos_err_hist1, pos_err_hist2, vel_hist1, vel_hist2;
+};
+
+// ns per physics step, the joint state moves every step so nothing is hoisted
+static double Step(Joints &j, ActuatorNet *net, int steps, double &checksum)
+{
+    const size_t n = j.cmd_q.size();
+    const double dt = 0.0005, history_period = 0.02;
+    double history_elapsed = 0.0;
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; ++step)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            j.state_q[i] = 0.3 * std::sin(1e-3 * step + i);
+            j.state_dq[i] = 0.3 * std::cos(1e-3 * step + i);
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            double pos = std::min(std::max(j.cmd_q[i], j.pos_lower[i]), j.pos_upper[i]);
+            double vel = std::min(std::max(j.cmd_dq[i], -j.vel_limit[i]), j.vel_limit[i]);
+            double tau = std::min(std::max(j.cmd_tau[i], -j.effort_limit[i]), j.effort_limit[i]);
+            double torque = j.cmd_kp[i] * (pos - j.state_q[i]) + j.cmd_kd[i] * (vel - j.state_dq[i]) + tau;
+            j.torque[i] = std::min(std::max(torque, -j.effort_limit[i]), j.effort_limit[i]);
+        }
+        if (net)
+        {
+            double input[6];
+            for (size_t i = 0; i < n; ++i)
+            {
+                double pos_err = std::min(std::max(j.cmd_q[i], j.pos_lower[i]), j.pos_upper[i]) - j.state_q[i];
+                input[0] = pos_err;
+                input[1] = j.pos_err_hist1[i];
+                input[2] = j.pos_err_hist2[i];
+                input[3] = j.state_dq[i];
+                input[4] = j.vel_hist1[i];
+                input[5] = j.vel_hist2[i];
+                j.torque[i] = std::min(std::max(net->Evaluate(input), -j.effort_limit[i]), j.effort_limit[i]);
+                if (history_elapsed + dt >= history_period)
+                {
+                    j.pos_err_hist2[i] = j.pos_err_hist1[i];
+                    j.pos_err_hist1[i] = pos_err;
+                    j.vel_hist2[i] = j.vel_hist1[i];
+                    j.vel_hist1[i] = j.state_dq[i];
+                }
+            }
+            history_elapsed += dt;
+            if (history_elapsed >= history_period)
+            {
+                history_elapsed -= history_period;
+            }
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            checksum += j.torque[i];
+        }
+    }
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / steps;
+}
+
+int main(int argc, char **argv)
+{
+    std::string path = argc > 1 ? argv[1] : "";
+    const int num_joints = argc > 2 ? atoi(argv[2]) : 12;
+    std::mt19937 rng(0);
+
+    std::vector<DenseLayer> reference;
+    if (path.empty())
+    {
+        reference = RandomNetwork(rng);
+        char temporary[] = "/tmp/actuator_net_benchmark_XXXXXX";
+        int fd = mkstemp(temporary);
+        if (fd < 0)
+        {
+            printf("cannot create a temporary export\n");
+            return 1;
+        }
+        close(fd);
+        path = temporary;
+        if (!WriteExport(path, reference))
+        {
+            printf("cannot write %s\n", path.c_str());
+            return 1;
+        }
+    }
+    ActuatorNet net;
+    std::string error;
+    const bool loaded = net.Load(path, error);
+    if (!reference.empty())
+    {
+        unlink(path.c_str());
+    }
+    if (!loaded)
+    {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+
+    double max_error = 0.0;
+    if (!reference.empty())
+    {
+        std::uniform_real_distribution<double> value(-3.0, 3.0);
+        for (int sample = 0; sample < 1000; ++sample)
+        {
+            double input[6];
+            for (double &x : input) x = value(rng);
+            max_error = std::max(max_error, std::fabs(net.Evaluate(input) - Reference(reference, input)));
+        }
+    }
+
+    const double inf = std::numeric_limits<double>::infinity();
+    Joints joints;
+    for (std::vector<double> *v : {&joints.cmd_q, &joints.cmd_dq, &joints.cmd_tau, &joints.state_q, &joints.state_dq, &joints.torque,
+                                   &joints.pos_err_hist1, &joints.pos_err_hist2, &joints.vel_hist1, &joints.vel_hist2})
+    {
+        v->assign(num_joints, 0.0);
+    }
+    joints.cmd_kp.assign(num_joints, 20.0);
+    joints.cmd_kd.assign(num_joints, 0.5);
+    joints.pos_lower.assign(num_joints, -2.0);
+    joints.pos_upper.assign(num_joints, 2.0);
+    joints.vel_limit.assign(num_joints, inf);
+    joints.effort_limit.assign(num_joints, 33.5);
+
+    const int steps = 200000;
+    double checksum = 0.0;
+    Step(joints, &net, steps / 10, checksum); // warm up
+    const double pd = Step(joints, nullptr, steps, checksum);
+    const double with_net = Step(joints, &net, steps, checksum);
+    const double budget = 0.0005 * 1e9; // earth.world steps at 2 kHz
+
+    printf("%s, %d joints, input size %zu\n", argc > 1 ? argv[1] : "random 6-32-32-1 softsign", num_joints, net.InputSize());
+    if (!reference.empty())
+    {
+        printf("evaluate against reference: max error %.1e\n", max_error);
+    }
+    printf("physics step: PD %.0f ns, PD + actuator net %.0f ns (+%.0f ns, %.0f ns per joint), %.2f %% of the 2 kHz step\n", pd, with_net,
+           with_net - pd, (with_net - pd) / num_joints, with_net / budget * 100.0);
+    printf("checksum %.3f\n", checksum);
+    return max_error < 1e-12 ? 0 : 1;
+}
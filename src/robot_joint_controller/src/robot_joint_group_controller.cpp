@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "robot_joint_group_controller.h"
+#include <pluginlib/class_list_macros.h>
+#include <limits>
+
+namespace robot_joint_controller
+{
+
+    RobotJointGroupController::RobotJointGroupController()
+        : shm_region(nullptr), shm_command_seq(0), lockstep(false), lockstep_timeout(0.05), history_period(0.02), history_elapsed(0.0) {}
+
+    RobotJointGroupController::~RobotJointGroupController()
+    {
+        sub_command.shutdown();
+        shm::Remove(shm_region, shm_name);
+    }
+
+    void RobotJointGroupController::setCommandCB(const robot_msgs::RobotCommandConstPtr &msg)
+    {
+        // the whole joint set is swapped at once, so an update never sees a torn command
+        command.writeFromNonRT(*msg);
+    }
+
+    // Controller initialization in non-realtime
+    bool RobotJointGroupController::init(hardware_interface::EffortJointInterface *robot, ros::NodeHandle &n)
+    {
+        name_space = n.getNamespace();
+        if (!n.getParam("joints", joint_names) || joint_names.empty())
+        {
+            ROS_ERROR("No joints given in namespace: '%s')", n.getNamespace().c_str());
+            return false;
+        }
+        if (joint_names.size() > lastCommand.motor_command.size())
+        {
+            ROS_ERROR("Too many joints (%zu) in namespace: '%s', at most %zu are supported", joint_names.size(), n.getNamespace().c_str(), lastCommand.motor_command.size());
+            return false;
+        }
+
+        urdf::Model urdf; // Get URDF info about all joints
+        if (!urdf.initParamWithNodeHandle("robot_description", n))
+        {
+            ROS_ERROR("Failed to parse urdf file");
+            return false;
+        }
+        const double inf = std::numeric_limits<double>::infinity();
+        for (const std::string &joint_name : joint_names)
+        {
+            urdf::JointConstSharedPtr joint_urdf = urdf.getJoint(joint_name);
+            if (!joint_urdf)
+            {
+                ROS_ERROR("Could not find joint '%s' in urdf", joint_name.c_str());
+                return false;
+            }
+            // only revolute and prismatic joints are clamped, same as RobotJointController
+            if ((joint_urdf->type == urdf::Joint::REVOLUTE || joint_urdf->type == urdf::Joint::PRISMATIC) && joint_urdf->limits)
+            {
+                pos_lower.push_back(joint_urdf->limits->lower);
+                pos_upper.push_back(joint_urdf->limits->upper);
+                vel_limit.push_back(joint_urdf->limits->velocity);
+                effort_limit.push_back(joint_urdf->limits->effort);
+            }
+            else
+            {
+                pos_lower.push_back(-inf);
+                pos_upper.push_back(inf);
+                vel_limit.push_back(inf);
+                effort_limit.push_back(inf);
+            }
+            joints.push_back(robot->getHandle(joint_name));
+        }
+        const size_t num_joints = joints.size();
+        cmd_q.assign(num_joints, 0.0);
+        cmd_dq.assign(num_joints, 0.0);
+        cmd_kp.assign(num_joints, 0.0);
+        cmd_kd.assign(num_joints, 0.0);
+        cmd_tau.assign(num_joints, 0.0);
+        state_q.assign(num_joints, 0.0);
+        state_dq.assign(num_joints, 0.0);
+        state_tau.assign(num_joints, 0.0);
+        torque.assign(num_joints, 0.0);
+
+        std::string actuator_net_path;
+        n.param<std::string>("actuator_net", actuator_net_path, "");
+        n.param<double>("actuator_net_history_period", history_period, 0.02);
+        if (!actuator_net_path.empty())
+        {
+            std::string error;
+            if (!actuator_net.Load(actuator_net_path, error))
+            {
+                ROS_ERROR("Failed to load actuator net: %s", error.c_str());
+                return false;
+            }
+            if (actuator_net.InputSize() != 6)
+            {
+                ROS_ERROR("Actuator net %s takes %zu inputs, expected 6", actuator_net_path.c_str(), actuator_net.InputSize());
+                return false;
+            }
+            ROS_INFO("Using actuator net %s", actuator_net_path.c_str());
+        }
+        pos_err_hist1.assign(num_joints, 0.0);
+        pos_err_hist2.assign(num_joints, 0.0);
+        vel_hist1.assign(num_joints, 0.0);
+        vel_hist2.assign(num_joints, 0.0);
+
+        n.param<std::string>("shared_memory", shm_name, "");
+        n.param<bool>("lockstep", lockstep, false);
+        n.param<double>("lockstep_timeout", lockstep_timeout, 0.05);
+        if (!shm_name.empty())
+        {
+            shm_region = shm::Create(shm_name, joint_names.size());
+            if (!shm_region)
+            {
+                ROS_ERROR("Failed to create shared memory '%s': %s", shm_name.c_str(), strerror(errno));
+                return false;
+            }
+            ROS_INFO("Exchanging commands and states through shared memory '%s'%s", shm_name.c_str(), lockstep ? " in lockstep" : "");
+        }
+        else
+        {
+            // Start command subscriber
+            sub_command = n.subscribe("command", 20, &RobotJointGroupController::setCommandCB, this);
+        }
+
+        // Start realtime state publisher
+        controller_state_publisher_.reset(
+            new realtime_tools::RealtimePublisher<robot_msgs::RobotState>(n, name_space + "/state", 1));
+
+        return true;
+    }
+
+    // Controller startup in realtime
+    void RobotJointGroupController::starting(const ros::Time &time)
+    {
+        lastCommand = robot_msgs::RobotCommand();
+        for (size_t i = 0; i < joints.size(); ++i)
+        {
+            double init_pos = joints[i].getPosition();
+            lastCommand.motor_command[i].q = init_pos;
+            state_q[i] = init_pos;
+            state_dq[i] = 0.0;
+        }
+        command.initRT(lastCommand);
+
+        std::fill(pos_err_hist1.begin(), pos_err_hist1.end(), 0.0);
+        std::fill(pos_err_hist2.begin(), pos_err_hist2.end(), 0.0);
+        std::fill(vel_hist1.begin(), vel_hist1.end(), 0.0);
+        std::fill(vel_hist2.begin(), vel_hist2.end(), 0.0);
+        history_elapsed = 0.0;
+
+        if (shm_region)
+        {
+            shm_state = shm::State();
+            shm_command = shm::Command();
+            for (size_t i = 0; i < joints.size(); ++i)
+            {
+                shm_command.motor_command[i].q = lastCommand.motor_command[i].q;
+            }
+            // anything left from a previous run must not drive the robot
+            shm_command_seq = shm_region->command.seq.load(std::memory_order_acquire);
+        }
+    }
+
+    void RobotJointGroupController::readSharedMemoryCommand()
+    {
+        uint32_t seq = shm_region->command.seq.load(std::memory_order_acquire);
+        // a command that cannot be read consistently is skipped, the previous one stays in force
+        if (seq != shm_command_seq && !(seq & 1))
+        {
+            shm::Read(shm_region->command, shm_command, shm_command_seq);
+        }
+        if (lockstep && shm_command.wait_tick == shm_state.tick)
+        {
+            // hold the physics step until rl_sim answers this state
+            while (shm_command.ack_tick < shm_state.tick && shm::Wait(shm_region->command.seq, shm_command_seq, lockstep_timeout))
+            {
+                if (!shm::Read(shm_region->command, shm_command, shm_command_seq))
+                {
+                    break;
+                }
+            }
+        }
+        for (size_t i = 0; i < joints.size(); ++i)
+        {
+            const shm::MotorCommand &motorCommand = shm_command.motor_command[i];
+            cmd_q[i] = motorCommand.q;
+            cmd_dq[i] = motorCommand.dq;
+            cmd_kp[i] = motorCommand.kp;
+            cmd_kd[i] = motorCommand.kd;
+            cmd_tau[i] = motorCommand.tau;
+        }
+    }
+
+    void RobotJointGroupController::readTopicCommand()
+    {
+        const robot_msgs::RobotCommand &msg = *(command.readFromRT());
+        for (size_t i = 0; i < joints.size(); ++i)
+        {
+            const robot_msgs::MotorCommand &motorCommand = msg.motor_command[i];
+            cmd_q[i] = motorCommand.q;
+            cmd_dq[i] = motorCommand.dq;
+            cmd_kp[i] = motorCommand.kp;
+            cmd_kd[i] = motorCommand.kd;
+            cmd_tau[i] = motorCommand.tau;
+        }
+    }
+
+    // Controller update loop in realtime
+    void RobotJointGroupController::update(const ros::Time &time, const ros::Duration &period)
+    {
+        const size_t num_joints = joints.size();
+        const double dt = period.toSec();
+
+        // sample all joints first so the state can be handed out before the command is consumed
+        for (size_t i = 0; i < num_joints; ++i)
+        {
+            double currentPos = joints[i].getPosition();
+            state_dq[i] = (currentPos - state_q[i]) / dt;
+            state_q[i] = currentPos;
+            state_tau[i] = joints[i].getEffort();
+        }
+
+        if (shm_region)
+        {
+            shm_state.tick++;
+            shm_state.sim_time = time.toSec();
+            shm_state.period = dt;
+            for (size_t i = 0; i < num_joints; ++i)
+            {
+                shm_state.motor_state[i].q = state_q[i];
+                shm_state.motor_state[i].dq = state_dq[i];
+                shm_state.motor_state[i].tau_est = state_tau[i];
+            }
+            shm::Write(shm_region->state, shm_state);
+            readSharedMemoryCommand();
+        }
+        else
+        {
+            readTopicCommand();
+        }
+
+        // branch-free PD over all joints, PosStopF/VelStopF switch the corresponding gain off
+        for (size_t i = 0; i < num_joints; ++i)
+        {
+            double pos = std::min(std::max(cmd_q[i], pos_lower[i]), pos_upper[i]);
+            double posStiffness = (fabs(cmd_q[i] - PosStopF) < 0.00001) ? 0.0 : cmd_kp[i];
+            double vel = std::min(std::max(cmd_dq[i], -vel_limit[i]), vel_limit[i]);
+            double velStiffness = (fabs(cmd_dq[i] - VelStopF) < 0.00001) ? 0.0 : cmd_kd[i];
+            double tau = std::min(std::max(cmd_tau[i], -effort_limit[i]), effort_limit[i]);
+            double calcTorque = posStiffness * (pos - state_q[i]) + velStiffness * (vel - state_dq[i]) + tau;
+            torque[i] = std::min(std::max(calcTorque, -effort_limit[i]), effort_limit[i]);
+        }
+
+        if (actuator_net.Loaded())
+        {
+            applyActuatorNet(dt);
+        }
+
+        for (size_t i = 0; i < num_joints; ++i)
+        {
+            joints[i].setCommand(torque[i]);
+        }
+
+        // publish state
+        if (controller_state_publisher_ && controller_state_publisher_->trylock())
+        {
+            for (size_t i = 0; i < num_joints; ++i)
+            {
+                robot_msgs::MotorState &motorState = controller_state_publisher_->msg_.motor_state[i];
+                motorState.q = state_q[i];
+                motorState.dq = state_dq[i];
+                motorState.tau_est = state_tau[i];
+            }
+            controller_state_publisher_->unlockAndPublish();
+        }
+    }
+
+    void RobotJointGroupController::applyActuatorNet(double dt)
+    {
+        double input[6];
+        for (size_t i = 0; i < joints.size(); ++i)
+        {
+            double pos_err = std::min(std::max(cmd_q[i], pos_lower[i]), pos_upper[i]) - state_q[i];
+            bool position_mode = cmd_kp[i] > 0.0 && fabs(cmd_q[i] - PosStopF) >= 0.00001;
+            if (position_mode)
+            {
+                input[0] = pos_err;
+                input[1] = pos_err_hist1[i];
+                input[2] = pos_err_hist2[i];
+                input[3] = state_dq[i];
+                input[4] = vel_hist1[i];
+                input[5] = vel_hist2[i];
+                torque[i] = std::min(std::max(actuator_net.Evaluate(input), -effort_limit[i]), effort_limit[i]);
+            }
+            else
+            {
+                pos_err = 0.0;
+            }
+            if (history_elapsed + dt >= history_period)
+            {
+                pos_err_hist2[i] = pos_err_hist1[i];
+                pos_err_hist1[i] = pos_err;
+                vel_hist2[i] = vel_hist1[i];
+                vel_hist1[i] = state_dq[i];
+            }
+        }
+
+        // the network was trained on samples logged at the policy rate, not the physics rate
+        history_elapsed += dt;
+        if (history_elapsed >= history_period)
+        {
+            history_elapsed -= history_period;
+        }
+    }
+
+    // Controller stopping in realtime
+    void RobotJointGroupController::stopping() {}
+
+} // namespace
+
+// Register controller to pluginlib
+PLUGINLIB_EXPORT_CLASS(robot_joint_controller::RobotJointGroupController, controller_interface::ControllerBase);
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2024-2025 Ziqi Fan
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Loopback check and round-trip latency of the shared memory transport, without ROS or Gazebo:
+// a controller thread creates the region and writes a state every period, an rl_sim thread maps it
+// separately, waits on the state futex and answers each state with a command, the way the group
+// controller in lockstep and rl_sim's SharedMemoryLoop do.
+//
+//   robot_joint_shm_benchmark [ticks] [period_us] [--ros]
+//
+// Every state and command carries its tick in every field, so a torn copy is detected on either
+// side; a writer stuck halfway and a removed region are checked at the end. With --ros the same
+// exchange then runs over the group controller's RobotState and RobotCommand topics, answered by a
+// forked node so it crosses processes like Gazebo and rl_sim, and both round trips are printed
+// together; this needs a running roscore. Exits non-zero when anything is torn, lost or hangs.
+
+#include "robot_joint_shm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include "robot_msgs/RobotCommand.h"
+#include "robot_msgs/RobotState.h"
+
+using namespace robot_joint_controller;
+
+static const int NUM_JOINTS = 12;
+
+static double Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool StateConsistent(const shm::State &state)
+{
+    for (int i = 0; i < shm::MAX_JOINTS; ++i)
+    {
+        const double expected = static_cast<double>(state.tick) + i;
+        if (state.motor_state[i].q != expected || state.motor_state[i].dq != -expected || state.motor_state[i].tau_est != expected)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CommandConsistent(const shm::Command &command)
+{
+    for (int i = 0; i < shm::MAX_JOINTS; ++i)
+    {
+        const double expected = static_cast<double>(command.ack_tick) + i;
+        const shm::MotorCommand &motor = command.motor_command[i];
+        if (motor.q != expected || motor.dq != -expected || motor.kp != expected || motor.kd != expected || motor.tau != expected)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double Percentile(std::vector<double> &values, double p)
+{
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static void PrintRoundTrips(const char *transport, std::vector<double> &round_trips)
+{
+    if (round_trips.empty())
+    {
+        printf("%-5s round trip us: no samples\n", transport);
+        return;
+    }
+    printf("%-5s round trip us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n", transport, Percentile(round_trips, 0.5),
+           Percentile(round_trips, 0.9), Percentile(round_trips, 0.99), Percentile(round_trips, 0.999),
+           *std::max_element(round_trips.begin(), round_trips.end()));
+}
+
+// float32 fields hold the tick exactly up to 2^24, far more than a run has
+static const char *ROS_STATE_TOPIC = "/robot_joint_shm_benchmark/state";
+static const char *ROS_COMMAND_TOPIC = "/robot_joint_shm_benchmark/command";
+
+// rl_sim side of the topic exchange, in its own process: answers every state with a command
+static void RosAnswer()
+{
+    int argc = 0;
+    ros::init(argc, nullptr, "robot_joint_shm_benchmark_answer", ros::init_options::AnonymousName | ros::init_options::NoSigintHandler);
+    ros::NodeHandle nh;
+    ros::Publisher publisher = nh.advertise<robot_msgs::RobotCommand>(ROS_COMMAND_TOPIC, 20);
+    robot_msgs::RobotCommand command;
+    ros::Subscriber subscriber = nh.subscribe<robot_msgs::RobotState>(ROS_STATE_TOPIC, 20,
+        [&](const robot_msgs::RobotState::ConstPtr &state)
+        {
+            const float tick = state->motor_state[0].q;
+            for (int i = 0; i < shm::MAX_JOINTS; ++i)
+            {
+                const float value = tick + i;
+                robot_msgs::MotorCommand &motor = command.motor_command[i];
+                motor.q = value;
+                motor.dq = -value;
+                motor.tau = value;
+                motor.kp = value;
+                motor.kd = value;
+            }
+            publisher.publish(command);
+        });
+    ros::spin(); // until the controller side terminates this process
+}
+
+// controller side of the topic exchange, the same measurement as the shared memory loop; returns
+// false when no master is running or the answering node never connects
+static bool RosRoundTrips(int ticks, int period_us, std::vector<double> &round_trips, int &torn, int &lost)
+{
+    const pid_t child = fork();
+    if (child < 0)
+    {
+        printf("cannot fork the answering node: %s\n", strerror(errno));
+        return false;
+    }
+    if (child == 0)
+    {
+        RosAnswer();
+        _exit(0);
+    }
+
+    int argc = 0;
+    ros::init(argc, nullptr, "robot_joint_shm_benchmark", ros::init_options::AnonymousName | ros::init_options::NoSigintHandler);
+    bool ok = ros::master::check();
+    if (!ok)
+    {
+        printf("no ROS master, start roscore for --ros\n");
+    }
+    else
+    {
+        ros::NodeHandle nh;
+        // queue sizes of the group controller's state publisher and command subscriber
+        ros::Publisher publisher = nh.advertise<robot_msgs::RobotState>(ROS_STATE_TOPIC, 1);
+        robot_msgs::RobotCommand command;
+        bool received = false;
+        ros::Subscriber subscriber = nh.subscribe<robot_msgs::RobotCommand>(ROS_COMMAND_TOPIC, 20,
+            [&](const robot_msgs::RobotCommand::ConstPtr &message)
+            {
+                command = *message;
+                received = true;
+            });
+        const double connect_deadline = Now() + 5.0;
+        while ((publisher.getNumSubscribers() == 0 || subscriber.getNumPublishers() == 0) && Now() < connect_deadline)
+        {
+            ros::getGlobalCallbackQueue()->callAvailable(ros::WallDuration(0.01));
+        }
+        ok = publisher.getNumSubscribers() > 0 && subscriber.getNumPublishers() > 0;
+        if (!ok)
+        {
+            printf("the answering node did not connect\n");
+        }
+
+        robot_msgs::RobotState state;
+        double next = Now();
+        for (int tick = 1; ok && tick <= ticks; ++tick)
+        {
+            for (int i = 0; i < shm::MAX_JOINTS; ++i)
+            {
+                const float value = static_cast<float>(tick + i);
+                state.motor_state[i].q = value;
+                state.motor_state[i].dq = -value;
+                state.motor_state[i].tau_est = value;
+            }
+            const double sent = Now();
+            publisher.publish(state);
+            bool answered_tick = false;
+            while (!answered_tick && Now() - sent < 0.1)
+            {
+                received = false;
+                ros::getGlobalCallbackQueue()->callAvailable(ros::WallDuration(std::max(0.0, 0.1 - (Now() - sent))));
+                if (!received)
+                {
+                    continue;
+                }
+                bool consistent = true;
+                for (int i = 0; i < shm::MAX_JOINTS; ++i)
+                {
+                    const float value = command.motor_command[0].q + i;
+                    const robot_msgs::MotorCommand &motor = command.motor_command[i];
+                    consistent = consistent && motor.q == value && motor.dq == -value && motor.kp == value && motor.kd == value && motor.tau == value;
+                }
+                if (!consistent)
+                {
+                    ++torn;
+                }
+                answered_tick = command.motor_command[0].q == static_cast<float>(tick);
+            }
+            if (!answered_tick)
+            {
+                ++lost;
+                continue;
+            }
+            round_trips.push_back((Now() - sent) * 1e6);
+            next += period_us * 1e-6;
+            while (Now() < next)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    ros::shutdown();
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> positional;
+    bool with_ros = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--ros") with_ros = true;
+        else positional.push_back(argv[i]);
+    }
+    const int ticks = positional.size() > 0 ? atoi(positional[0].c_str()) : 20000;
+    const int period_us = positional.size() > 1 ? atoi(positional[1].c_str()) : 1000;
+    const std::string name = "/robot_joint_shm_benchmark_" + std::to_string(getpid());
+
+    shm::Region *controller = shm::Create(name, NUM_JOINTS);
+    shm::Region *sim = controller ? shm::Attach(name) : nullptr;
+    if (!sim)
+    {
+        printf("cannot create shared memory %s: %s\n", name.c_str(), strerror(errno));
+        shm::Remove(controller, name);
+        return 1;
+    }
+
+    // rl_sim side: answer every state with a command computed from it
+    int torn_states = 0, answered = 0;
+    uint32_t state_seq = sim->state.seq.load(std::memory_order_acquire); // before the first state is written
+    std::thread answer([&]() {
+        shm::State state;
+        shm::Command command = shm::Command();
+        uint32_t seq = state_seq;
+        while (answered < ticks)
+        {
+            if (!shm::Wait(sim->state.seq, seq, 1.0) || !shm::Read(sim->state, state, seq))
+            {
+                break;
+            }
+            if (!StateConsistent(state))
+            {
+                ++torn_states;
+            }
+            command.ack_tick = state.tick;
+            command.wait_tick = state.tick + 1;
+            for (int i = 0; i < shm::MAX_JOINTS; ++i)
+            {
+                const double value = static_cast<double>(state.tick) + i;
+                command.motor_command[i] = {value, -value, value, value, value};
+            }
+            shm::Write(sim->command, command);
+            ++answered;
+        }
+    });
+
+    // controller side: write a state, wait for its answer, keep the physics period
+    int torn_commands = 0, lost = 0;
+    std::vector<double> round_trips;
+    round_trips.reserve(ticks);
+    shm::State state = shm::State();
+    shm::Command command;
+    uint32_t command_seq = controller->command.seq.load(std::memory_order_acquire);
+    double next = Now();
+    for (int tick = 1; tick <= ticks; ++tick)
+    {
+        state.tick = tick;
+        for (int i = 0; i < shm::MAX_JOINTS; ++i)
+        {
+            const double value = static_cast<double>(tick) + i;
+            state.motor_state[i] = {value, -value, value};
+        }
+        const double sent = Now();
+        shm::Write(controller->state, state);
+        bool answered_tick = false;
+        while (shm::Wait(controller->command.seq, command_seq, 0.1) && shm::Read(controller->command, command, command_seq))
+        {
+            if (!CommandConsistent(command))
+            {
+                ++torn_commands;
+            }
+            if (command.ack_tick == static_cast<uint64_t>(tick))
+            {
+                answered_tick = true;
+                break;
+            }
+        }
+        if (!answered_tick)
+        {
+            ++lost;
+            continue;
+        }
+        round_trips.push_back((Now() - sent) * 1e6);
+        next += period_us * 1e-6;
+        while (Now() < next)
+        {
+            std::this_thread::yield();
+        }
+    }
+    answer.join();
+
+    // a writer that died between the two sequence increments must not hang the reader
+    const uint32_t seq = controller->state.seq.load(std::memory_order_relaxed);
+    controller->state.seq.store(seq + 1, std::memory_order_release);
+    const double stuck_begin = Now();
+    uint32_t stuck_seq = 0;
+    const bool stuck_read = shm::Read(sim->state, state, stuck_seq);
+    const bool stuck_wait = shm::Wait(sim->state.seq, seq, 0.01);
+    const double stuck_ms = (Now() - stuck_begin) * 1e3;
+    controller->state.seq.store(seq + 2, std::memory_order_release);
+
+    // the controller exits: the attacher sees it and the name is gone
+    shm::Remove(controller, name);
+    const bool removed = !shm::Alive(sim) && !shm::Attach(name);
+    shm::Detach(sim);
+
+    printf("%d ticks, %d joints, period %d us\n", ticks, NUM_JOINTS, period_us);
+    printf("torn states %d, torn commands %d, lost %d\n", torn_states, torn_commands, lost);
+    printf("stuck writer: read %s, wait %s, %.1f ms\n", stuck_read ? "returned data" : "gave up", stuck_wait ? "returned" : "timed out", stuck_ms);
+    printf("removed region: %s\n", removed ? "detected" : "still attachable");
+    bool ok = torn_states == 0 && torn_commands == 0 && lost == 0 && !stuck_read && !stuck_wait && removed;
+
+    // the same exchange over the topics, after the shared memory threads have been joined
+    std::vector<double> ros_round_trips;
+    if (with_ros)
+    {
+        int ros_torn = 0, ros_lost = 0;
+        ros_round_trips.reserve(ticks);
+        ok = RosRoundTrips(ticks, period_us, ros_round_trips, ros_torn, ros_lost) && ok;
+        printf("topics: torn commands %d, lost %d\n", ros_torn, ros_lost);
+        ok = ok && ros_torn == 0 && ros_lost == 0;
+    }
+    PrintRoundTrips("shm", round_trips);
+    if (with_ros)
+    {
+        PrintRoundTrips("ros", ros_round_trips);
+    }
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}